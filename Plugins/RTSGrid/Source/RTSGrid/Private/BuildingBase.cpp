@@ -8,6 +8,8 @@
 ABuildingBase::ABuildingBase()
 	: BuildDuration(1.0f)
 	, BuildDurationMultiply(1.0f)
+	, FootprintSize(1)
+	, bMustNotSealRegions(false)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridBake.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "CollisionQueryParams.h"
+#include "Engine/World.h"
+#include "RTSGridStats.h"
+
+FGridBake::~FGridBake()
+{
+	Cancel();
+	Wait();
+}
+
+void FGridBake::Start(const FGridBakeRequest& InRequest)
+{
+	Cancel();
+	Wait();
+
+	Request = InRequest;
+	NumColumns = FMath::Max(Request.Max.Column - Request.Min.Column + 1, 0);
+	NumRows = FMath::Max(Request.Max.Row - Request.Min.Row + 1, 0);
+
+	const int32 NumCells = NumColumns * NumRows;
+	Blocked.SetNumZeroed(NumCells);
+	Heights.SetNumZeroed(Request.Settings.bBakeHeightAndSlope ? NumCells : 0);
+	Slopes.SetNumZeroed(Request.Settings.bBakeHeightAndSlope ? NumCells : 0);
+
+	bCancelRequested = false;
+	NumColumnsDone.Reset();
+
+	Running = Async(EAsyncExecution::ThreadPool, [this]()
+	{
+		RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_Bake);
+
+		ParallelFor(NumColumns, [this](int32 Column)
+		{
+			if (!bCancelRequested)
+			{
+				BakeColumn(Column);
+				NumColumnsDone.Increment();
+			}
+		});
+	});
+}
+
+void FGridBake::Cancel()
+{
+	if (IsRunning())
+	{
+		bCancelRequested = true;
+	}
+}
+
+void FGridBake::Wait()
+{
+	if (Running.IsValid())
+	{
+		Running.Wait();
+	}
+}
+
+bool FGridBake::IsRunning() const
+{
+	return Running.IsValid() && !Running.IsReady();
+}
+
+bool FGridBake::IsFinished() const
+{
+	return Running.IsValid() && Running.IsReady();
+}
+
+float FGridBake::GetProgress() const
+{
+	return NumColumns > 0 ? (float)NumColumnsDone.GetValue() / NumColumns : 1.0f;
+}
+
+void FGridBake::Release()
+{
+	Wait();
+
+	Running = TFuture<void>();
+	Blocked.Empty();
+	Heights.Empty();
+	Slopes.Empty();
+}
+
+SIZE_T FGridBake::GetAllocatedSize() const
+{
+	return Blocked.GetAllocatedSize() + Heights.GetAllocatedSize() + Slopes.GetAllocatedSize();
+}
+
+void FGridBake::BakeColumn(int32 Column)
+{
+	const FGridBakeSettings& Settings = Request.Settings;
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(RTSGridBake), false);
+	Params.AddIgnoredActors(Request.IgnoredActors);
+
+	const float MinGroundNormalZ = FMath::Cos(FMath::DegreesToRadians(Settings.MaxSlope));
+	const FCollisionShape ObstacleBox = FCollisionShape::MakeBox(FVector(Request.CellSize * 0.45f, Request.CellSize * 0.45f, Settings.ClearanceHeight * 0.5f));
+
+	const int32 GridColumn = Request.Min.Column + Column;
+	for (int32 Row = 0; Row < NumRows; Row++)
+	{
+		const int32 GridRow = Request.Min.Row + Row;
+		const FVector CellCenter = Request.Origin + FVector(GridRow * Request.CellSize, GridColumn * Request.CellSize, 0.0f);
+		const int32 Index = Column * NumRows + Row;
+
+		FHitResult Ground;
+		const bool bHasGround = Request.World->LineTraceSingleByChannel(
+			Ground,
+			CellCenter + FVector(0.0f, 0.0f, Settings.TraceHalfHeight),
+			CellCenter - FVector(0.0f, 0.0f, Settings.TraceHalfHeight),
+			Settings.GroundChannel,
+			Params);
+
+		bool bBlocked;
+		if (!bHasGround)
+		{
+			bBlocked = Settings.bBlockWithoutGround;
+		}
+		else
+		{
+			bBlocked = Ground.ImpactNormal.Z < MinGroundNormalZ;
+
+			// The box starts StepHeight over the ground so the ground itself does not count
+			if (!bBlocked && Settings.bTestObstacles)
+			{
+				const FVector BoxCenter = Ground.ImpactPoint + FVector(0.0f, 0.0f, Settings.StepHeight + Settings.ClearanceHeight * 0.5f);
+				bBlocked = Request.World->OverlapBlockingTestByChannel(BoxCenter, FQuat::Identity, Settings.ObstacleChannel, ObstacleBox, Params);
+			}
+		}
+
+		Blocked[Index] = bBlocked ? 1 : 0;
+
+		if (Settings.bBakeHeightAndSlope)
+		{
+			Heights[Index] = bHasGround ? Ground.ImpactPoint.Z : CellCenter.Z;
+			Slopes[Index] = bHasGround ? FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Ground.ImpactNormal.Z, -1.0f, 1.0f))) : 0.0f;
+		}
+
+		if (bCancelRequested)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridBitMask.h"
+
+namespace GridBitMask
+{
+	// Dest[i] = Source[i + Shift] along a Column, zeros come in past the end
+	static void ShiftTowardsFirst(const uint64* Source, uint64* Dest, int32 NumWords, int32 Shift)
+	{
+		const int32 WordShift = Shift >> 6;
+		const int32 BitShift = Shift & 63;
+
+		for (int32 Index = 0; Index < NumWords; Index++)
+		{
+			const uint64 Low = Index + WordShift < NumWords ? Source[Index + WordShift] : 0;
+			const uint64 High = Index + WordShift + 1 < NumWords ? Source[Index + WordShift + 1] : 0;
+			Dest[Index] = BitShift != 0 ? (Low >> BitShift) | (High << (64 - BitShift)) : Low;
+		}
+	}
+
+	// Dest[i] = Source[i - Shift] along a Column, zeros come in before the start
+	static void ShiftTowardsLast(const uint64* Source, uint64* Dest, int32 NumWords, int32 Shift)
+	{
+		const int32 WordShift = Shift >> 6;
+		const int32 BitShift = Shift & 63;
+
+		for (int32 Index = NumWords - 1; Index >= 0; Index--)
+		{
+			const uint64 High = Index - WordShift >= 0 ? Source[Index - WordShift] : 0;
+			const uint64 Low = Index - WordShift - 1 >= 0 ? Source[Index - WordShift - 1] : 0;
+			Dest[Index] = BitShift != 0 ? (High << BitShift) | (Low >> (64 - BitShift)) : High;
+		}
+	}
+}
+
+void FGridBitMask::Init(const FGridCoord& InDimensions, bool bValue)
+{
+	Dimensions = FGridCoord(FMath::Max(InDimensions.Column, 0), FMath::Max(InDimensions.Row, 0));
+	WordsPerColumn = FMath::DivideAndRoundUp(Dimensions.Row, 64);
+	Words.Init(bValue ? ~0ull : 0ull, Dimensions.Column * WordsPerColumn);
+	ClearPadding();
+}
+
+void FGridBitMask::And(const FGridBitMask& Other)
+{
+	check(Other.Dimensions == Dimensions);
+	for (int32 Index = 0; Index < Words.Num(); Index++)
+	{
+		Words[Index] &= Other.Words[Index];
+	}
+}
+
+void FGridBitMask::Or(const FGridBitMask& Other)
+{
+	check(Other.Dimensions == Dimensions);
+	for (int32 Index = 0; Index < Words.Num(); Index++)
+	{
+		Words[Index] |= Other.Words[Index];
+	}
+}
+
+void FGridBitMask::AndNot(const FGridBitMask& Other)
+{
+	check(Other.Dimensions == Dimensions);
+	for (int32 Index = 0; Index < Words.Num(); Index++)
+	{
+		Words[Index] &= ~Other.Words[Index];
+	}
+}
+
+void FGridBitMask::Not()
+{
+	for (uint64& Word : Words)
+	{
+		Word = ~Word;
+	}
+	ClearPadding();
+}
+
+void FGridBitMask::Dilate(int32 Radius)
+{
+	if (Radius > 0)
+	{
+		// Radius tiles after each bit, then Radius tiles before, which covers both sides
+		CombineWindow<false, false>(Radius + 1);
+		CombineWindow<false, true>(Radius + 1);
+	}
+}
+
+void FGridBitMask::AnyInFootprint(int32 Size)
+{
+	CombineWindow<false, false>(Size);
+}
+
+void FGridBitMask::AllInFootprint(int32 Size)
+{
+	CombineWindow<true, false>(Size);
+}
+
+void FGridBitMask::CopyColumns(const FGridBitMask& Source, int32 SourceColumn, int32 DestColumn, int32 NumColumns)
+{
+	check(Source.Dimensions.Row == Dimensions.Row);
+	check(SourceColumn >= 0 && SourceColumn + NumColumns <= Source.Dimensions.Column);
+	check(DestColumn >= 0 && DestColumn + NumColumns <= Dimensions.Column);
+
+	if (NumColumns > 0)
+	{
+		FMemory::Memcpy(GetColumn(DestColumn), Source.GetColumn(SourceColumn), NumColumns * WordsPerColumn * sizeof(uint64));
+	}
+}
+
+int32 FGridBitMask::CountSetBits() const
+{
+	int32 NumSet = 0;
+	for (const uint64 Word : Words)
+	{
+		NumSet += FPlatformMath::CountBits(Word);
+	}
+	return NumSet;
+}
+
+SIZE_T FGridBitMask::GetAllocatedSize() const
+{
+	return Words.GetAllocatedSize();
+}
+
+template<bool bAnd, bool bBackwards>
+void FGridBitMask::CombineWindow(int32 Size)
+{
+	if (Size <= 1 || Words.Num() == 0)
+	{
+		return;
+	}
+
+	// Each pass doubles the window covered by every bit, at most, so a window takes log2(Size) passes
+	TArray<uint64, TInlineAllocator<64>> Shifted;
+	Shifted.SetNumUninitialized(WordsPerColumn);
+
+	for (int32 Column = 0; Column < Dimensions.Column; Column++)
+	{
+		uint64* ColumnWords = GetColumn(Column);
+		for (int32 Covered = 1; Covered < Size;)
+		{
+			const int32 Step = FMath::Min(Covered, Size - Covered);
+			if (bBackwards)
+			{
+				GridBitMask::ShiftTowardsLast(ColumnWords, Shifted.GetData(), WordsPerColumn, Step);
+			}
+			else
+			{
+				GridBitMask::ShiftTowardsFirst(ColumnWords, Shifted.GetData(), WordsPerColumn, Step);
+			}
+			for (int32 Index = 0; Index < WordsPerColumn; Index++)
+			{
+				ColumnWords[Index] = bAnd ? ColumnWords[Index] & Shifted[Index] : ColumnWords[Index] | Shifted[Index];
+			}
+			Covered += Step;
+		}
+	}
+
+	// Same along Columns, visited so every Column reads the other one before it is updated
+	for (int32 Covered = 1; Covered < Size;)
+	{
+		const int32 Step = FMath::Min(Covered, Size - Covered);
+		for (int32 Visited = 0; Visited < Dimensions.Column; Visited++)
+		{
+			const int32 Column = bBackwards ? Dimensions.Column - 1 - Visited : Visited;
+			const int32 OtherColumn = bBackwards ? Column - Step : Column + Step;
+			uint64* ColumnWords = GetColumn(Column);
+			if (OtherColumn >= 0 && OtherColumn < Dimensions.Column)
+			{
+				const uint64* OtherWords = GetColumn(OtherColumn);
+				for (int32 Index = 0; Index < WordsPerColumn; Index++)
+				{
+					ColumnWords[Index] = bAnd ? ColumnWords[Index] & OtherWords[Index] : ColumnWords[Index] | OtherWords[Index];
+				}
+			}
+			else if (bAnd)
+			{
+				FMemory::Memzero(ColumnWords, WordsPerColumn * sizeof(uint64));
+			}
+		}
+		Covered += Step;
+	}
+
+	ClearPadding();
+}
+
+void FGridBitMask::ClearPadding()
+{
+	const int32 PaddingBits = WordsPerColumn * 64 - Dimensions.Row;
+	if (PaddingBits == 0)
+	{
+		return;
+	}
+
+	const uint64 LastWordMask = ~0ull >> PaddingBits;
+	for (int32 Column = 0; Column < Dimensions.Column; Column++)
+	{
+		GetColumn(Column)[WordsPerColumn - 1] &= LastWordMask;
+	}
+}
@@ -0,0 +1,432 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridChunkStore.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+#include "RTSGrid.h"
+
+FGridChunkStore::FGridChunkStore()
+	: Newest(INDEX_NONE)
+	, Oldest(INDEX_NONE)
+	, CachedKey(0, 0)
+	, CachedIndex(INDEX_NONE)
+	, MaxResidentChunks(1024)
+	, NumBlocked(0)
+	, NumChunks(0)
+	, NumPageIns(0)
+	, PageFileSize(0)
+	, LivePageBytes(0)
+{
+}
+
+FGridChunkStore::~FGridChunkStore()
+{
+	Reset(FString(), MaxResidentChunks);
+}
+
+void FGridChunkStore::Reset(const FString& InPageFilePath, int32 InMaxResidentChunks)
+{
+	Resident.Empty();
+	ResidentByKey.Empty();
+	Pages.Empty();
+	Newest = INDEX_NONE;
+	Oldest = INDEX_NONE;
+	CachedIndex = INDEX_NONE;
+	NumBlocked = 0;
+	NumChunks = 0;
+	NumPageIns = 0;
+
+	// The page file is only a cache of the chunks in use, it is never read back after a Reset
+	PageFile.Reset();
+	if (!PageFilePath.IsEmpty())
+	{
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*PageFilePath);
+	}
+	PageFileSize = 0;
+	LivePageBytes = 0;
+
+	PageFilePath = InPageFilePath;
+	MaxResidentChunks = FMath::Max(InMaxResidentChunks, 1);
+}
+
+bool FGridChunkStore::IsBlocked(const FGridCoord& Coordinate) const
+{
+	const int32 Index = const_cast<FGridChunkStore*>(this)->FindChunk(GetChunkKey(Coordinate), false);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const int32 Cell = GetCellIndex(Coordinate);
+	return (Resident[Index].Words[Cell >> 6] >> (Cell & 63)) & 1;
+}
+
+bool FGridChunkStore::SetBlocked(const FGridCoord& Coordinate, bool bBlocked)
+{
+	// Clearing a cell of a chunk that does not exist changes nothing
+	const int32 Index = FindChunk(GetChunkKey(Coordinate), bBlocked);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FChunk& Chunk = Resident[Index];
+	const int32 Cell = GetCellIndex(Coordinate);
+	const uint64 Mask = 1ull << (Cell & 63);
+	uint64& Word = Chunk.Words[Cell >> 6];
+
+	if (((Word & Mask) != 0) == bBlocked)
+	{
+		return false;
+	}
+
+	Word ^= Mask;
+	Chunk.NumBlocked += bBlocked ? 1 : -1;
+	Chunk.bDirty = true;
+	NumBlocked += bBlocked ? 1 : -1;
+
+	if (Chunk.NumBlocked == 0)
+	{
+		FreeChunk(Index);
+	}
+
+	return true;
+}
+
+void FGridChunkStore::SetMaxResidentChunks(int32 InMaxResidentChunks)
+{
+	MaxResidentChunks = FMath::Max(InMaxResidentChunks, 1);
+
+	while (ResidentByKey.Num() > MaxResidentChunks && Evict(Oldest))
+	{
+	}
+}
+
+SIZE_T FGridChunkStore::GetAllocatedSize() const
+{
+	return Resident.GetAllocatedSize() + ResidentByKey.GetAllocatedSize() + Pages.GetAllocatedSize();
+}
+
+int64 FGridChunkStore::GetPageFileSize() const
+{
+	return PageFileSize;
+}
+
+int32 FGridChunkStore::FindChunk(const FIntPoint& Key, bool bCreate)
+{
+	// The cached chunk is the last one touched, it is already the newest
+	if (CachedIndex != INDEX_NONE && CachedKey == Key)
+	{
+		return CachedIndex;
+	}
+
+	if (const int32* Found = ResidentByKey.Find(Key))
+	{
+		Touch(*Found);
+		CachedKey = Key;
+		CachedIndex = *Found;
+		return *Found;
+	}
+
+	if (!bCreate && !Pages.Contains(Key))
+	{
+		return INDEX_NONE;
+	}
+
+	if (ResidentByKey.Num() >= MaxResidentChunks)
+	{
+		Evict(Oldest);
+	}
+
+	// Looked up after evicting, which can compact the page file and move every page, or lose them all if that fails
+	const FPage* FoundPage = Pages.Find(Key);
+	const bool bPaged = FoundPage != nullptr;
+	const FPage Page = bPaged ? *FoundPage : FPage();
+
+	if (!bPaged && !bCreate)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Index = Resident.Add(FChunk());
+	FChunk& Chunk = Resident[Index];
+	FMemory::Memzero(Chunk.Words, sizeof(Chunk.Words));
+	Chunk.Key = Key;
+	Chunk.NumBlocked = 0;
+	Chunk.bDirty = true;
+
+	if (bPaged)
+	{
+		NumPageIns++;
+
+		if (ReadPage(Page, Chunk))
+		{
+			Chunk.NumBlocked = Page.NumBlocked;
+			Chunk.bDirty = false;
+		}
+		else
+		{
+			UE_LOG(LogRTSGrid, Error, TEXT("Could not read grid chunk (%d, %d) from %s, its tiles are cleared"), Key.X, Key.Y, *PageFilePath);
+			NumBlocked -= Page.NumBlocked;
+			LivePageBytes -= Page.Size;
+			Pages.Remove(Key);
+			NumChunks--;
+
+			if (!bCreate)
+			{
+				Resident.RemoveAt(Index);
+				return INDEX_NONE;
+			}
+		}
+	}
+
+	if (!Pages.Contains(Key) && Chunk.NumBlocked == 0)
+	{
+		NumChunks++;
+	}
+
+	Chunk.Newer = INDEX_NONE;
+	Chunk.Older = INDEX_NONE;
+	Touch(Index);
+	ResidentByKey.Add(Key, Index);
+
+	CachedKey = Key;
+	CachedIndex = Index;
+	return Index;
+}
+
+bool FGridChunkStore::Evict(int32 Index)
+{
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FChunk& Chunk = Resident[Index];
+	if (Chunk.bDirty || !Pages.Contains(Chunk.Key))
+	{
+		if (!WritePage(Chunk))
+		{
+			// Over budget rather than losing tiles
+			return false;
+		}
+	}
+
+	RemoveResident(Index);
+	return true;
+}
+
+void FGridChunkStore::FreeChunk(int32 Index)
+{
+	if (const FPage* Page = Pages.Find(Resident[Index].Key))
+	{
+		LivePageBytes -= Page->Size;
+		Pages.Remove(Resident[Index].Key);
+	}
+
+	NumChunks--;
+	RemoveResident(Index);
+}
+
+void FGridChunkStore::RemoveResident(int32 Index)
+{
+	Unlink(Index);
+	ResidentByKey.Remove(Resident[Index].Key);
+	Resident.RemoveAt(Index);
+
+	if (CachedIndex == Index)
+	{
+		CachedIndex = INDEX_NONE;
+	}
+}
+
+void FGridChunkStore::Touch(int32 Index)
+{
+	if (Newest == Index)
+	{
+		return;
+	}
+
+	FChunk& Chunk = Resident[Index];
+	if (Chunk.Newer != INDEX_NONE || Chunk.Older != INDEX_NONE || Oldest == Index)
+	{
+		Unlink(Index);
+	}
+
+	Chunk.Newer = INDEX_NONE;
+	Chunk.Older = Newest;
+	if (Newest != INDEX_NONE)
+	{
+		Resident[Newest].Newer = Index;
+	}
+	Newest = Index;
+
+	if (Oldest == INDEX_NONE)
+	{
+		Oldest = Index;
+	}
+}
+
+void FGridChunkStore::Unlink(int32 Index)
+{
+	FChunk& Chunk = Resident[Index];
+
+	if (Chunk.Newer != INDEX_NONE)
+	{
+		Resident[Chunk.Newer].Older = Chunk.Older;
+	}
+	else
+	{
+		Newest = Chunk.Older;
+	}
+
+	if (Chunk.Older != INDEX_NONE)
+	{
+		Resident[Chunk.Older].Newer = Chunk.Newer;
+	}
+	else
+	{
+		Oldest = Chunk.Newer;
+	}
+
+	Chunk.Newer = INDEX_NONE;
+	Chunk.Older = INDEX_NONE;
+}
+
+bool FGridChunkStore::WritePage(const FChunk& Chunk)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PageFile.IsValid())
+	{
+		if (PageFilePath.IsEmpty())
+		{
+			return false;
+		}
+
+		PlatformFile.CreateDirectoryTree(*FPaths::GetPath(PageFilePath));
+		PageFile.Reset(PlatformFile.OpenWrite(*PageFilePath, false, true));
+		PageFileSize = 0;
+		LivePageBytes = 0;
+
+		if (!PageFile.IsValid())
+		{
+			UE_LOG(LogRTSGrid, Error, TEXT("Could not open the grid page file %s"), *PageFilePath);
+			return false;
+		}
+	}
+
+	// Mostly empty or mostly full chunks compress to a few bytes, the others are stored as they are
+	uint8 Compressed[sizeof(Chunk.Words)];
+	int32 CompressedSize = sizeof(Compressed);
+	const uint8* Data = reinterpret_cast<const uint8*>(Chunk.Words);
+	int32 Size = sizeof(Chunk.Words);
+
+	if (FCompression::CompressMemory(NAME_Zlib, Compressed, CompressedSize, Chunk.Words, sizeof(Chunk.Words)) && CompressedSize < Size)
+	{
+		Data = Compressed;
+		Size = CompressedSize;
+	}
+
+	if (!PageFile->Seek(PageFileSize) || !PageFile->Write(Data, Size))
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("Could not write to the grid page file %s"), *PageFilePath);
+		return false;
+	}
+
+	// The previous page of the chunk, if any, is left in the file until it is compacted
+	if (const FPage* Previous = Pages.Find(Chunk.Key))
+	{
+		LivePageBytes -= Previous->Size;
+	}
+
+	Pages.Add(Chunk.Key, { PageFileSize, Size, Chunk.NumBlocked });
+	PageFileSize += Size;
+	LivePageBytes += Size;
+
+	if (PageFileSize > 1024 * 1024 && PageFileSize > 2 * LivePageBytes)
+	{
+		CompactPageFile();
+	}
+
+	return true;
+}
+
+bool FGridChunkStore::ReadPage(const FPage& Page, FChunk& OutChunk)
+{
+	if (!PageFile.IsValid() || !PageFile->Seek(Page.Offset))
+	{
+		return false;
+	}
+
+	if (Page.Size == sizeof(OutChunk.Words))
+	{
+		return PageFile->Read(reinterpret_cast<uint8*>(OutChunk.Words), Page.Size);
+	}
+
+	uint8 Compressed[sizeof(OutChunk.Words)];
+	return PageFile->Read(Compressed, Page.Size)
+		&& FCompression::UncompressMemory(NAME_Zlib, OutChunk.Words, sizeof(OutChunk.Words), Compressed, Page.Size);
+}
+
+void FGridChunkStore::CompactPageFile()
+{
+	TArray<uint8> Live;
+	Live.Reserve((int32)LivePageBytes);
+
+	// Pages keep pointing into the old file until it is rewritten, so a failed read leaves every page readable
+	TArray<int64> NewOffsets;
+	NewOffsets.Reserve(Pages.Num());
+
+	for (const TPair<FIntPoint, FPage>& Page : Pages)
+	{
+		const int32 Offset = Live.AddUninitialized(Page.Value.Size);
+		if (!PageFile->Seek(Page.Value.Offset) || !PageFile->Read(&Live[Offset], Page.Value.Size))
+		{
+			UE_LOG(LogRTSGrid, Error, TEXT("Could not compact the grid page file %s"), *PageFilePath);
+			return;
+		}
+		NewOffsets.Add(Offset);
+	}
+
+	// Opening without appending truncates the file
+	PageFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*PageFilePath, false, true));
+	if (!PageFile.IsValid() || !PageFile->Write(Live.GetData(), Live.Num()))
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("Could not rewrite the grid page file %s, the tiles of paged out chunks are cleared"), *PageFilePath);
+
+		for (const TPair<FIntPoint, FPage>& Page : Pages)
+		{
+			if (!ResidentByKey.Contains(Page.Key))
+			{
+				NumBlocked -= Page.Value.NumBlocked;
+				NumChunks--;
+			}
+		}
+
+		// Resident chunks are written again when evicted
+		for (FChunk& Chunk : Resident)
+		{
+			Chunk.bDirty = true;
+		}
+
+		Pages.Empty();
+		PageFile.Reset();
+		PageFileSize = 0;
+		LivePageBytes = 0;
+		return;
+	}
+
+	// Pages was not changed since the offsets were collected, so it iterates in the same order
+	int32 PageIndex = 0;
+	for (TPair<FIntPoint, FPage>& Page : Pages)
+	{
+		Page.Value.Offset = NewOffsets[PageIndex++];
+	}
+
+	PageFileSize = Live.Num();
+	LivePageBytes = Live.Num();
+}
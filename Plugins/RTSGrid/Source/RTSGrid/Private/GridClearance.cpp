@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridClearance.h"
+#include "GridOccupancy.h"
+#include "RTSGridStats.h"
+
+FORCEINLINE uint8 FGridClearance::ComputeClearance(int32 Column, int32 Row) const
+{
+	if (Values[Layout.ToCellID(FGridCoord(Column, Row))] == 0)
+	{
+		return 0;
+	}
+
+	if (Column + 1 >= Layout.Dimensions.Column || Row + 1 >= Layout.Dimensions.Row)
+	{
+		return 1;
+	}
+
+	const int32 Smallest = FMath::Min3(
+		Values[Layout.ToCellID(FGridCoord(Column + 1, Row))],
+		Values[Layout.ToCellID(FGridCoord(Column, Row + 1))],
+		Values[Layout.ToCellID(FGridCoord(Column + 1, Row + 1))]);
+
+	return (uint8)FMath::Min(Smallest + 1, MaxClearance);
+}
+
+void FGridClearance::Reset(const FGridOccupancy& Occupancy)
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_RebuildClearance);
+
+	Layout = Occupancy.GetLayout();
+	Values.Init(0, Layout.GetNumCellIDs());
+
+	// Backwards so the three cells after a cell are done before it
+	for (int32 Column = Layout.Dimensions.Column - 1; Column >= 0; Column--)
+	{
+		for (int32 Row = Layout.Dimensions.Row - 1; Row >= 0; Row--)
+		{
+			const int32 CellID = Layout.ToCellID(FGridCoord(Column, Row));
+			Values[CellID] = Occupancy.IsBlocked(CellID) ? 0 : 1;
+			Values[CellID] = ComputeClearance(Column, Row);
+		}
+	}
+
+	NumCellsUpdated = Layout.GetNumCells();
+}
+
+void FGridClearance::SetBlocked(const FGridCoord& Coordinate, bool bBlocked)
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_UpdateClearance);
+
+	NumCellsUpdated = 0;
+
+	const int32 CellID = Layout.ToCellID(Coordinate);
+	if ((Values[CellID] == 0) == bBlocked)
+	{
+		return;
+	}
+
+	// Any non zero value marks the cell free for ComputeClearance
+	Values[CellID] = bBlocked ? 0 : 1;
+	Values[CellID] = ComputeClearance(Coordinate.Column, Coordinate.Row);
+	NumCellsUpdated++;
+
+	// Cells only depend on the cells after them, so the change spreads to smaller Columns and Rows.
+	// LowestChanged is the smallest Row that changed in the Column after the current one.
+	int32 LowestChanged = Coordinate.Row;
+	for (int32 Column = Coordinate.Column; Column >= 0 && LowestChanged <= Coordinate.Row; Column--)
+	{
+		int32 ColumnLowestChanged = Coordinate.Row + 1;
+		bool bAfterChanged = Column == Coordinate.Column;
+
+		for (int32 Row = Column == Coordinate.Column ? Coordinate.Row - 1 : Coordinate.Row; Row >= 0; Row--)
+		{
+			// A cell depends on the Row after it in its Column and on two Rows of the Column after it
+			if (!bAfterChanged && (Column == Coordinate.Column || Row + 1 < LowestChanged))
+			{
+				break;
+			}
+
+			const int32 Index = Layout.ToCellID(FGridCoord(Column, Row));
+			const uint8 Value = ComputeClearance(Column, Row);
+
+			bAfterChanged = Value != Values[Index];
+			if (bAfterChanged)
+			{
+				Values[Index] = Value;
+				ColumnLowestChanged = Row;
+				NumCellsUpdated++;
+			}
+		}
+
+		// The changed cell itself counts for the Column before it
+		LowestChanged = Column == Coordinate.Column ? FMath::Min(ColumnLowestChanged, Coordinate.Row) : ColumnLowestChanged;
+	}
+
+	INC_DWORD_STAT_BY(STAT_RTSGrid_ClearanceCellsUpdated, NumCellsUpdated);
+}
+
+SIZE_T FGridClearance::GetAllocatedSize() const
+{
+	return Values.GetAllocatedSize();
+}
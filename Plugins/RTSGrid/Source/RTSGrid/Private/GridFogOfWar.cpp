@@ -0,0 +1,261 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridFogOfWar.h"
+#include "Async/ParallelFor.h"
+#include "GridLineOfSight.h"
+#include "GridOccupancy.h"
+
+void FGridFogOfWar::Reset(const FGridLayout& InLayout, int32 InNumPlayers)
+{
+	Layout = InLayout;
+
+	Players.SetNum(FMath::Max(InNumPlayers, 0));
+	for (FPlayer& Player : Players)
+	{
+		Player.Counts.Init(0, Layout.GetNumCellIDs());
+		Player.Visible.Init(false, Layout.GetNumCellIDs());
+	}
+
+	for (TSparseArray<FUnit>::TIterator It(Units); It; ++It)
+	{
+		It->VisibleCells.Reset();
+		MarkDirty(It.GetIndex());
+	}
+}
+
+int32 FGridFogOfWar::AddUnit(int32 Player, const FGridCoord& Coordinate, int32 SightRadius)
+{
+	FUnit Unit;
+	Unit.Player = Player;
+	Unit.Coordinate = Coordinate;
+	Unit.SightRadius = FMath::Max(SightRadius, 0);
+	Unit.bDirty = false;
+	Unit.bRemoved = false;
+
+	const int32 Index = Units.Add(MoveTemp(Unit));
+	MarkDirty(Index);
+	return Index;
+}
+
+void FGridFogOfWar::MoveUnit(int32 Unit, const FGridCoord& Coordinate)
+{
+	if (!IsValidUnit(Unit) || Units[Unit].Coordinate == Coordinate)
+	{
+		return;
+	}
+
+	Units[Unit].Coordinate = Coordinate;
+	MarkDirty(Unit);
+}
+
+void FGridFogOfWar::RemoveUnit(int32 Unit)
+{
+	if (!IsValidUnit(Unit))
+	{
+		return;
+	}
+
+	Units[Unit].bRemoved = true;
+	MarkDirty(Unit);
+}
+
+void FGridFogOfWar::InvalidateCell(const FGridCoord& Coordinate)
+{
+	InvalidateRect(Coordinate, Coordinate);
+}
+
+void FGridFogOfWar::InvalidateRect(const FGridCoord& Min, const FGridCoord& Max)
+{
+	for (TSparseArray<FUnit>::TIterator It(Units); It; ++It)
+	{
+		// Distance from the unit to the closest cell of the rectangle
+		const int32 DeltaColumn = It->Coordinate.Column - FMath::Clamp(It->Coordinate.Column, Min.Column, Max.Column);
+		const int32 DeltaRow = It->Coordinate.Row - FMath::Clamp(It->Coordinate.Row, Min.Row, Max.Row);
+
+		if (DeltaColumn * DeltaColumn + DeltaRow * DeltaRow <= It->SightRadius * It->SightRadius)
+		{
+			MarkDirty(It.GetIndex());
+		}
+	}
+}
+
+void FGridFogOfWar::Update(const FGridOccupancy* Occupancy)
+{
+	if (DirtyUnits.Num() == 0)
+	{
+		return;
+	}
+
+	if (Occupancy && !ensureMsgf(Occupancy->GetLayout().GetNumCellIDs() == Layout.GetNumCellIDs(), TEXT("Fog of war and occupancy were built for different grids")))
+	{
+		Occupancy = nullptr;
+	}
+
+	// Sight of every unit that changed, in parallel across units
+	ParallelFor(DirtyUnits.Num(), [this, Occupancy](int32 Index)
+	{
+		ComputeSight(Units[DirtyUnits[Index]], Occupancy);
+	});
+
+	// Swap old sight for new sight in parallel across units. Units of a player share its counts,
+	// which only ever drop by what the unit added before so they never go below zero
+	ParallelFor(DirtyUnits.Num(), [this](int32 Index)
+	{
+		FUnit& Unit = Units[DirtyUnits[Index]];
+		Unit.FlippedCells.Reset();
+
+		if (!Players.IsValidIndex(Unit.Player))
+		{
+			return;
+		}
+
+		int32* Counts = Players[Unit.Player].Counts.GetData();
+
+		for (const int32 CellID : Unit.VisibleCells)
+		{
+			if (FPlatformAtomics::InterlockedDecrement(&Counts[CellID]) == 0)
+			{
+				Unit.FlippedCells.Add(CellID);
+			}
+		}
+
+		for (const int32 CellID : Unit.PendingCells)
+		{
+			if (FPlatformAtomics::InterlockedIncrement(&Counts[CellID]) == 1)
+			{
+				Unit.FlippedCells.Add(CellID);
+			}
+		}
+
+		Swap(Unit.VisibleCells, Unit.PendingCells);
+	});
+
+	// Bits share words, so they are refreshed by one task per player from the final counts,
+	// only for the cells at the edge of the sights that moved
+	ParallelFor(Players.Num(), [this](int32 PlayerIndex)
+	{
+		FPlayer& Player = Players[PlayerIndex];
+
+		for (const int32 UnitIndex : DirtyUnits)
+		{
+			const FUnit& Unit = Units[UnitIndex];
+			if (Unit.Player == PlayerIndex)
+			{
+				for (const int32 CellID : Unit.FlippedCells)
+				{
+					Player.Visible[CellID] = Player.Counts[CellID] != 0;
+				}
+			}
+		}
+	});
+
+	for (const int32 UnitIndex : DirtyUnits)
+	{
+		FUnit& Unit = Units[UnitIndex];
+		Unit.bDirty = false;
+		Unit.PendingCells.Reset();
+		Unit.FlippedCells.Reset();
+
+		if (Unit.bRemoved)
+		{
+			Units.RemoveAt(UnitIndex);
+		}
+	}
+
+	DirtyUnits.Reset();
+}
+
+SIZE_T FGridFogOfWar::GetAllocatedSize() const
+{
+	SIZE_T Size = Units.GetAllocatedSize() + Players.GetAllocatedSize() + DirtyUnits.GetAllocatedSize();
+
+	for (const FUnit& Unit : Units)
+	{
+		Size += Unit.VisibleCells.GetAllocatedSize() + Unit.PendingCells.GetAllocatedSize() + Unit.FlippedCells.GetAllocatedSize();
+	}
+
+	for (const FPlayer& Player : Players)
+	{
+		Size += Player.Counts.GetAllocatedSize() + Player.Visible.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+void FGridFogOfWar::ComputeSight(FUnit& Unit, const FGridOccupancy* Occupancy) const
+{
+	Unit.PendingCells.Reset();
+
+	if (Unit.bRemoved || !Players.IsValidIndex(Unit.Player) || !Layout.IsInBounds(Unit.Coordinate))
+	{
+		return;
+	}
+
+	const FGridCoord Center = Unit.Coordinate;
+	const int32 Radius = Unit.SightRadius;
+	const int32 RadiusSquared = Radius * Radius;
+
+	if (!Occupancy)
+	{
+		for (int32 DeltaColumn = -Radius; DeltaColumn <= Radius; DeltaColumn++)
+		{
+			for (int32 DeltaRow = -Radius; DeltaRow <= Radius; DeltaRow++)
+			{
+				const FGridCoord Cell(Center.Column + DeltaColumn, Center.Row + DeltaRow);
+				if (DeltaColumn * DeltaColumn + DeltaRow * DeltaRow <= RadiusSquared && Layout.IsInBounds(Cell))
+				{
+					Unit.PendingCells.Add(Layout.ToCellID(Cell));
+				}
+			}
+		}
+		return;
+	}
+
+	// Cast a ray to every cell on the border of the square around the unit,
+	// blocked cells are seen but end the ray, the unit's own cell never blocks
+	const int32 Side = 2 * Radius + 1;
+	TArray<uint8, TInlineAllocator<1024>> Seen;
+	Seen.SetNumZeroed(Side * Side);
+
+	auto CastRay = [this, &Unit, &Seen, Occupancy, Center, Radius, RadiusSquared, Side](const FGridCoord& Target)
+	{
+		FGridLineOfSight::ForEachCellOnLine(Center, Target, [this, &Unit, &Seen, Occupancy, Center, Radius, RadiusSquared, Side](const FGridCoord& Cell)
+		{
+			const int32 DeltaColumn = Cell.Column - Center.Column;
+			const int32 DeltaRow = Cell.Row - Center.Row;
+
+			if (DeltaColumn * DeltaColumn + DeltaRow * DeltaRow > RadiusSquared || !Layout.IsInBounds(Cell))
+			{
+				return false;
+			}
+
+			const int32 CellID = Layout.ToCellID(Cell);
+			uint8& bSeen = Seen[(DeltaColumn + Radius) * Side + (DeltaRow + Radius)];
+			if (!bSeen)
+			{
+				bSeen = 1;
+				Unit.PendingCells.Add(CellID);
+			}
+
+			return Cell == Center || !Occupancy->IsBlocked(CellID);
+		});
+	};
+
+	for (int32 Offset = -Radius; Offset <= Radius; Offset++)
+	{
+		CastRay(FGridCoord(Center.Column - Radius, Center.Row + Offset));
+		CastRay(FGridCoord(Center.Column + Radius, Center.Row + Offset));
+		CastRay(FGridCoord(Center.Column + Offset, Center.Row - Radius));
+		CastRay(FGridCoord(Center.Column + Offset, Center.Row + Radius));
+	}
+}
+
+void FGridFogOfWar::MarkDirty(int32 Unit)
+{
+	if (!Units[Unit].bDirty)
+	{
+		Units[Unit].bDirty = true;
+		DirtyUnits.Add(Unit);
+	}
+}
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridInfluenceMap.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "RTSGridStats.h"
+
+namespace GridInfluenceMap
+{
+	// Out[i] += In[i] * Scale, four floats at a time
+	static FORCEINLINE void AddScaled(float* RESTRICT Out, const float* RESTRICT In, float Scale, int32 Num)
+	{
+		const VectorRegister VectorScale = VectorSetFloat1(Scale);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			VectorStore(VectorMultiplyAdd(VectorLoad(In + Index), VectorScale, VectorLoad(Out + Index)), Out + Index);
+		}
+
+		for (; Index < Num; Index++)
+		{
+			Out[Index] += In[Index] * Scale;
+		}
+	}
+}
+
+FGridInfluenceMap::FGridInfluenceMap()
+	: Dimensions(0)
+	, Radius(4)
+	, Decay(0.5f)
+	, TimeSinceUpdate(0.0f)
+{
+}
+
+FGridInfluenceMap::~FGridInfluenceMap()
+{
+	if (Running.IsValid())
+	{
+		Running.Wait();
+	}
+}
+
+void FGridInfluenceMap::Reset(const FGridCoord& InDimensions)
+{
+	Flush();
+
+	Dimensions = FGridCoord(FMath::Max(InDimensions.Column, 0), FMath::Max(InDimensions.Row, 0));
+
+	const int32 NumCells = Dimensions.Column * Dimensions.Row;
+	Front.Init(0.0f, NumCells);
+	Back.Init(0.0f, NumCells);
+	Scratch.Init(0.0f, NumCells);
+	PendingSources.Reset();
+}
+
+void FGridInfluenceMap::SetKernel(int32 InRadius, float InDecay)
+{
+	Radius = FMath::Max(InRadius, 0);
+	Decay = FMath::Clamp(InDecay, 0.0f, 1.0f);
+}
+
+void FGridInfluenceMap::AddSource(const FGridCoord& Coordinate, float Weight)
+{
+	if (Coordinate >= FGridCoord(0, 0) && Coordinate < Dimensions)
+	{
+		PendingSources.Add({ Coordinate.Column * Dimensions.Row + Coordinate.Row, Weight });
+	}
+}
+
+bool FGridInfluenceMap::ScheduleUpdate()
+{
+	TryFlip();
+
+	if (Running.IsValid() || Front.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<float> Kernel;
+	Kernel.Reserve(2 * Radius + 1);
+	for (int32 Offset = -Radius; Offset <= Radius; Offset++)
+	{
+		Kernel.Add(FMath::Pow(Decay, (float)FMath::Abs(Offset)));
+	}
+
+	TArray<FSource> Sources = MoveTemp(PendingSources);
+	PendingSources.Reset();
+
+	Running = Async(EAsyncExecution::TaskGraph, [this, Sources = MoveTemp(Sources), KernelRadius = Radius, Kernel = MoveTemp(Kernel)]()
+	{
+		Compute(Sources, KernelRadius, Kernel);
+	});
+
+	TimeSinceUpdate = 0.0f;
+	return true;
+}
+
+void FGridInfluenceMap::Tick(float DeltaTime, float UpdateInterval)
+{
+	TryFlip();
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate >= UpdateInterval)
+	{
+		ScheduleUpdate();
+	}
+}
+
+void FGridInfluenceMap::Flush()
+{
+	if (Running.IsValid())
+	{
+		Running.Wait();
+		TryFlip();
+	}
+}
+
+bool FGridInfluenceMap::IsUpdating() const
+{
+	return Running.IsValid() && !Running.IsReady();
+}
+
+SIZE_T FGridInfluenceMap::GetAllocatedSize() const
+{
+	// Back and Scratch belong to the worker while an update runs and are swapped there, Reset sizes them like Front
+	return 3 * Front.GetAllocatedSize() + PendingSources.GetAllocatedSize();
+}
+
+void FGridInfluenceMap::TryFlip()
+{
+	if (Running.IsValid() && Running.IsReady())
+	{
+		Running = TFuture<void>();
+		Swap(Front, Back);
+	}
+}
+
+void FGridInfluenceMap::Compute(const TArray<FSource>& Sources, int32 KernelRadius, const TArray<float>& Kernel)
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_ComputeInfluenceMap);
+
+	const int32 NumColumns = Dimensions.Column;
+	const int32 NumRows = Dimensions.Row;
+
+	FMemory::Memzero(Scratch.GetData(), Scratch.Num() * sizeof(float));
+	for (const FSource& Source : Sources)
+	{
+		Scratch[Source.Index] += Source.Weight;
+	}
+
+	// Spread along Rows, Scratch to Back, each Column is independent
+	ParallelFor(NumColumns, [this, NumRows, KernelRadius, &Kernel](int32 Column)
+	{
+		// Zeros on both sides so the kernel never reads outside the Column
+		TArray<float, TInlineAllocator<1024>> Padded;
+		Padded.SetNumZeroed(NumRows + 2 * KernelRadius);
+		FMemory::Memcpy(&Padded[KernelRadius], &Scratch[Column * NumRows], NumRows * sizeof(float));
+
+		float* Out = &Back[Column * NumRows];
+		FMemory::Memzero(Out, NumRows * sizeof(float));
+
+		for (int32 Tap = 0; Tap < Kernel.Num(); Tap++)
+		{
+			GridInfluenceMap::AddScaled(Out, &Padded[Tap], Kernel[Tap], NumRows);
+		}
+	});
+
+	// Spread across Columns, Back to Scratch, whole Columns are added at once
+	ParallelFor(NumColumns, [this, NumColumns, NumRows, KernelRadius, &Kernel](int32 Column)
+	{
+		float* Out = &Scratch[Column * NumRows];
+		FMemory::Memzero(Out, NumRows * sizeof(float));
+
+		const int32 First = FMath::Max(Column - KernelRadius, 0);
+		const int32 Last = FMath::Min(Column + KernelRadius, NumColumns - 1);
+		for (int32 Other = First; Other <= Last; Other++)
+		{
+			GridInfluenceMap::AddScaled(Out, &Back[Other * NumRows], Kernel[Other - Column + KernelRadius], NumRows);
+		}
+	});
+
+	Swap(Back, Scratch);
+}
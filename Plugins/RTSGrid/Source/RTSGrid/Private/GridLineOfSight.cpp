@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridLineOfSight.h"
+#include "Async/ParallelFor.h"
+#include "GridChunkStore.h"
+#include "GridOccupancy.h"
+
+namespace GridLineOfSight
+{
+	// Queries run by one ParallelFor task, lines are short so single queries are too small to schedule
+	static const int32 QueriesPerTask = 64;
+}
+
+bool FGridLineOfSight::HasLineOfSight(const FGridOccupancy& Occupancy, const FGridCoord& From, const FGridCoord& To)
+{
+	const FGridLayout& Layout = Occupancy.GetLayout();
+
+	if (!Layout.IsInBounds(From) || !Layout.IsInBounds(To))
+	{
+		return false;
+	}
+
+	return ForEachCellOnLine(From, To, [&Occupancy, &Layout, &From, &To](const FGridCoord& Cell)
+	{
+		// Both ends are in bounds, so is every cell between them
+		return Cell == From || Cell == To || !Occupancy.IsBlocked(Layout.ToCellID(Cell));
+	});
+}
+
+bool FGridLineOfSight::HasLineOfSight(const FGridChunkStore& Tiles, const FGridLayout& Layout, const FGridCoord& From, const FGridCoord& To)
+{
+	if (!Layout.IsInBounds(From) || !Layout.IsInBounds(To))
+	{
+		return false;
+	}
+
+	return ForEachCellOnLine(From, To, [&Tiles, &From, &To](const FGridCoord& Cell)
+	{
+		return Cell == From || Cell == To || !Tiles.IsBlocked(Cell);
+	});
+}
+
+void FGridLineOfSight::HasLineOfSightBatch(const FGridOccupancy& Occupancy, TArrayView<const FGridLineQuery> Queries, TArrayView<bool> OutResults)
+{
+	check(OutResults.Num() >= Queries.Num());
+
+	const int32 NumTasks = FMath::DivideAndRoundUp(Queries.Num(), GridLineOfSight::QueriesPerTask);
+
+	ParallelFor(NumTasks, [&Occupancy, Queries, OutResults](int32 Task)
+	{
+		const int32 First = Task * GridLineOfSight::QueriesPerTask;
+		const int32 Last = FMath::Min(First + GridLineOfSight::QueriesPerTask, Queries.Num());
+
+		for (int32 Index = First; Index < Last; Index++)
+		{
+			OutResults[Index] = HasLineOfSight(Occupancy, Queries[Index].From, Queries[Index].To);
+		}
+	});
+}
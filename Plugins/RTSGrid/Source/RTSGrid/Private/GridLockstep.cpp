@@ -0,0 +1,256 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridLockstep.h"
+#include "Algo/StableSort.h"
+
+namespace GridLockstep
+{
+	// 7 bits per byte, the high bit tells another byte follows
+	static void WriteVarInt(TArray<uint8>& Out, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add((uint8)Value);
+	}
+
+	static bool ReadVarInt(TArrayView<const uint8> In, int32& Offset, uint32& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 35; Shift += 7)
+		{
+			if (Offset >= In.Num())
+			{
+				return false;
+			}
+
+			const uint8 Byte = In[Offset++];
+			OutValue |= (uint32)(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+FGridLockstep::FGridLockstep()
+{
+	Reset(1, 0, 0);
+}
+
+void FGridLockstep::Reset(int32 InNumPeers, int32 InLocalPeer, int32 InInputDelay)
+{
+	NumPeers = FMath::Clamp(InNumPeers, 1, MaxPeers);
+	LocalPeer = FMath::Clamp(InLocalPeer, 0, NumPeers - 1);
+	InputDelay = FMath::Max(InInputDelay, 0);
+
+	// Nobody can issue commands for the ticks before the delay, they are applied empty
+	CurrentTick = 0;
+	NextLocalTick = InputDelay;
+
+	LocalCommands.Reset();
+	PendingInputs.Reset();
+
+	for (int32 Index = 0; Index < ChecksumHistory; Index++)
+	{
+		ChecksumTicks[Index] = INDEX_NONE;
+		Checksums[Index] = 0;
+	}
+
+	LastRecordedTick = INDEX_NONE;
+	LastRecordedChecksum = 0;
+	DesyncTick = INDEX_NONE;
+}
+
+void FGridLockstep::QueueLocal(int32 BuildingType, int32 CellID)
+{
+	FGridLockstepCommand& Command = LocalCommands.AddDefaulted_GetRef();
+	Command.Peer = LocalPeer;
+	Command.BuildingType = BuildingType;
+	Command.CellID = CellID;
+}
+
+bool FGridLockstep::WriteLocalPacket(TArray<uint8>& OutPacket)
+{
+	OutPacket.Reset();
+
+	// Writing once per applied tick stamps commands InputDelay ticks ahead, writing more often while the other peers are late must not run further ahead
+	if (NextLocalTick > CurrentTick + InputDelay)
+	{
+		return false;
+	}
+
+	const int32 Tick = NextLocalTick++;
+
+	// Peer, tick, how many ticks back the checksum is from (0 for none), checksum, commands
+	GridLockstep::WriteVarInt(OutPacket, LocalPeer);
+	GridLockstep::WriteVarInt(OutPacket, Tick);
+
+	if (LastRecordedTick != INDEX_NONE)
+	{
+		GridLockstep::WriteVarInt(OutPacket, Tick - LastRecordedTick);
+		for (int32 Shift = 0; Shift < 32; Shift += 8)
+		{
+			OutPacket.Add((uint8)(LastRecordedChecksum >> Shift));
+		}
+	}
+	else
+	{
+		GridLockstep::WriteVarInt(OutPacket, 0);
+	}
+
+	GridLockstep::WriteVarInt(OutPacket, LocalCommands.Num());
+	for (const FGridLockstepCommand& Command : LocalCommands)
+	{
+		GridLockstep::WriteVarInt(OutPacket, Command.BuildingType);
+		GridLockstep::WriteVarInt(OutPacket, Command.CellID);
+	}
+
+	AddInputs(LocalPeer, Tick, LocalCommands);
+	LocalCommands.Reset();
+	return true;
+}
+
+bool FGridLockstep::ReceivePacket(TArrayView<const uint8> Packet)
+{
+	int32 Offset = 0;
+	uint32 Peer, Tick, ChecksumAge, NumCommands;
+
+	if (!GridLockstep::ReadVarInt(Packet, Offset, Peer) || !GridLockstep::ReadVarInt(Packet, Offset, Tick) || !GridLockstep::ReadVarInt(Packet, Offset, ChecksumAge))
+	{
+		return false;
+	}
+
+	uint32 Checksum = 0;
+	if (ChecksumAge > 0)
+	{
+		if (Offset + (int32)sizeof(uint32) > Packet.Num())
+		{
+			return false;
+		}
+		for (int32 Shift = 0; Shift < 32; Shift += 8)
+		{
+			Checksum |= (uint32)Packet[Offset++] << Shift;
+		}
+	}
+
+	if (!GridLockstep::ReadVarInt(Packet, Offset, NumCommands) || NumCommands > (uint32)(Packet.Num() - Offset) / 2)
+	{
+		return false;
+	}
+
+	// Further ahead than any peer can be, it would wait in PendingInputs forever
+	const int32 LastTick = CurrentTick + 2 * InputDelay + 1;
+	if (Peer >= (uint32)NumPeers || (int32)Peer == LocalPeer || Tick > (uint32)LastTick || (int32)Tick < FMath::Max(CurrentTick, InputDelay) || ChecksumAge > Tick)
+	{
+		return false;
+	}
+
+	const FTickInputs* Existing = PendingInputs.Find((int32)Tick);
+	if (Existing && (Existing->ReceivedPeers & (1u << Peer)) != 0)
+	{
+		return false;
+	}
+
+	TArray<FGridLockstepCommand, TInlineAllocator<16>> Commands;
+	for (uint32 Index = 0; Index < NumCommands; Index++)
+	{
+		uint32 BuildingType, CellID;
+		if (!GridLockstep::ReadVarInt(Packet, Offset, BuildingType) || !GridLockstep::ReadVarInt(Packet, Offset, CellID) || BuildingType > (uint32)MAX_int32 || CellID > (uint32)MAX_int32)
+		{
+			return false;
+		}
+
+		FGridLockstepCommand& Command = Commands.AddDefaulted_GetRef();
+		Command.Peer = (int32)Peer;
+		Command.BuildingType = (int32)BuildingType;
+		Command.CellID = (int32)CellID;
+	}
+
+	if (Offset != Packet.Num())
+	{
+		return false;
+	}
+
+	AddInputs((int32)Peer, (int32)Tick, Commands);
+
+	if (ChecksumAge > 0)
+	{
+		CompareChecksum((int32)(Tick - ChecksumAge), Checksum);
+	}
+
+	return true;
+}
+
+bool FGridLockstep::IsTickReady() const
+{
+	if (CurrentTick < InputDelay)
+	{
+		return true;
+	}
+
+	const uint32 AllPeers = NumPeers == MaxPeers ? ~0u : (1u << NumPeers) - 1;
+	const FTickInputs* Inputs = PendingInputs.Find(CurrentTick);
+	return Inputs && Inputs->ReceivedPeers == AllPeers;
+}
+
+bool FGridLockstep::PopTick(TArray<FGridLockstepCommand>& OutCommands)
+{
+	OutCommands.Reset();
+
+	if (!IsTickReady())
+	{
+		return false;
+	}
+
+	FTickInputs Inputs;
+	if (PendingInputs.RemoveAndCopyValue(CurrentTick, Inputs))
+	{
+		// Packets arrive in any order, the peer index decides, stable keeps each peer's own order
+		OutCommands = MoveTemp(Inputs.Commands);
+		Algo::StableSortBy(OutCommands, &FGridLockstepCommand::Peer);
+	}
+
+	CurrentTick++;
+	return true;
+}
+
+void FGridLockstep::RecordChecksum(int32 Tick, uint32 Checksum)
+{
+	LastRecordedTick = Tick;
+	LastRecordedChecksum = Checksum;
+	CompareChecksum(Tick, Checksum);
+}
+
+void FGridLockstep::AddInputs(int32 Peer, int32 Tick, TArrayView<const FGridLockstepCommand> Commands)
+{
+	FTickInputs& Inputs = PendingInputs.FindOrAdd(Tick);
+	Inputs.Commands.Append(Commands.GetData(), Commands.Num());
+	Inputs.ReceivedPeers |= 1u << Peer;
+}
+
+void FGridLockstep::CompareChecksum(int32 Tick, uint32 Checksum)
+{
+	const int32 Index = Tick & (ChecksumHistory - 1);
+
+	if (ChecksumTicks[Index] != Tick)
+	{
+		// Only ticks too old to matter are overwritten
+		if (ChecksumTicks[Index] < Tick)
+		{
+			ChecksumTicks[Index] = Tick;
+			Checksums[Index] = Checksum;
+		}
+		return;
+	}
+
+	if (Checksums[Index] != Checksum && (DesyncTick == INDEX_NONE || Tick < DesyncTick))
+	{
+		DesyncTick = Tick;
+	}
+}
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridOccupancy.h"
+#include "RTSGridStats.h"
+
+void FGridOccupancy::Reset(const FGridLayout& InLayout)
+{
+	Layout = InLayout;
+	Chunks.Init(GetEmptyChunk(), FMath::DivideAndRoundUp(Layout.GetNumCellIDs(), CellsPerChunk));
+	NumBlocked = 0;
+	Checksum = 0;
+}
+
+void FGridOccupancy::Reset(const FGridLayout& InLayout, const TSet<FGridCoord>& BlockedTiles)
+{
+	Reset(InLayout);
+
+	for (const FGridCoord& Tile : BlockedTiles)
+	{
+		if (Layout.IsInBounds(Tile))
+		{
+			SetBlocked(Layout.ToCellID(Tile), true);
+		}
+	}
+}
+
+void FGridOccupancy::CopyChunks(const FGridOccupancy& Source, TArrayView<const int32> ChunkIndices)
+{
+	check(Chunks.Num() == Source.Chunks.Num());
+
+	for (const int32 ChunkIndex : ChunkIndices)
+	{
+		Chunks[ChunkIndex] = Source.Chunks[ChunkIndex];
+	}
+
+	Layout = Source.Layout;
+	NumBlocked = Source.NumBlocked;
+	Checksum = Source.Checksum;
+}
+
+SIZE_T FGridOccupancy::GetAllocatedSize() const
+{
+	SIZE_T Size = Chunks.GetAllocatedSize();
+
+	for (const FChunkPtr& Chunk : Chunks)
+	{
+		if (Chunk != GetEmptyChunk())
+		{
+			Size += sizeof(FChunk);
+		}
+	}
+
+	return Size;
+}
+
+const FGridOccupancy::FChunkPtr& FGridOccupancy::GetEmptyChunk()
+{
+	static const FChunkPtr EmptyChunk = MakeShared<FChunk, ESPMode::ThreadSafe>();
+	return EmptyChunk;
+}
+
+FGridOccupancy::FChunk& FGridOccupancy::MakeChunkUnique(int32 ChunkIndex)
+{
+	FChunkPtr& Chunk = Chunks[ChunkIndex];
+
+	// The empty chunk is also referenced by GetEmptyChunk so it is never unique
+	if (!Chunk.IsUnique())
+	{
+		INC_DWORD_STAT(STAT_RTSGrid_OccupancyChunksCopied);
+		Chunk = MakeShared<FChunk, ESPMode::ThreadSafe>(*Chunk);
+	}
+
+	return *Chunk;
+}
+
+void FGridOccupancyPublisher::Reset()
+{
+	bInSync = false;
+	Recycled.Reset();
+	RecycledChangedChunks.Reset();
+}
+
+FGridOccupancySnapshotRef FGridOccupancyPublisher::Publish(const FGridOccupancy& Occupancy)
+{
+	TSharedPtr<FGridOccupancy, ESPMode::ThreadSafe> Snapshot;
+
+	// Nobody else holding the previous snapshot means no reader can see it change
+	if (bInSync && Recycled.IsValid() && Recycled.IsUnique())
+	{
+		Recycled->CopyChunks(Occupancy, RecycledChangedChunks);
+		Recycled->CopyChunks(Occupancy, ChangedChunks);
+		Snapshot = MoveTemp(Recycled);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_RTSGrid_OccupancySnapshotCopies);
+		Snapshot = MakeShared<FGridOccupancy, ESPMode::ThreadSafe>(Occupancy);
+	}
+
+	// The snapshot replaced is behind the new one by the chunks written since it was published
+	if (bInSync)
+	{
+		Recycled = Published;
+	}
+	else
+	{
+		Recycled.Reset();
+	}
+	Swap(RecycledChangedChunks, ChangedChunks);
+
+	for (const int32 ChunkIndex : RecycledChangedChunks)
+	{
+		ChunkChanged[ChunkIndex] = false;
+	}
+	ChangedChunks.Reset();
+
+	if (ChunkChanged.Num() != Occupancy.GetNumChunks())
+	{
+		ChunkChanged.Init(false, Occupancy.GetNumChunks());
+	}
+
+	Published = Snapshot;
+	bInSync = true;
+	return Published.ToSharedRef();
+}
+
+SIZE_T FGridOccupancyPublisher::GetAllocatedSize() const
+{
+	return RecycledChangedChunks.GetAllocatedSize() + ChangedChunks.GetAllocatedSize() + ChunkChanged.GetAllocatedSize();
+}
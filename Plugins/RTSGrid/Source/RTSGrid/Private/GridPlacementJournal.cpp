@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridPlacementJournal.h"
+#include "GameFramework/Actor.h"
+
+void FGridPlacementJournal::Reset(TArray<TWeakObjectPtr<AActor>>& OutDiscardedActors)
+{
+	CollectUndoneActors(OutDiscardedActors);
+	Ops.Reset();
+	Runs.Reset();
+	NumApplied = 0;
+	bRecording = false;
+}
+
+void FGridPlacementJournal::BeginOp(AActor* Actor)
+{
+	check(!bRecording);
+
+	// Recorded after the undone edits, which are only discarded once this edit changed something
+	FGridJournalOp& Op = Ops.AddDefaulted_GetRef();
+	Op.FirstRun = Runs.Num();
+	Op.NumRuns = 0;
+	Op.Actor = Actor;
+	bRecording = true;
+}
+
+void FGridPlacementJournal::Record(int32 CellID, bool bWasBlocked)
+{
+	check(bRecording);
+
+	FGridJournalOp& Op = Ops.Last();
+	if (Op.NumRuns > 0)
+	{
+		FGridJournalRun& Run = Runs.Last();
+		if (Run.bWasBlocked == bWasBlocked && Run.FirstCellID + Run.NumCells == CellID)
+		{
+			Run.NumCells++;
+			return;
+		}
+	}
+
+	Runs.Add({ CellID, 1, bWasBlocked });
+	Op.NumRuns++;
+}
+
+void FGridPlacementJournal::EndOp(TArray<TWeakObjectPtr<AActor>>& OutDiscardedActors)
+{
+	check(bRecording);
+	bRecording = false;
+
+	FGridJournalOp Op = Ops.Pop(false);
+	if (Op.NumRuns == 0)
+	{
+		return;
+	}
+
+	// A new edit replaces the undone ones
+	if (NumApplied < Ops.Num())
+	{
+		CollectUndoneActors(OutDiscardedActors);
+
+		const int32 FirstUndoneRun = Ops[NumApplied].FirstRun;
+		Runs.RemoveAt(FirstUndoneRun, Op.FirstRun - FirstUndoneRun, false);
+		Op.FirstRun = FirstUndoneRun;
+		Ops.SetNum(NumApplied, false);
+	}
+
+	Ops.Add(MoveTemp(Op));
+	NumApplied = Ops.Num();
+
+	if (Ops.Num() > MaxOps)
+	{
+		const int32 NumDropped = Ops.Num() - MaxOps;
+		const int32 NumDroppedRuns = Ops[NumDropped].FirstRun;
+
+		Ops.RemoveAt(0, NumDropped, false);
+		Runs.RemoveAt(0, NumDroppedRuns, false);
+		for (FGridJournalOp& KeptOp : Ops)
+		{
+			KeptOp.FirstRun -= NumDroppedRuns;
+		}
+		NumApplied = Ops.Num();
+	}
+}
+
+const FGridJournalOp* FGridPlacementJournal::Undo()
+{
+	check(!bRecording);
+
+	if (!CanUndo())
+	{
+		return nullptr;
+	}
+
+	return &Ops[--NumApplied];
+}
+
+const FGridJournalOp* FGridPlacementJournal::Redo()
+{
+	check(!bRecording);
+
+	if (!CanRedo())
+	{
+		return nullptr;
+	}
+
+	return &Ops[NumApplied++];
+}
+
+void FGridPlacementJournal::CollectUndoneActors(TArray<TWeakObjectPtr<AActor>>& OutActors) const
+{
+	for (int32 Index = NumApplied; Index < Ops.Num(); Index++)
+	{
+		if (Ops[Index].Actor.IsValid())
+		{
+			OutActors.Add(Ops[Index].Actor);
+		}
+	}
+}
+
+void FGridPlacementJournal::SetMaxOps(int32 InMaxOps)
+{
+	MaxOps = FMath::Max(InMaxOps, 1);
+}
+
+SIZE_T FGridPlacementJournal::GetAllocatedSize() const
+{
+	return Ops.GetAllocatedSize() + Runs.GetAllocatedSize();
+}
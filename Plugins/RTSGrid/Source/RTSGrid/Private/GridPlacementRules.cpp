@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridPlacementRules.h"
+#include "GridOccupancy.h"
+#include "RTSGridStats.h"
+
+namespace GridPlacementRules
+{
+	static bool AreSameRules(TArrayView<const FGridPlacementRule> Rules, TArrayView<const FGridPlacementRule> OtherRules)
+	{
+		if (Rules.Num() != OtherRules.Num())
+		{
+			return false;
+		}
+
+		for (int32 Index = 0; Index < Rules.Num(); Index++)
+		{
+			if (Rules[Index] != OtherRules[Index])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void FGridPlacementMask::SetRules(TArrayView<const FGridPlacementRule> InRules, int32 InFootprintSize)
+{
+	const int32 Size = FMath::Max(InFootprintSize, 1);
+
+	if (Size != FootprintSize || !GridPlacementRules::AreSameRules(Rules, InRules))
+	{
+		Rules.Reset();
+		Rules.Append(InRules.GetData(), InRules.Num());
+		FootprintSize = Size;
+		MarkAllDirty();
+	}
+}
+
+void FGridPlacementMask::MarkDirty(int32 Column)
+{
+	if (DirtyBegin < DirtyEnd)
+	{
+		DirtyBegin = FMath::Min(DirtyBegin, Column);
+		DirtyEnd = FMath::Max(DirtyEnd, Column + 1);
+	}
+	else
+	{
+		DirtyBegin = Column;
+		DirtyEnd = Column + 1;
+	}
+}
+
+void FGridPlacementMask::MarkAllDirty()
+{
+	bAllDirty = true;
+}
+
+const FGridBitMask& FGridPlacementMask::Refresh(const FInputs& Inputs)
+{
+	const FGridCoord& Dimensions = Inputs.Occupancy.GetLayout().Dimensions;
+
+	if (Mask.GetDimensions() != Dimensions)
+	{
+		Mask.Init(Dimensions, false);
+		bAllDirty = true;
+	}
+
+	if (!IsDirty())
+	{
+		return Mask;
+	}
+
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_RefreshPlacementMask);
+
+	if (bAllDirty)
+	{
+		Evaluate(Inputs, 0, Dimensions.Column);
+	}
+	else
+	{
+		// Footprints and distances spread a change to the Columns on both sides
+		const int32 Reach = GetReach();
+		Evaluate(Inputs, FMath::Max(DirtyBegin - Reach, 0), FMath::Min(DirtyEnd + Reach, Dimensions.Column));
+	}
+
+	bAllDirty = false;
+	DirtyBegin = DirtyEnd = 0;
+
+	return Mask;
+}
+
+int32 FGridPlacementMask::GetReach() const
+{
+	int32 MaxDistance = 0;
+	for (const FGridPlacementRule& Rule : Rules)
+	{
+		if (Rule.Type == EGridPlacementRule::NearLayer || Rule.Type == EGridPlacementRule::AwayFromLayer)
+		{
+			MaxDistance = FMath::Max(MaxDistance, Rule.Distance);
+		}
+	}
+	return FootprintSize - 1 + MaxDistance;
+}
+
+SIZE_T FGridPlacementMask::GetAllocatedSize() const
+{
+	return Mask.GetAllocatedSize() + Rules.GetAllocatedSize();
+}
+
+void FGridPlacementMask::Evaluate(const FInputs& Inputs, int32 ColumnBegin, int32 ColumnEnd)
+{
+	const FGridLayout& Layout = Inputs.Occupancy.GetLayout();
+	const int32 Reach = GetReach();
+
+	// Columns past the window read as empty, which is only wrong within Reach of its edges
+	const int32 WindowBegin = FMath::Max(ColumnBegin - Reach, 0);
+	const int32 WindowEnd = FMath::Min(ColumnEnd + Reach, Layout.Dimensions.Column);
+	const FGridCoord WindowDimensions(WindowEnd - WindowBegin, Layout.Dimensions.Row);
+
+	NumColumnsEvaluated = ColumnEnd - ColumnBegin;
+
+	FGridBitMask Result;
+	Result.Init(WindowDimensions, false);
+	for (int32 Column = WindowBegin; Column < WindowEnd; Column++)
+	{
+		for (int32 Row = 0; Row < Layout.Dimensions.Row; Row++)
+		{
+			if (!Inputs.Occupancy.IsBlocked(Layout.ToCellID(FGridCoord(Column, Row))))
+			{
+				Result.Set(FGridCoord(Column - WindowBegin, Row), true);
+			}
+		}
+	}
+	Result.AllInFootprint(FootprintSize);
+
+	FGridBitMask Term;
+	for (const FGridPlacementRule& Rule : Rules)
+	{
+		if (Rule.Type == EGridPlacementRule::MaxSlope)
+		{
+			// Not baked means flat
+			Term.Init(WindowDimensions, Inputs.CellSlopes.Num() != Layout.GetNumCellIDs());
+			if (Inputs.CellSlopes.Num() == Layout.GetNumCellIDs())
+			{
+				for (int32 Column = WindowBegin; Column < WindowEnd; Column++)
+				{
+					for (int32 Row = 0; Row < Layout.Dimensions.Row; Row++)
+					{
+						if (Inputs.CellSlopes[Layout.ToCellID(FGridCoord(Column, Row))] <= Rule.MaxSlope)
+						{
+							Term.Set(FGridCoord(Column - WindowBegin, Row), true);
+						}
+					}
+				}
+			}
+			Term.AllInFootprint(FootprintSize);
+			Result.And(Term);
+			continue;
+		}
+
+		Term.Init(WindowDimensions, false);
+		const FGridBitMask* Layer = Inputs.Layers.Find(Rule.Layer);
+		if (Layer && Layer->GetDimensions() == Layout.Dimensions)
+		{
+			Term.CopyColumns(*Layer, WindowBegin, 0, WindowDimensions.Column);
+		}
+
+		switch (Rule.Type)
+		{
+		case EGridPlacementRule::NearLayer:
+			Term.Dilate(Rule.Distance);
+			Term.AnyInFootprint(FootprintSize);
+			Result.And(Term);
+			break;
+		case EGridPlacementRule::AwayFromLayer:
+			Term.Dilate(Rule.Distance);
+			Term.AnyInFootprint(FootprintSize);
+			Result.AndNot(Term);
+			break;
+		case EGridPlacementRule::OnLayer:
+			Term.AllInFootprint(FootprintSize);
+			Result.And(Term);
+			break;
+		default:
+			break;
+		}
+	}
+
+	Mask.CopyColumns(Result, ColumnBegin - WindowBegin, ColumnBegin, ColumnEnd - ColumnBegin);
+}
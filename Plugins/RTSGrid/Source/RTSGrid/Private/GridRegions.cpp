@@ -0,0 +1,477 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridRegions.h"
+#include "GridOccupancy.h"
+#include "RTSGridStats.h"
+
+void FGridRegions::Reset(const FGridOccupancy& Occupancy)
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_RebuildRegions);
+
+	Layout = Occupancy.GetLayout();
+
+	// CellIDs past the last cell of padded layouts stay blocked
+	Labels.Init(INDEX_NONE, Layout.GetNumCellIDs());
+	for (int32 Column = 0; Column < Layout.Dimensions.Column; Column++)
+	{
+		for (int32 Row = 0; Row < Layout.Dimensions.Row; Row++)
+		{
+			const int32 CellID = Layout.ToCellID(FGridCoord(Column, Row));
+			if (!Occupancy.IsBlocked(CellID))
+			{
+				Labels[CellID] = Unlabeled;
+			}
+		}
+	}
+
+	RegionSizes.Reset();
+	FreeRegionLabels.Reset();
+	NumRegions = 0;
+
+	VisitEpochs.Init(0, Layout.GetNumCellIDs());
+	VisitOwners.Init(0, Layout.GetNumCellIDs());
+	Epoch = 0;
+
+	NumCellsVisited = 0;
+	for (int32 CellID = 0; CellID < Labels.Num(); CellID++)
+	{
+		if (Labels[CellID] == Unlabeled)
+		{
+			const int32 Region = AllocateRegion();
+			RegionSizes[Region] = FloodFill(CellID, Unlabeled, Region);
+		}
+	}
+}
+
+void FGridRegions::SetBlocked(int32 CellID, bool bBlocked)
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_UpdateRegions);
+
+	NumCellsVisited = 0;
+
+	int32 Neighbours[4];
+	const int32 NumNeighbours = GetNeighbours(CellID, Neighbours);
+
+	if (bBlocked)
+	{
+		const int32 Region = Labels[CellID];
+		if (Region == INDEX_NONE)
+		{
+			return;
+		}
+
+		Labels[CellID] = INDEX_NONE;
+		if (--RegionSizes[Region] == 0)
+		{
+			FreeRegion(Region);
+			return;
+		}
+
+		int32 Seeds[4];
+		int32 NumSeeds = 0;
+		for (int32 Index = 0; Index < NumNeighbours; Index++)
+		{
+			if (IsFree(Neighbours[Index]))
+			{
+				Seeds[NumSeeds++] = Neighbours[Index];
+			}
+		}
+
+		// Most cells are blocked next to a free path around them, such as the end of a wall
+		if (NumSeeds > 1 && !AreNeighboursLinked(CellID))
+		{
+			SearchSplit(TArrayView<const int32>(Seeds, NumSeeds), true);
+		}
+	}
+	else
+	{
+		if (Labels[CellID] != INDEX_NONE)
+		{
+			return;
+		}
+
+		// The biggest region around the cell keeps its label, the others are merged into it
+		int32 Target = INDEX_NONE;
+		for (int32 Index = 0; Index < NumNeighbours; Index++)
+		{
+			const int32 Region = Labels[Neighbours[Index]];
+			if (Region != INDEX_NONE && (Target == INDEX_NONE || RegionSizes[Region] > RegionSizes[Target]))
+			{
+				Target = Region;
+			}
+		}
+
+		if (Target == INDEX_NONE)
+		{
+			Target = AllocateRegion();
+		}
+
+		Labels[CellID] = Target;
+		RegionSizes[Target]++;
+
+		for (int32 Index = 0; Index < NumNeighbours; Index++)
+		{
+			const int32 Region = Labels[Neighbours[Index]];
+			if (Region != INDEX_NONE && Region != Target)
+			{
+				RegionSizes[Target] += FloodFill(Neighbours[Index], Region, Target);
+				FreeRegion(Region);
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_RTSGrid_RegionCellsVisited, NumCellsVisited);
+}
+
+bool FGridRegions::WouldSplit(TArrayView<const int32> CellIDs)
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_UpdateRegions);
+
+	NumCellsVisited = 0;
+
+	// Blocks the cells for the search and puts the labels back after
+	TArray<int32, TInlineAllocator<16>> SavedLabels;
+	SavedLabels.Reserve(CellIDs.Num());
+	for (const int32 CellID : CellIDs)
+	{
+		SavedLabels.Add(Labels[CellID]);
+		Labels[CellID] = INDEX_NONE;
+	}
+
+	TArray<int32, TInlineAllocator<16>> Seeds;
+	for (const int32 CellID : CellIDs)
+	{
+		int32 Neighbours[4];
+		const int32 NumNeighbours = GetNeighbours(CellID, Neighbours);
+		for (int32 Index = 0; Index < NumNeighbours; Index++)
+		{
+			if (IsFree(Neighbours[Index]))
+			{
+				Seeds.AddUnique(Neighbours[Index]);
+			}
+		}
+	}
+
+	// A single free cell linked around needs no search, as when blocking it for real
+	if (CellIDs.Num() == 1 && SavedLabels[0] != INDEX_NONE && AreNeighboursLinked(CellIDs[0]))
+	{
+		Seeds.Reset();
+	}
+
+	// Each region around the cells is searched on its own
+	bool bSplit = false;
+	TArray<int32, TInlineAllocator<16>> RegionSeeds;
+	while (Seeds.Num() > 0 && !bSplit)
+	{
+		const int32 Region = Labels[Seeds.Last()];
+
+		RegionSeeds.Reset();
+		for (int32 Index = Seeds.Num() - 1; Index >= 0; Index--)
+		{
+			if (Labels[Seeds[Index]] == Region)
+			{
+				RegionSeeds.Add(Seeds[Index]);
+				Seeds.RemoveAtSwap(Index, 1, false);
+			}
+		}
+
+		bSplit = RegionSeeds.Num() > 1 && SearchSplit(RegionSeeds, false);
+	}
+
+	// Backwards so a cell listed twice gets its first saved label back
+	for (int32 Index = CellIDs.Num() - 1; Index >= 0; Index--)
+	{
+		Labels[CellIDs[Index]] = SavedLabels[Index];
+	}
+
+	INC_DWORD_STAT_BY(STAT_RTSGrid_RegionCellsVisited, NumCellsVisited);
+	return bSplit;
+}
+
+SIZE_T FGridRegions::GetAllocatedSize() const
+{
+	SIZE_T Size = Labels.GetAllocatedSize() + RegionSizes.GetAllocatedSize() + FreeRegionLabels.GetAllocatedSize()
+		+ VisitEpochs.GetAllocatedSize() + VisitOwners.GetAllocatedSize() + Queues.GetAllocatedSize();
+
+	for (const TArray<int32>& Queue : Queues)
+	{
+		Size += Queue.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+int32 FGridRegions::GetNeighbours(int32 CellID, int32 (&OutNeighbours)[4]) const
+{
+	const FGridCoord Coordinate = Layout.ToCoordinate(CellID);
+	int32 NumNeighbours = 0;
+
+	if (Coordinate.Column > 0)
+	{
+		OutNeighbours[NumNeighbours++] = Layout.ToCellID(FGridCoord(Coordinate.Column - 1, Coordinate.Row));
+	}
+	if (Coordinate.Row > 0)
+	{
+		OutNeighbours[NumNeighbours++] = Layout.ToCellID(FGridCoord(Coordinate.Column, Coordinate.Row - 1));
+	}
+	if (Coordinate.Column < Layout.Dimensions.Column - 1)
+	{
+		OutNeighbours[NumNeighbours++] = Layout.ToCellID(FGridCoord(Coordinate.Column + 1, Coordinate.Row));
+	}
+	if (Coordinate.Row < Layout.Dimensions.Row - 1)
+	{
+		OutNeighbours[NumNeighbours++] = Layout.ToCellID(FGridCoord(Coordinate.Column, Coordinate.Row + 1));
+	}
+
+	return NumNeighbours;
+}
+
+bool FGridRegions::AreNeighboursLinked(int32 CellID) const
+{
+	// The 8 neighbours in order around the cell, each one touches the next
+	static const int32 Ring[8][2] = { { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 } };
+
+	const FGridCoord Coordinate = Layout.ToCoordinate(CellID);
+
+	bool bFree[8];
+	for (int32 Index = 0; Index < 8; Index++)
+	{
+		const FGridCoord Neighbour(Coordinate.Column + Ring[Index][0], Coordinate.Row + Ring[Index][1]);
+		bFree[Index] = Layout.IsInBounds(Neighbour) && IsFree(Layout.ToCellID(Neighbour));
+	}
+
+	// Starts after a blocked neighbour so no run of free neighbours wraps around
+	int32 Start = INDEX_NONE;
+	for (int32 Index = 0; Index < 8 && Start == INDEX_NONE; Index++)
+	{
+		Start = bFree[Index] ? INDEX_NONE : Index;
+	}
+	if (Start == INDEX_NONE)
+	{
+		return true;
+	}
+
+	// Counts the runs of free neighbours holding a 4-neighbour, the odd indices of the ring
+	int32 NumRuns = 0;
+	bool bRunCounted = false;
+	for (int32 Step = 1; Step <= 8; Step++)
+	{
+		const int32 Index = (Start + Step) & 7;
+		if (!bFree[Index])
+		{
+			bRunCounted = false;
+		}
+		else if ((Index & 1) != 0 && !bRunCounted)
+		{
+			bRunCounted = true;
+			NumRuns++;
+		}
+	}
+
+	return NumRuns <= 1;
+}
+
+int32 FGridRegions::FloodFill(int32 Seed, int32 From, int32 To)
+{
+	if (Queues.Num() == 0)
+	{
+		Queues.AddDefaulted();
+	}
+
+	TArray<int32>& Stack = Queues[0];
+	Stack.Reset();
+	Stack.Add(Seed);
+	Labels[Seed] = To;
+
+	int32 NumCells = 0;
+	while (Stack.Num() > 0)
+	{
+		const int32 CellID = Stack.Pop(false);
+		NumCells++;
+
+		int32 Neighbours[4];
+		const int32 NumNeighbours = GetNeighbours(CellID, Neighbours);
+		for (int32 Index = 0; Index < NumNeighbours; Index++)
+		{
+			if (Labels[Neighbours[Index]] == From)
+			{
+				Labels[Neighbours[Index]] = To;
+				Stack.Add(Neighbours[Index]);
+			}
+		}
+	}
+
+	NumCellsVisited += NumCells;
+	return NumCells;
+}
+
+bool FGridRegions::SearchSplit(TArrayView<const int32> Seeds, bool bRelabel)
+{
+	check(Seeds.Num() <= MAX_uint16);
+
+	const int32 Region = Labels[Seeds[0]];
+	const int32 NumSeeds = Seeds.Num();
+
+	if (++Epoch == 0)
+	{
+		FMemory::Memzero(VisitEpochs.GetData(), VisitEpochs.Num() * sizeof(uint32));
+		Epoch = 1;
+	}
+
+	if (Queues.Num() < NumSeeds)
+	{
+		Queues.SetNum(NumSeeds);
+	}
+
+	// Searches that met are one part, tracked with a union find over the seeds
+	TArray<int32, TInlineAllocator<16>> Parents;
+	TArray<int32, TInlineAllocator<16>> Heads;
+	TArray<bool, TInlineAllocator<16>> Closed;
+	Parents.SetNumUninitialized(NumSeeds);
+	Heads.SetNumZeroed(NumSeeds);
+	Closed.SetNumZeroed(NumSeeds);
+
+	auto FindPart = [&Parents](int32 Search)
+	{
+		while (Parents[Search] != Search)
+		{
+			Search = Parents[Search] = Parents[Parents[Search]];
+		}
+		return Search;
+	};
+
+	int32 NumOpenParts = NumSeeds;
+	for (int32 Search = 0; Search < NumSeeds; Search++)
+	{
+		Parents[Search] = Search;
+		Queues[Search].Reset();
+
+		const int32 Seed = Seeds[Search];
+		if (VisitEpochs[Seed] == Epoch)
+		{
+			Parents[Search] = FindPart(VisitOwners[Seed]);
+			NumOpenParts--;
+			continue;
+		}
+
+		VisitEpochs[Seed] = Epoch;
+		VisitOwners[Seed] = (uint16)Search;
+		Queues[Search].Add(Seed);
+	}
+
+	bool bSplit = false;
+	while (NumOpenParts > 1)
+	{
+		// One cell per search and round, so no part is searched much further than the others
+		for (int32 Search = 0; Search < NumSeeds; Search++)
+		{
+			TArray<int32>& Queue = Queues[Search];
+			if (Heads[Search] >= Queue.Num() || Closed[FindPart(Search)])
+			{
+				continue;
+			}
+
+			const int32 CellID = Queue[Heads[Search]++];
+
+			int32 Neighbours[4];
+			const int32 NumNeighbours = GetNeighbours(CellID, Neighbours);
+			for (int32 Index = 0; Index < NumNeighbours; Index++)
+			{
+				const int32 Neighbour = Neighbours[Index];
+				if (!IsFree(Neighbour))
+				{
+					continue;
+				}
+
+				if (VisitEpochs[Neighbour] != Epoch)
+				{
+					VisitEpochs[Neighbour] = Epoch;
+					VisitOwners[Neighbour] = (uint16)Search;
+					Queue.Add(Neighbour);
+				}
+				else
+				{
+					const int32 PartA = FindPart(Search);
+					const int32 PartB = FindPart(VisitOwners[Neighbour]);
+					if (PartA != PartB)
+					{
+						Parents[PartB] = PartA;
+						NumOpenParts--;
+					}
+				}
+			}
+		}
+
+		// A part whose searches all ran out of cells is closed off from the others
+		for (int32 Part = 0; Part < NumSeeds && NumOpenParts > 1; Part++)
+		{
+			if (FindPart(Part) != Part || Closed[Part])
+			{
+				continue;
+			}
+
+			bool bExhausted = true;
+			for (int32 Search = 0; Search < NumSeeds && bExhausted; Search++)
+			{
+				bExhausted = FindPart(Search) != Part || Heads[Search] >= Queues[Search].Num();
+			}
+
+			if (!bExhausted)
+			{
+				continue;
+			}
+
+			Closed[Part] = true;
+			NumOpenParts--;
+			bSplit = true;
+
+			if (!bRelabel)
+			{
+				// The caller only needs to know, the other parts need not be searched
+				NumOpenParts = 0;
+				break;
+			}
+
+			const int32 NewRegion = AllocateRegion();
+			for (int32 Search = 0; Search < NumSeeds; Search++)
+			{
+				if (FindPart(Search) == Part)
+				{
+					for (const int32 CellID : Queues[Search])
+					{
+						Labels[CellID] = NewRegion;
+					}
+					RegionSizes[NewRegion] += Queues[Search].Num();
+				}
+			}
+			RegionSizes[Region] -= RegionSizes[NewRegion];
+		}
+	}
+
+	for (int32 Search = 0; Search < NumSeeds; Search++)
+	{
+		NumCellsVisited += Queues[Search].Num();
+	}
+
+	return bSplit;
+}
+
+int32 FGridRegions::AllocateRegion()
+{
+	NumRegions++;
+
+	if (FreeRegionLabels.Num() > 0)
+	{
+		return FreeRegionLabels.Pop(false);
+	}
+
+	return RegionSizes.Add(0);
+}
+
+void FGridRegions::FreeRegion(int32 Region)
+{
+	NumRegions--;
+	RegionSizes[Region] = 0;
+	FreeRegionLabels.Add(Region);
+}
@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridReservationTable.h"
+
+void FGridReservationTable::Reset(int32 InHorizon, int32 MaxReservationsPerStep)
+{
+	Horizon = (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(InHorizon, 1));
+	MaxReservations = FMath::Max(MaxReservationsPerStep, 1);
+
+	// Probes stay short while tables are at most half full
+	Capacity = (int32)FMath::RoundUpToPowerOfTwo(MaxReservations * 2);
+	MaxUsed = Capacity / 2;
+	HashShift = 32 - FMath::FloorLog2(Capacity);
+
+	// No entry is stamped with a time that can be reserved yet
+	Entries.Init({ INDEX_NONE, INDEX_NONE, MIN_int32 }, Horizon * Capacity);
+	Steps.Init({ MIN_int32, 0 }, Horizon);
+	CurrentTime = 0;
+}
+
+int32 FGridReservationTable::GetReservation(int32 CellID, int32 Time) const
+{
+	const int32 Index = FindEntry(CellID, Time);
+	return Index != INDEX_NONE ? GetStepEntries(Time)[Index].Unit : INDEX_NONE;
+}
+
+bool FGridReservationTable::Reserve(int32 CellID, int32 Time, int32 Unit)
+{
+	if (!IsInHorizon(Time) || Unit == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FStep& Step = Steps[Time & (Horizon - 1)];
+	if (Step.Time != Time)
+	{
+		// First reservation of this time step since the ring wrapped around
+		Step.Time = Time;
+		Step.NumUsed = 0;
+	}
+
+	FEntry* StepEntries = GetStepEntries(Time);
+	int32 FreeIndex = INDEX_NONE;
+
+	for (uint32 Index = Hash(CellID), Probes = 0; Probes < (uint32)Capacity; Index = (Index + 1) & (Capacity - 1), Probes++)
+	{
+		FEntry& Entry = StepEntries[Index];
+
+		if (Entry.Time != Time)
+		{
+			if (FreeIndex == INDEX_NONE)
+			{
+				FreeIndex = Index;
+			}
+			break;
+		}
+
+		if (Entry.Unit == INDEX_NONE)
+		{
+			// Released, reusable once we know the cell is not further along
+			if (FreeIndex == INDEX_NONE)
+			{
+				FreeIndex = Index;
+			}
+		}
+		else if (Entry.CellID == CellID)
+		{
+			return Entry.Unit == Unit;
+		}
+	}
+
+	if (FreeIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FEntry& Entry = StepEntries[FreeIndex];
+	if (Entry.Time != Time)
+	{
+		// Empty slots turn into used ones, released ones are already counted
+		if (Step.NumUsed >= MaxUsed)
+		{
+			return false;
+		}
+		Step.NumUsed++;
+	}
+
+	Entry.CellID = CellID;
+	Entry.Unit = Unit;
+	Entry.Time = Time;
+	return true;
+}
+
+void FGridReservationTable::Release(int32 CellID, int32 Time, int32 Unit)
+{
+	const int32 Index = FindEntry(CellID, Time);
+	if (Index != INDEX_NONE)
+	{
+		FEntry& Entry = GetStepEntries(Time)[Index];
+		if (Entry.Unit == Unit)
+		{
+			Entry.Unit = INDEX_NONE;
+		}
+	}
+}
+
+bool FGridReservationTable::IsMoveFree(int32 FromCellID, int32 ToCellID, int32 Time, int32 Unit) const
+{
+	const int32 Arriving = GetReservation(ToCellID, Time + 1);
+	if (Arriving != INDEX_NONE && Arriving != Unit)
+	{
+		return false;
+	}
+
+	if (FromCellID == ToCellID)
+	{
+		return true;
+	}
+
+	// Two units swapping cells would cross each other on the way
+	const int32 Leaving = GetReservation(ToCellID, Time);
+	return Leaving == INDEX_NONE || Leaving == Unit || GetReservation(FromCellID, Time + 1) != Leaving;
+}
+
+bool FGridReservationTable::ReservePath(TArrayView<const int32> CellIDs, int32 StartTime, int32 Unit)
+{
+	if (CellIDs.Num() == 0)
+	{
+		return true;
+	}
+
+	if (!IsInHorizon(StartTime) || !IsInHorizon(StartTime + CellIDs.Num() - 1))
+	{
+		return false;
+	}
+
+	const int32 First = GetReservation(CellIDs[0], StartTime);
+	if (First != INDEX_NONE && First != Unit)
+	{
+		return false;
+	}
+
+	for (int32 Index = 1; Index < CellIDs.Num(); Index++)
+	{
+		if (!IsMoveFree(CellIDs[Index - 1], CellIDs[Index], StartTime + Index - 1, Unit))
+		{
+			return false;
+		}
+	}
+
+	// Only the cells this call reserved are released on failure, the ones the unit already held stay its own
+	TArray<int32, TInlineAllocator<64>> Reserved;
+	for (int32 Index = 0; Index < CellIDs.Num(); Index++)
+	{
+		if (GetReservation(CellIDs[Index], StartTime + Index) == Unit)
+		{
+			continue;
+		}
+
+		if (!Reserve(CellIDs[Index], StartTime + Index, Unit))
+		{
+			// A full time step, undo the part already reserved
+			for (const int32 ReservedIndex : Reserved)
+			{
+				Release(CellIDs[ReservedIndex], StartTime + ReservedIndex, Unit);
+			}
+			return false;
+		}
+		Reserved.Add(Index);
+	}
+
+	return true;
+}
+
+void FGridReservationTable::ReleasePath(TArrayView<const int32> CellIDs, int32 StartTime, int32 Unit)
+{
+	for (int32 Index = 0; Index < CellIDs.Num(); Index++)
+	{
+		Release(CellIDs[Index], StartTime + Index, Unit);
+	}
+}
+
+int32 FGridReservationTable::GetNumReservations(int32 Time) const
+{
+	if (!IsInHorizon(Time) || Steps[Time & (Horizon - 1)].Time != Time)
+	{
+		return 0;
+	}
+
+	const FEntry* StepEntries = GetStepEntries(Time);
+	int32 NumReservations = 0;
+	for (int32 Index = 0; Index < Capacity; Index++)
+	{
+		NumReservations += StepEntries[Index].Time == Time && StepEntries[Index].Unit != INDEX_NONE ? 1 : 0;
+	}
+	return NumReservations;
+}
+
+SIZE_T FGridReservationTable::GetAllocatedSize() const
+{
+	return Entries.GetAllocatedSize() + Steps.GetAllocatedSize();
+}
+
+int32 FGridReservationTable::FindEntry(int32 CellID, int32 Time) const
+{
+	if (!IsInHorizon(Time) || Steps[Time & (Horizon - 1)].Time != Time)
+	{
+		return INDEX_NONE;
+	}
+
+	const FEntry* StepEntries = GetStepEntries(Time);
+	for (uint32 Index = Hash(CellID), Probes = 0; Probes < (uint32)Capacity; Index = (Index + 1) & (Capacity - 1), Probes++)
+	{
+		const FEntry& Entry = StepEntries[Index];
+
+		if (Entry.Time != Time)
+		{
+			return INDEX_NONE;
+		}
+
+		if (Entry.Unit != INDEX_NONE && Entry.CellID == CellID)
+		{
+			return Index;
+		}
+	}
+
+	return INDEX_NONE;
+}
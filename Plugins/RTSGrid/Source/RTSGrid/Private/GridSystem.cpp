@@ -2,19 +2,110 @@
 
 
 #include "GridSystem.h"
+#include "BuildingBase.h"
+#include "RTSGrid.h"
+#include "RTSGridStats.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Components/TextRenderComponent.h"
 #include "Engine/StaticMesh.h"
+#include "Engine/World.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Misc/Paths.h"
 #include "UObject/ConstructorHelpers.h"
 
+namespace GridSystem
+{
+	// Tiles a Size x Size building covers with its smallest Column and Row corner on Coordinate
+	static void GetFootprint(const FGridCoord& Coordinate, int32 Size, TArray<FGridCoord>& OutFootprint)
+	{
+		OutFootprint.Reset(Size * Size);
+		for (int32 Column = 0; Column < Size; Column++)
+		{
+			for (int32 Row = 0; Row < Size; Row++)
+			{
+				OutFootprint.Add(FGridCoord(Coordinate.Column + Column, Coordinate.Row + Row));
+			}
+		}
+	}
+
+	// Memory of the components, only part of the grid's resource size with everything it owns
+	static const FName TextComponentsMemory(TEXT("TextComponents"));
+	static const FName PreviewGridMemory(TEXT("PreviewGrid"));
+
+	// Tick measures the memory usage this often, walking every subsystem and the preview instances each frame costs more than it tells
+	static const float MemoryUsageInterval = 0.25f;
+
+	// Fraction of the budget usage grows past the last overrun before Tick enforces the budget again
+	static const int64 MemoryBudgetHysteresis = 8;
+
+	static int64 GetBudgetBytes(float BudgetMB)
+	{
+		return (int64)(BudgetMB * 1024.0f * 1024.0f);
+	}
+
+	// Orders the corners of a rectangle and clamps it to the grid, returns false if nothing is left
+	static bool ClampRect(const FGridCoord& Dimensions, FGridCoord& Min, FGridCoord& Max)
+	{
+		const FGridCoord First(FMath::Max(FMath::Min(Min.Column, Max.Column), 0), FMath::Max(FMath::Min(Min.Row, Max.Row), 0));
+		const FGridCoord Last(FMath::Min(FMath::Max(Min.Column, Max.Column), Dimensions.Column - 1), FMath::Min(FMath::Max(Min.Row, Max.Row), Dimensions.Row - 1));
+
+		Min = First;
+		Max = Last;
+		return Min <= Max;
+	}
+}
+
+#if STATS
+// Moves an accumulator stat shared by every grid from the value this grid last reported to its current value
+#define RTSGRID_REPORT_DWORD_STAT(Stat, Reported, Current) \
+	{ \
+		const int32 CurrentValue = (Current); \
+		if (CurrentValue > Reported) { INC_DWORD_STAT_BY(Stat, CurrentValue - Reported); } \
+		else { DEC_DWORD_STAT_BY(Stat, Reported - CurrentValue); } \
+		Reported = CurrentValue; \
+	}
+#endif
+
 // Sets default values
 AGridSystem::AGridSystem()
 	: GridDimensions(FGridCoord(4))
 	, CellSize(100.0f)
+	, CellLayout(EGridCellLayout::RowMajor)
+	, bSparseStorage(false)
+	, SparseResidentChunks(1024)
 	, bShowPreviewGrid(true)
 	, bShowTileTextInfo(false)
 	, bDrawBoundingBox(true)
+	, FogOfWarPlayers(0)
+	, bFogOfWarLineOfSight(true)
+	, TileEditHistory(128)
+	, ReservationHorizon(32)
+	, MaxReservationsPerStep(1024)
+	, InfluenceMapUpdateInterval(0.2f)
+	, LockstepInputDelay(2)
+	, bLockstepSpawnBuildings(true)
+	, MemoryBudgetMB(0.0f)
+	, EnforcedMemoryBudgetMB(0.0f)
+	, PreviewCoarseness(1)
+	, bBudgetDroppedLabels(false)
+	, bReportedOverBudget(false)
+	, MemoryUsage(0)
+	, MemoryUsageAge(0.0f)
+	, EnforcedMemoryUsage(0)
+	, bOccupancyDirty(true)
+	, bRegionsDirty(true)
+	, bClearanceDirty(true)
+	, bLockstepRunning(false)
+	, bReportedDesync(false)
+	, bBakeDirty(false)
+	, bOccupancySnapshotDirty(true)
+	, bFogOfWarDirty(true)
+	, bFogOfWarCellsDirty(false)
+	, ReportedNumCells(0)
+	, ReportedNumBlockedTiles(0)
+	, ReportedNumPreviewInstances(0)
+	, ReportedNumTextComponents(0)
+	, ReportedMemoryBytes(0)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -38,6 +129,19 @@ void AGridSystem::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &AGridSystem::OnWorldPostActorTick);
+}
+
+void AGridSystem::EndPlay(const EEndPlayReason::Type EndPlayReason) 
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PostActorTickHandle.Reset();
+
+	// The bake traces against this world
+	Bake.Cancel();
+	Bake.Wait();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AGridSystem::OnConstruction(const FTransform& Transform) 
@@ -47,15 +151,273 @@ void AGridSystem::OnConstruction(const FTransform& Transform)
 	GenerateGrid();
 }
 
+void AGridSystem::BeginDestroy() 
+{
+#if STATS
+	// Take this grid out of the totals shared by every grid
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumCells, ReportedNumCells, 0);
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumBlockedCells, ReportedNumBlockedTiles, 0);
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumPreviewInstances, ReportedNumPreviewInstances, 0);
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumTextComponents, ReportedNumTextComponents, 0);
+	DEC_MEMORY_STAT_BY(STAT_RTSGrid_GridMemory, ReportedMemoryBytes);
+	ReportedMemoryBytes = 0;
+#endif
+
+	Bake.Cancel();
+	Bake.Wait();
+
+	Super::BeginDestroy();
+}
+
 // Called every frame
 void AGridSystem::Tick(float DeltaTime)
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_GridTick);
+
 	Super::Tick(DeltaTime);
 
+	if (FogOfWarPlayers > 0)
+	{
+		UpdateFogOfWar();
+	}
+
+	TickInfluenceMaps(DeltaTime);
+
+	PollBake();
+
+	if (bSparseStorage)
+	{
+		SparseTiles.SetMaxResidentChunks(SparseResidentChunks);
+	}
+
+	TickMemoryBudget(DeltaTime);
+
+	UpdateStats();
+}
+
+bool AGridSystem::ShouldTickIfViewportsOnly() const
+{
+	return Bake.IsRunning() || Bake.IsFinished() || bBakeDirty;
+}
+
+#if WITH_EDITOR
+void AGridSystem::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) 
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	MarkOccupancyDirty();
+}
+#endif
+
+void AGridSystem::UpdateStats() 
+{
+#if STATS
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumCells, ReportedNumCells, GeneratedGrid.Num());
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumBlockedCells, ReportedNumBlockedTiles, bSparseStorage ? SparseTiles.GetNumBlocked() : BlockedTiles.Num());
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumPreviewInstances, ReportedNumPreviewInstances, PreviewGridHISM ? PreviewGridHISM->GetInstanceCount() : 0);
+	RTSGRID_REPORT_DWORD_STAT(STAT_RTSGrid_NumTextComponents, ReportedNumTextComponents, TextComponents.Num());
+
+	// The usage Tick last measured, measuring it here would walk every subsystem each frame
+	if (MemoryUsage > ReportedMemoryBytes)
+	{
+		INC_MEMORY_STAT_BY(STAT_RTSGrid_GridMemory, MemoryUsage - ReportedMemoryBytes);
+	}
+	else
+	{
+		DEC_MEMORY_STAT_BY(STAT_RTSGrid_GridMemory, ReportedMemoryBytes - MemoryUsage);
+	}
+	ReportedMemoryBytes = MemoryUsage;
+#endif
+}
+
+void AGridSystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) 
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	const bool bWithComponents = CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::EstimatedTotal;
+	CollectMemoryUsage([&CumulativeResourceSize, bWithComponents](FName Subsystem, SIZE_T Bytes)
+	{
+		if (bWithComponents || (Subsystem != GridSystem::TextComponentsMemory && Subsystem != GridSystem::PreviewGridMemory))
+		{
+			CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Subsystem, Bytes);
+		}
+	});
+}
+
+int64 AGridSystem::GetMemoryUsage() 
+{
+	int64 Total = 0;
+	CollectMemoryUsage([&Total](FName Subsystem, SIZE_T Bytes)
+	{
+		Total += Bytes;
+	});
+
+	MemoryUsage = Total;
+	MemoryUsageAge = 0.0f;
+	return Total;
+}
+
+void AGridSystem::GetMemoryUsageBySubsystem(TMap<FName, SIZE_T>& OutBytes) 
+{
+	OutBytes.Reset();
+	CollectMemoryUsage([&OutBytes](FName Subsystem, SIZE_T Bytes)
+	{
+		OutBytes.Add(Subsystem, Bytes);
+	});
+}
+
+void AGridSystem::CollectMemoryUsage(TFunctionRef<void(FName, SIZE_T)> Report) 
+{
+	Report(TEXT("GeneratedGrid"), GeneratedGrid.GetAllocatedSize());
+	Report(TEXT("BlockedTiles"), BlockedTiles.GetAllocatedSize());
+	Report(TEXT("Occupancy"), Occupancy.GetAllocatedSize() + OccupancyPublisher.GetAllocatedSize());
+	Report(TEXT("SparseTiles"), SparseTiles.GetAllocatedSize());
+	Report(TEXT("TileJournal"), TileJournal.GetAllocatedSize());
+	Report(TEXT("Bake"), Bake.GetAllocatedSize() + CellHeights.GetAllocatedSize() + CellSlopes.GetAllocatedSize());
+	Report(TEXT("Regions"), Regions.GetAllocatedSize());
+	Report(TEXT("Clearance"), Clearance.GetAllocatedSize());
+	Report(TEXT("Reservations"), Reservations.GetAllocatedSize());
+	Report(TEXT("FogOfWar"), FogOfWar.GetAllocatedSize());
+
+	SIZE_T InfluenceMapBytes = InfluenceMaps.GetAllocatedSize();
+	for (const TPair<FName, TUniquePtr<FGridInfluenceMap>>& Pair : InfluenceMaps)
+	{
+		InfluenceMapBytes += sizeof(FGridInfluenceMap) + Pair.Value->GetAllocatedSize();
+	}
+	Report(TEXT("InfluenceMaps"), InfluenceMapBytes);
+
+	SIZE_T PlacementBytes = PlacementMasks.GetAllocatedSize() + TileLayers.GetAllocatedSize();
+	for (const TPair<TWeakObjectPtr<UClass>, FGridPlacementMask>& Pair : PlacementMasks)
+	{
+		PlacementBytes += Pair.Value.GetAllocatedSize();
+	}
+	for (const TPair<FName, FGridBitMask>& Pair : TileLayers)
+	{
+		PlacementBytes += Pair.Value.GetAllocatedSize();
+	}
+	Report(TEXT("Placement"), PlacementBytes);
+
+	// The labels only hold a short text each, their size is mostly the component itself
+	Report(GridSystem::TextComponentsMemory, TextComponents.GetAllocatedSize() + TextComponents.Num() * (SIZE_T)UTextRenderComponent::StaticClass()->GetStructureSize());
+	Report(GridSystem::PreviewGridMemory, PreviewGridHISM ? PreviewGridHISM->GetResourceSizeBytes(EResourceSizeMode::Exclusive) : 0);
+}
+
+void AGridSystem::EnforceMemoryBudget() 
+{
+	if (MemoryBudgetMB != EnforcedMemoryBudgetMB)
+	{
+		// A new budget starts again from every detail
+		const bool bWasDegraded = bBudgetDroppedLabels || PreviewCoarseness > 1;
+		EnforcedMemoryBudgetMB = MemoryBudgetMB;
+		bBudgetDroppedLabels = false;
+		PreviewCoarseness = 1;
+		bReportedOverBudget = false;
+		EnforcedMemoryUsage = 0;
+
+		if (bWasDegraded)
+		{
+			GenerateVisualGrid();
+		}
+	}
+
+	if (MemoryBudgetMB <= 0.0f)
+	{
+		return;
+	}
+
+	const int64 Budget = GridSystem::GetBudgetBytes(MemoryBudgetMB);
+	int64 Usage = GetMemoryUsage();
+	if (Usage <= Budget)
+	{
+		return;
+	}
+
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_EnforceMemoryBudget);
+
+	EnforcedMemoryUsage = Usage;
+
+	if (TextComponents.Num() > 0)
+	{
+		bBudgetDroppedLabels = true;
+		GenerateVisualGrid();
+		Usage = GetMemoryUsage();
+	}
+
+	// Halving the preview resolution quarters its instances
+	const int32 MaxCoarseness = (int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Max3(GridDimensions.Column, GridDimensions.Row, 1));
+	while (Usage > Budget && bShowPreviewGrid && PreviewGridHISM && PreviewGridHISM->GetInstanceCount() > 1 && PreviewCoarseness < MaxCoarseness)
+	{
+		PreviewCoarseness *= 2;
+		GenerateVisualGrid();
+		Usage = GetMemoryUsage();
+	}
+
+	if (Usage > Budget)
+	{
+		ReleaseCaches();
+		Usage = GetMemoryUsage();
+	}
+
+	if (Usage > Budget && !bReportedOverBudget)
+	{
+		UE_LOG(LogRTSGrid, Warning, TEXT("%s uses %.2f MB, over its %.2f MB budget with nothing left to drop"), *GetName(), Usage / (1024.0 * 1024.0), MemoryBudgetMB);
+		bReportedOverBudget = true;
+	}
+}
+
+void AGridSystem::TickMemoryBudget(float DeltaTime) 
+{
+	MemoryUsageAge += DeltaTime;
+	if (MemoryUsageAge >= GridSystem::MemoryUsageInterval)
+	{
+		GetMemoryUsage();
+	}
+
+	if (MemoryBudgetMB != EnforcedMemoryBudgetMB)
+	{
+		EnforceMemoryBudget();
+		return;
+	}
+
+	if (MemoryBudgetMB <= 0.0f)
+	{
+		return;
+	}
+
+	// Released caches are rebuilt on demand to about the size they had, enforcing again before usage grew past the last overrun would only release them every frame
+	const int64 Budget = GridSystem::GetBudgetBytes(MemoryBudgetMB);
+	if (MemoryUsage > Budget && MemoryUsage > EnforcedMemoryUsage + Budget / GridSystem::MemoryBudgetHysteresis)
+	{
+		EnforceMemoryBudget();
+	}
+}
+
+int32 AGridSystem::GetPreviewCoarseness() const
+{
+	return PreviewCoarseness;
+}
+
+void AGridSystem::ReleaseCaches() 
+{
+	Regions = FGridRegions();
+	bRegionsDirty = true;
+
+	Clearance = FGridClearance();
+	bClearanceDirty = true;
+
+	PlacementMasks.Empty();
+
+	if (!Bake.IsRunning() && !Bake.IsFinished())
+	{
+		Bake.Release();
+	}
 }
 
 void AGridSystem::GenerateVisualGrid() 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_GenerateVisualGrid);
+	INC_DWORD_STAT(STAT_RTSGrid_VisualGridRebuilds);
+
 	if (!bShowPreviewGrid)
 	{
 		PreviewGridHISM->ClearInstances();
@@ -74,21 +436,22 @@ void AGridSystem::GenerateVisualGrid()
 	{
 		FGridCoord CurrentTile = GeneratedGrid[i];
 
-		// Generate Mesh Grid
-		if (bShowPreviewGrid && PreviewGridHISM)
+		// Generate Mesh Grid, over the memory budget one instance covers PreviewCoarseness x PreviewCoarseness tiles
+		if (bShowPreviewGrid && PreviewGridHISM && CurrentTile.Column % PreviewCoarseness == 0 && CurrentTile.Row % PreviewCoarseness == 0)
 		{
+			const float CoarseOffset = (PreviewCoarseness - 1) * 0.5f * CellSize;
 			const FVector TileLocation = FVector(
-				CurrentTile.Row * CellSize, 
-				CurrentTile.Column * CellSize,
+				CurrentTile.Row * CellSize + CoarseOffset, 
+				CurrentTile.Column * CellSize + CoarseOffset,
 				0
 			);
-			const FVector Scale = FVector(CellSize * 0.01);
+			const FVector Scale = FVector(CellSize * 0.01 * PreviewCoarseness);
 			const FTransform T = FTransform(FRotator::ZeroRotator, TileLocation, Scale);
 			PreviewGridHISM->AddInstance(T);
 		}
 
 		// Add Text Components
-		if (bShowTileTextInfo)
+		if (bShowTileTextInfo && !bBudgetDroppedLabels)
 		{
 			UTextRenderComponent* Text = NewObject<UTextRenderComponent>(this);
 			TextComponents.Add(Text);
@@ -118,7 +481,7 @@ void AGridSystem::GenerateVisualGrid()
 				FFormatNamedArguments Args;
 				Args.Add("x", CurrentTile.Row);
 				Args.Add("y", CurrentTile.Column);
-				Args.Add("id", i);
+				Args.Add("id", GetLayout().ToCellID(CurrentTile));
 
 				FText ShowCoords = FText::Format(
 					NSLOCTEXT("gridsys", "DebugTextCoords", "X:{x}, Y:{y}, \nID:{id}"), 
@@ -146,11 +509,32 @@ void AGridSystem::GenerateVisualGrid()
 			2.0f
 		);
 	}
+
+	UpdateStats();
 }
 
 TArray<FGridCoord> AGridSystem::GenerateGrid() 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_GenerateGrid);
+
 	GeneratedGrid.Empty();
+	MarkOccupancyDirty();
+
+	// Only the tiles set in BlockedTiles are stored, nothing is allocated per cell
+	if (bSparseStorage)
+	{
+		const FString PageFilePath = FPaths::ProjectSavedDir() / TEXT("RTSGrid") / TEXT("Pages") / FString::Printf(TEXT("%s_%s.page"), *GetName(), *FGuid::NewGuid().ToString());
+		SparseTiles.Reset(PageFilePath, SparseResidentChunks);
+
+		for (const FGridCoord& Tile : BlockedTiles)
+		{
+			SparseTiles.SetBlocked(Tile, true);
+		}
+
+		GenerateVisualGrid();
+		EnforceMemoryBudget();
+		return GeneratedGrid;
+	}
 
 	int32 xMin = 0;
 	int32 xMax = GridDimensions.Row;
@@ -158,21 +542,45 @@ TArray<FGridCoord> AGridSystem::GenerateGrid()
 	int32 yMin = 0;
 	int32 yMax = GridDimensions.Column;
 
-	for(int i = xMin; i < xMax; i++)
+	GeneratedGrid.Reserve(GridDimensions.Row * GridDimensions.Column);
+
+	// Rows are the fastest changing component so that GeneratedGrid[ID]
+	// is the coordinate returned by GetCoordinateFromCellID(ID)
+	for(int j = yMin; j < yMax; j++)
 	{
-		for(int j = yMin; j < yMax; j++)
+		for(int i = xMin; i < xMax; i++)
 		{
-			FGridCoord Coord(i, j);
+			FGridCoord Coord(j, i);
 			GeneratedGrid.Emplace(Coord);
 		}
 	}
 
 	GenerateVisualGrid();
+	EnforceMemoryBudget();
 	return GeneratedGrid;
 }
 
+bool AGridSystem::RejectSparseStorage(const TCHAR* Feature) 
+{
+	if (!bSparseStorage)
+	{
+		return false;
+	}
+
+	bool bAlreadyReported = false;
+	ReportedSparseRejections.Add(FName(Feature), &bAlreadyReported);
+	if (!bAlreadyReported)
+	{
+		UE_LOG(LogRTSGrid, Warning, TEXT("%s cannot %s with bSparseStorage, it needs every cell of the grid in memory"), *GetName(), Feature);
+	}
+
+	return true;
+}
+
 FVector AGridSystem::GetGridOriginRelative() 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_BoundsQueries);
+
 	FVector Result = FVector::ZeroVector;
 
 	const float CellHalfSize = CellSize * 0.5f;
@@ -185,26 +593,36 @@ FVector AGridSystem::GetGridOriginRelative()
 
 FVector AGridSystem::GetGridWorldOriginWorld() 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_BoundsQueries);
+
 	return GetGridOriginRelative() + GetActorLocation();
 }
 
 FVector2D AGridSystem::GetGridSize() 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_BoundsQueries);
+
 	return (GridDimensions * CellSize).ToVector2D();
 }
 
 FVector2D AGridSystem::GetGridExtents() 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_BoundsQueries);
+
 	return GetGridSize() * 0.5f;
 }
 
 FVector AGridSystem::GetGridRelativeFromWorld(FVector WorldLocation) 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_RelativeConversion);
+
 	return WorldLocation - GetActorLocation();
 }
 
 FVector AGridSystem::GetCellCenterFromRelative(FVector RelativeLocation, bool bReturnWorldSpace) 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_RelativeConversion);
+
 	int32 ID;
 
 	const FGridCoord Coord = GetCoordinateFromRelative(RelativeLocation, ID);
@@ -219,21 +637,35 @@ FVector AGridSystem::GetCellCenterFromRelative(FVector RelativeLocation, bool bR
 
 bool AGridSystem::IsInGridBounds(FGridCoord Coordinate) 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_BoundsQueries);
+
 	return (Coordinate >= FGridCoord(0, 0) && Coordinate < GridDimensions);
 }
 
 bool AGridSystem::IsClearTile(FGridCoord Coordinate) 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_IsClearTile);
+	INC_DWORD_STAT(STAT_RTSGrid_BlockedTileLookups);
+
+	if (bSparseStorage)
+	{
+		return !SparseTiles.IsBlocked(Coordinate);
+	}
+
 	return !BlockedTiles.Contains(Coordinate);
 }
 
 bool AGridSystem::IsValidLocation(FGridCoord Coordinate) 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_IsValidLocation);
+
 	return IsInGridBounds(Coordinate) && IsClearTile(Coordinate);
 }
 
 FGridCoord AGridSystem::GetCoordinateFromRelative(FVector RelativeLocation, int32& CellID) 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_RelativeConversion);
+
 	FGridCoord Coord;
 
 	Coord.Column = FMath::RoundToInt(RelativeLocation.Y / CellSize);
@@ -246,16 +678,1169 @@ FGridCoord AGridSystem::GetCoordinateFromRelative(FVector RelativeLocation, int3
 
 FGridCoord AGridSystem::GetCoordinateFromCellID(int32 ID) 
 {
-	FGridCoord Coord;
-
-	Coord.Column = ID / GridDimensions.Row;
-	Coord.Row = ID % GridDimensions.Row;
+	RTSGRID_SCOPE_CYCLE_COUNTER_VERBOSE(STAT_RTSGrid_CellIDConversion);
+	INC_DWORD_STAT(STAT_RTSGrid_CellIDConversions);
 
-	return Coord;	
+	return GetLayout().ToCoordinate(ID);
 }
 
 int32 AGridSystem::GetCellIDFromCoordinate(FGridCoord Coordinate) 
 {
-	return (GridDimensions.Row * Coordinate.Column) + Coordinate.Row;
+	RTSGRID_SCOPE_CYCLE_COUNTER_VERBOSE(STAT_RTSGrid_CellIDConversion);
+	INC_DWORD_STAT(STAT_RTSGrid_CellIDConversions);
+
+	return GetLayout().ToCellID(Coordinate);
+}
+
+void AGridSystem::SetTileBlocked(FGridCoord Coordinate, bool bBlocked) 
+{
+	ApplyTileBlocked(Coordinate, bBlocked);
+}
+
+bool AGridSystem::ApplyTileBlocked(const FGridCoord& Coordinate, bool bBlocked) 
+{
+	if (bSparseStorage)
+	{
+		return GetLayout().IsInBounds(Coordinate) && SparseTiles.SetBlocked(Coordinate, bBlocked);
+	}
+
+	FGridOccupancy& CurrentOccupancy = SyncOccupancy();
+
+	bool bChanged;
+	if (bBlocked)
+	{
+		bool bWasBlocked = false;
+		BlockedTiles.Add(Coordinate, &bWasBlocked);
+		bChanged = !bWasBlocked;
+	}
+	else
+	{
+		bChanged = BlockedTiles.Remove(Coordinate) > 0;
+	}
+
+	if (!bChanged || !Layout.IsInBounds(Coordinate))
+	{
+		return false;
+	}
+
+	CurrentOccupancy.SetBlocked(Layout.ToCellID(Coordinate), bBlocked);
+	OccupancyPublisher.MarkChanged(Layout.ToCellID(Coordinate));
+	bOccupancySnapshotDirty = true;
+
+	if (!bRegionsDirty)
+	{
+		Regions.SetBlocked(Layout.ToCellID(Coordinate), bBlocked);
+	}
+
+	if (!bClearanceDirty)
+	{
+		Clearance.SetBlocked(Coordinate, bBlocked);
+	}
+
+	MarkPlacementMasksDirty(Coordinate.Column);
+
+	// Units are invalidated once per fog of war update, however many tiles a bulk edit changed
+	if (bFogOfWarLineOfSight)
+	{
+		if (bFogOfWarCellsDirty)
+		{
+			FogOfWarDirtyMin = FGridCoord(FMath::Min(FogOfWarDirtyMin.Column, Coordinate.Column), FMath::Min(FogOfWarDirtyMin.Row, Coordinate.Row));
+			FogOfWarDirtyMax = FGridCoord(FMath::Max(FogOfWarDirtyMax.Column, Coordinate.Column), FMath::Max(FogOfWarDirtyMax.Row, Coordinate.Row));
+		}
+		else
+		{
+			FogOfWarDirtyMin = Coordinate;
+			FogOfWarDirtyMax = Coordinate;
+			bFogOfWarCellsDirty = true;
+		}
+	}
+
+	return true;
+}
+
+void AGridSystem::SetTilesBlocked(const TArray<FGridCoord>& Coordinates, bool bBlocked, AActor* PlacedActor) 
+{
+	SyncOccupancy();
+	const FGridLayout& CurrentLayout = GetLayout();
+
+	TileJournal.SetMaxOps(TileEditHistory);
+	TileJournal.BeginOp(PlacedActor);
+
+	for (const FGridCoord& Coordinate : Coordinates)
+	{
+		if (CurrentLayout.IsInBounds(Coordinate) && ApplyTileBlocked(Coordinate, bBlocked))
+		{
+			TileJournal.Record(CurrentLayout.ToCellID(Coordinate), !bBlocked);
+		}
+	}
+
+	EndTileEdit();
+}
+
+void AGridSystem::SetRectBlocked(FGridCoord Min, FGridCoord Max, bool bBlocked) 
+{
+	SyncOccupancy();
+	const FGridLayout& CurrentLayout = GetLayout();
+
+	TileJournal.SetMaxOps(TileEditHistory);
+	TileJournal.BeginOp();
+
+	// Rows are the inner loop so the CellIDs of the RowMajor layout follow each other and merge into runs
+	GridSystem::ClampRect(CurrentLayout.Dimensions, Min, Max);
+	for (int32 Column = Min.Column; Column <= Max.Column; Column++)
+	{
+		for (int32 Row = Min.Row; Row <= Max.Row; Row++)
+		{
+			const FGridCoord Coordinate(Column, Row);
+			if (ApplyTileBlocked(Coordinate, bBlocked))
+			{
+				TileJournal.Record(CurrentLayout.ToCellID(Coordinate), !bBlocked);
+			}
+		}
+	}
+
+	EndTileEdit();
+}
+
+void AGridSystem::UndoTileEdit() 
+{
+	if (RejectLockstep(TEXT("undo tile edits")))
+	{
+		return;
+	}
+
+	SyncOccupancy();
+
+	if (const FGridJournalOp* Op = TileJournal.Undo())
+	{
+		ReplayTileEdit(*Op, true);
+	}
+}
+
+void AGridSystem::RedoTileEdit() 
+{
+	if (RejectLockstep(TEXT("redo tile edits")))
+	{
+		return;
+	}
+
+	SyncOccupancy();
+
+	if (const FGridJournalOp* Op = TileJournal.Redo())
+	{
+		ReplayTileEdit(*Op, false);
+	}
+}
+
+bool AGridSystem::CanUndoTileEdit() const
+{
+	return !bLockstepRunning && TileJournal.CanUndo();
+}
+
+bool AGridSystem::CanRedoTileEdit() const
+{
+	return !bLockstepRunning && TileJournal.CanRedo();
+}
+
+bool AGridSystem::RejectLockstep(const TCHAR* Feature) 
+{
+	if (!bLockstepRunning)
+	{
+		return false;
+	}
+
+	UE_LOG(LogRTSGrid, Warning, TEXT("%s cannot %s while lockstep runs, only this peer would change"), *GetName(), Feature);
+	return true;
+}
+
+void AGridSystem::ReplayTileEdit(const FGridJournalOp& Op, bool bUndo) 
+{
+	for (const FGridJournalRun& Run : TileJournal.GetRuns(Op))
+	{
+		const bool bBlocked = bUndo ? Run.bWasBlocked : !Run.bWasBlocked;
+		for (int32 CellID = Run.FirstCellID; CellID < Run.FirstCellID + Run.NumCells; CellID++)
+		{
+			ApplyTileBlocked(FGridCoord::FromCellID(CellID, Layout), bBlocked);
+		}
+	}
+
+	// The actor is kept hidden rather than destroyed so the edit can be redone
+	if (AActor* Actor = Op.Actor.Get())
+	{
+		Actor->SetActorHiddenInGame(bUndo);
+		Actor->SetActorEnableCollision(!bUndo);
+		Actor->SetActorTickEnabled(!bUndo);
+	}
+}
+
+void AGridSystem::EndTileEdit() 
+{
+	TArray<TWeakObjectPtr<AActor>> DiscardedActors;
+	TileJournal.EndOp(DiscardedActors);
+	DestroyDiscardedActors(DiscardedActors);
+}
+
+void AGridSystem::DestroyDiscardedActors(const TArray<TWeakObjectPtr<AActor>>& Actors) 
+{
+	for (const TWeakObjectPtr<AActor>& Actor : Actors)
+	{
+		if (Actor.IsValid())
+		{
+			Actor->Destroy();
+		}
+	}
+}
+
+void AGridSystem::BakeBlockedTiles() 
+{
+	BakeBlockedTilesInRect(FGridCoord(0, 0), GridDimensions - 1);
+}
+
+void AGridSystem::BakeBlockedTilesInRect(FGridCoord Min, FGridCoord Max) 
+{
+	UWorld* World = GetWorld();
+	if (!World || !GridSystem::ClampRect(GridDimensions, Min, Max))
+	{
+		return;
+	}
+
+	// The bake holds a byte per tile of the rectangle, sparse grids bake no more than the chunks they keep in memory
+	if (bSparseStorage)
+	{
+		const int64 NumTiles = (int64)(Max.Column - Min.Column + 1) * (Max.Row - Min.Row + 1);
+		const int64 MaxTiles = (int64)FMath::Max(SparseResidentChunks, 1) * FGridChunkStore::ChunkSize * FGridChunkStore::ChunkSize;
+		if (NumTiles > MaxTiles)
+		{
+			UE_LOG(LogRTSGrid, Warning, TEXT("%s cannot bake %lld tiles at once with bSparseStorage, bake rectangles of at most %lld tiles"), *GetName(), NumTiles, MaxTiles);
+			return;
+		}
+	}
+
+	FGridBakeRequest Request;
+	Request.World = World;
+	Request.Origin = GetActorLocation();
+	Request.CellSize = CellSize;
+	Request.Min = Min;
+	Request.Max = Max;
+	Request.Settings = BakeSettings;
+	Request.IgnoredActors.Add(this);
+
+	if (Request.Settings.bBakeHeightAndSlope && RejectSparseStorage(TEXT("bake heights and slopes")))
+	{
+		Request.Settings.bBakeHeightAndSlope = false;
+	}
+
+	Bake.Start(Request);
+}
+
+void AGridSystem::MarkBakeDirty(FBox WorldBounds) 
+{
+	// Cell centers are CellSize apart from the actor location, round to the closest ones
+	const FVector RelativeMin = (WorldBounds.Min - GetActorLocation()) / CellSize;
+	const FVector RelativeMax = (WorldBounds.Max - GetActorLocation()) / CellSize;
+	const FGridCoord Min(FMath::RoundToInt(RelativeMin.Y), FMath::RoundToInt(RelativeMin.X));
+	const FGridCoord Max(FMath::RoundToInt(RelativeMax.Y), FMath::RoundToInt(RelativeMax.X));
+
+	if (bBakeDirty)
+	{
+		BakeDirtyMin = FGridCoord(FMath::Min(BakeDirtyMin.Column, Min.Column), FMath::Min(BakeDirtyMin.Row, Min.Row));
+		BakeDirtyMax = FGridCoord(FMath::Max(BakeDirtyMax.Column, Max.Column), FMath::Max(BakeDirtyMax.Row, Max.Row));
+	}
+	else
+	{
+		BakeDirtyMin = Min;
+		BakeDirtyMax = Max;
+		bBakeDirty = true;
+	}
+}
+
+void AGridSystem::CancelBake() 
+{
+	bBakeDirty = false;
+
+	Bake.Cancel();
+	Bake.Release();
+}
+
+bool AGridSystem::IsBaking() const
+{
+	return Bake.IsRunning();
+}
+
+float AGridSystem::GetBakeProgress() const
+{
+	return Bake.IsRunning() ? Bake.GetProgress() : 0.0f;
+}
+
+float AGridSystem::GetCellHeight(FGridCoord Coordinate) 
+{
+	const FGridLayout& CurrentLayout = GetLayout();
+	return CurrentLayout.IsInBounds(Coordinate) && CellHeights.Num() > 0 ? CellHeights[CurrentLayout.ToCellID(Coordinate)] : GetActorLocation().Z;
+}
+
+float AGridSystem::GetCellSlope(FGridCoord Coordinate) 
+{
+	const FGridLayout& CurrentLayout = GetLayout();
+	return CurrentLayout.IsInBounds(Coordinate) && CellSlopes.Num() > 0 ? CellSlopes[CurrentLayout.ToCellID(Coordinate)] : 0.0f;
+}
+
+void AGridSystem::FinishBake() 
+{
+	// Applying may start baking the dirty tiles, which is waited for too
+	while (Bake.IsRunning() || Bake.IsFinished() || bBakeDirty)
+	{
+		Bake.Wait();
+		PollBake();
+	}
+}
+
+void AGridSystem::PollBake() 
+{
+	if (Bake.IsFinished())
+	{
+		ApplyBake();
+	}
+
+	if (bBakeDirty && !Bake.IsRunning())
+	{
+		bBakeDirty = false;
+		BakeBlockedTilesInRect(BakeDirtyMin, BakeDirtyMax);
+	}
+}
+
+void AGridSystem::ApplyBake() 
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_ApplyBake);
+
+	const FGridBakeRequest& Request = Bake.GetRequest();
+	SyncOccupancy();
+	const FGridLayout& CurrentLayout = GetLayout();
+
+	// Thrown away if the grid moved or changed size while baking
+	const bool bStillMatches = CurrentLayout.IsInBounds(Request.Max) && Request.Origin == GetActorLocation() && Request.CellSize == CellSize;
+
+	if (!Bake.WasCancelled() && bStillMatches)
+	{
+		// Labeling the regions once is cheaper than following thousands of tile changes
+		bRegionsDirty = true;
+		bClearanceDirty = true;
+
+		// The slopes change too
+		MarkPlacementMasksDirty(INDEX_NONE);
+
+		TileJournal.SetMaxOps(TileEditHistory);
+		TileJournal.BeginOp();
+
+		for (int32 Column = Request.Min.Column; Column <= Request.Max.Column; Column++)
+		{
+			for (int32 Row = Request.Min.Row; Row <= Request.Max.Row; Row++)
+			{
+				const FGridCoord Coordinate(Column, Row);
+				const bool bBlocked = Bake.IsBlocked(Coordinate);
+				if (ApplyTileBlocked(Coordinate, bBlocked))
+				{
+					TileJournal.Record(CurrentLayout.ToCellID(Coordinate), !bBlocked);
+				}
+			}
+		}
+
+		EndTileEdit();
+
+		// Heights and slopes are stored for every cell
+		if (Request.Settings.bBakeHeightAndSlope && !bSparseStorage)
+		{
+			if (CellHeights.Num() != CurrentLayout.GetNumCellIDs())
+			{
+				CellHeights.Init(GetActorLocation().Z, CurrentLayout.GetNumCellIDs());
+				CellSlopes.Init(0.0f, CurrentLayout.GetNumCellIDs());
+			}
+
+			for (int32 Column = Request.Min.Column; Column <= Request.Max.Column; Column++)
+			{
+				for (int32 Row = Request.Min.Row; Row <= Request.Max.Row; Row++)
+				{
+					const FGridCoord Coordinate(Column, Row);
+					const int32 CellID = CurrentLayout.ToCellID(Coordinate);
+					CellHeights[CellID] = Bake.GetHeight(Coordinate);
+					CellSlopes[CellID] = Bake.GetSlope(Coordinate);
+				}
+			}
+		}
+	}
+
+	Bake.Release();
+}
+
+void AGridSystem::MarkOccupancyDirty() 
+{
+	bOccupancyDirty = true;
+}
+
+const FGridOccupancy& AGridSystem::GetOccupancy() 
+{
+	RejectSparseStorage(TEXT("read the dense occupancy"));
+	return SyncOccupancy();
+}
+
+FGridOccupancy& AGridSystem::SyncOccupancy() 
+{
+	const FGridLayout& CurrentLayout = GetLayout();
+
+	const bool bLayoutChanged = SyncedLayout.Dimensions != CurrentLayout.Dimensions || SyncedLayout.Layout != CurrentLayout.Layout;
+
+	if (bOccupancyDirty || bLayoutChanged)
+	{
+		RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_RebuildOccupancy);
+
+		// The journal refers to cells by CellID, which a new layout changes
+		if (bLayoutChanged)
+		{
+			TArray<TWeakObjectPtr<AActor>> DiscardedActors;
+			TileJournal.Reset(DiscardedActors);
+			DestroyDiscardedActors(DiscardedActors);
+			CellHeights.Empty();
+			CellSlopes.Empty();
+			SyncedLayout = CurrentLayout;
+		}
+
+		// With bSparseStorage the tiles only live in SparseTiles, the occupancy is left an empty grid
+		// where every coordinate reads as blocked rather than a copy of BlockedTiles that goes stale
+		Occupancy.Reset(bSparseStorage ? FGridLayout() : CurrentLayout, BlockedTiles);
+		OccupancyPublisher.Reset();
+		bOccupancyDirty = false;
+		bOccupancySnapshotDirty = true;
+		bRegionsDirty = true;
+		bClearanceDirty = true;
+		MarkPlacementMasksDirty(INDEX_NONE);
+
+		// Any cell may have changed, every sight has to be computed again
+		bFogOfWarDirty = true;
+	}
+
+	return Occupancy;
+}
+
+FGridOccupancySnapshotRef AGridSystem::GetOccupancySnapshot() 
+{
+	RejectSparseStorage(TEXT("read occupancy snapshots"));
+
+	if (!OccupancyPublisher.GetPublished().IsValid())
+	{
+		PublishOccupancySnapshot();
+	}
+
+	return OccupancyPublisher.GetPublished().ToSharedRef();
+}
+
+void AGridSystem::PublishOccupancySnapshot() 
+{
+	const FGridOccupancy& CurrentOccupancy = SyncOccupancy();
+
+	if (bOccupancySnapshotDirty || !OccupancyPublisher.GetPublished().IsValid())
+	{
+		RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_OccupancySnapshot);
+
+		// Shares every chunk with the occupancy, readers keep the previous snapshot alive for as long as they use it
+		OccupancyPublisher.Publish(CurrentOccupancy);
+		bOccupancySnapshotDirty = false;
+	}
+}
+
+void AGridSystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds) 
+{
+	if (World == GetWorld())
+	{
+		PublishOccupancySnapshot();
+	}
+}
+
+bool AGridSystem::HasLineOfSight(FGridCoord From, FGridCoord To) 
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_LineOfSight);
+	INC_DWORD_STAT(STAT_RTSGrid_LineOfSightQueries);
+
+	if (bSparseStorage)
+	{
+		return FGridLineOfSight::HasLineOfSight(SparseTiles, GetLayout(), From, To);
+	}
+
+	return FGridLineOfSight::HasLineOfSight(GetOccupancy(), From, To);
+}
+
+TArray<bool> AGridSystem::HasLineOfSightBatch(const TArray<FGridLineQuery>& Queries) 
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_LineOfSight);
+	INC_DWORD_STAT_BY(STAT_RTSGrid_LineOfSightQueries, Queries.Num());
+
+	TArray<bool> Results;
+	Results.SetNumUninitialized(Queries.Num());
+
+	// Sparse storage pages chunks in as it is read, so its queries stay on the game thread
+	if (bSparseStorage)
+	{
+		for (int32 Index = 0; Index < Queries.Num(); Index++)
+		{
+			Results[Index] = FGridLineOfSight::HasLineOfSight(SparseTiles, GetLayout(), Queries[Index].From, Queries[Index].To);
+		}
+		return Results;
+	}
+
+	FGridLineOfSight::HasLineOfSightBatch(GetOccupancy(), Queries, Results);
+	return Results;
+}
+
+bool AGridSystem::AreCellsConnected(FGridCoord From, FGridCoord To) 
+{
+	if (RejectSparseStorage(TEXT("label regions")))
+	{
+		return false;
+	}
+
+	const FGridRegions& CurrentRegions = SyncRegions();
+	return Layout.IsInBounds(From) && Layout.IsInBounds(To) && CurrentRegions.AreConnected(Layout.ToCellID(From), Layout.ToCellID(To));
+}
+
+int32 AGridSystem::GetCellRegion(FGridCoord Coordinate) 
+{
+	if (RejectSparseStorage(TEXT("label regions")))
+	{
+		return INDEX_NONE;
+	}
+
+	const FGridRegions& CurrentRegions = SyncRegions();
+	return Layout.IsInBounds(Coordinate) ? CurrentRegions.GetRegion(Layout.ToCellID(Coordinate)) : INDEX_NONE;
+}
+
+bool AGridSystem::WouldSealRegion(const TArray<FGridCoord>& Coordinates) 
+{
+	if (RejectSparseStorage(TEXT("label regions")))
+	{
+		return false;
+	}
+
+	FGridRegions& CurrentRegions = SyncRegions();
+
+	TArray<int32, TInlineAllocator<16>> CellIDs;
+	for (const FGridCoord& Coordinate : Coordinates)
+	{
+		if (Layout.IsInBounds(Coordinate))
+		{
+			CellIDs.Add(Layout.ToCellID(Coordinate));
+		}
+	}
+
+	return CurrentRegions.WouldSplit(CellIDs);
+}
+
+const FGridRegions& AGridSystem::GetRegions() 
+{
+	return SyncRegions();
+}
+
+FGridRegions& AGridSystem::SyncRegions() 
+{
+	const FGridOccupancy& CurrentOccupancy = SyncOccupancy();
+
+	if (bRegionsDirty)
+	{
+		Regions.Reset(CurrentOccupancy);
+		bRegionsDirty = false;
+	}
+
+	return Regions;
+}
+
+int32 AGridSystem::GetCellClearance(FGridCoord Coordinate) 
+{
+	if (bSparseStorage)
+	{
+		return IsValidLocation(Coordinate) ? 1 : 0;
+	}
+
+	const FGridClearance& CurrentClearance = SyncClearance();
+	return Layout.IsInBounds(Coordinate) ? CurrentClearance.GetClearance(Layout.ToCellID(Coordinate)) : 0;
+}
+
+bool AGridSystem::CanFitFootprint(FGridCoord Coordinate, int32 Size) 
+{
+	if (bSparseStorage)
+	{
+		// No clearance to read, every tile of the footprint is checked
+		for (int32 Column = Coordinate.Column; Column < Coordinate.Column + Size; Column++)
+		{
+			for (int32 Row = Coordinate.Row; Row < Coordinate.Row + Size; Row++)
+			{
+				if (!IsValidLocation(FGridCoord(Column, Row)))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	const FGridClearance& CurrentClearance = SyncClearance();
+	return Layout.IsInBounds(Coordinate) && CurrentClearance.Fits(Layout.ToCellID(Coordinate), Size);
+}
+
+const FGridClearance& AGridSystem::GetClearance() 
+{
+	return SyncClearance();
+}
+
+FGridClearance& AGridSystem::SyncClearance() 
+{
+	const FGridOccupancy& CurrentOccupancy = SyncOccupancy();
+
+	if (bClearanceDirty)
+	{
+		Clearance.Reset(CurrentOccupancy);
+		bClearanceDirty = false;
+	}
+
+	return Clearance;
+}
+
+void AGridSystem::SetTileLayer(FName Layer, FGridCoord Coordinate, bool bOnLayer) 
+{
+	// Layers are a bit per tile of the grid, and only placement masks read them
+	if (!IsInGridBounds(Coordinate) || RejectSparseStorage(TEXT("set tile layers")))
+	{
+		return;
+	}
+
+	FGridBitMask& LayerMask = TileLayers.FindOrAdd(Layer);
+	if (LayerMask.GetDimensions() != GridDimensions)
+	{
+		LayerMask.Init(GridDimensions, false);
+	}
+
+	if (LayerMask.Get(Coordinate) != bOnLayer)
+	{
+		LayerMask.Set(Coordinate, bOnLayer);
+		MarkPlacementMasksDirty(Coordinate.Column);
+	}
+}
+
+bool AGridSystem::IsOnTileLayer(FName Layer, FGridCoord Coordinate) const
+{
+	const FGridBitMask* LayerMask = TileLayers.Find(Layer);
+	return LayerMask && LayerMask->GetDimensions() == GridDimensions && LayerMask->IsSet(Coordinate);
+}
+
+void AGridSystem::ClearTileLayer(FName Layer) 
+{
+	if (TileLayers.Remove(Layer) > 0)
+	{
+		MarkPlacementMasksDirty(INDEX_NONE);
+	}
+}
+
+bool AGridSystem::IsValidPlacement(TSubclassOf<ABuildingBase> BuildingType, FGridCoord Coordinate) 
+{
+	if (bSparseStorage || !BuildingType)
+	{
+		return CanFitFootprint(Coordinate, BuildingType ? BuildingType.GetDefaultObject()->FootprintSize : 1);
+	}
+
+	return SyncPlacementMask(BuildingType).GetMask().IsSet(Coordinate);
+}
+
+bool AGridSystem::CanPlaceBuilding(TSubclassOf<ABuildingBase> BuildingType, FGridCoord Coordinate) 
+{
+	if (!BuildingType || !IsValidPlacement(BuildingType, Coordinate))
+	{
+		return false;
+	}
+
+	const ABuildingBase* Building = BuildingType.GetDefaultObject();
+	if (!Building->bMustNotSealRegions)
+	{
+		return true;
+	}
+
+	TArray<FGridCoord> Footprint;
+	GridSystem::GetFootprint(Coordinate, FMath::Max(Building->FootprintSize, 1), Footprint);
+	return !WouldSealRegion(Footprint);
+}
+
+bool AGridSystem::PlaceBuilding(TSubclassOf<ABuildingBase> BuildingType, FGridCoord Coordinate, AActor* PlacedActor) 
+{
+	if (!CanPlaceBuilding(BuildingType, Coordinate))
+	{
+		return false;
+	}
+
+	TArray<FGridCoord> Footprint;
+	GridSystem::GetFootprint(Coordinate, FMath::Max(BuildingType.GetDefaultObject()->FootprintSize, 1), Footprint);
+
+	// Journaled so the placement can be undone with UndoTileEdit
+	SetTilesBlocked(Footprint, true, PlacedActor);
+	INC_DWORD_STAT(STAT_RTSGrid_Placements);
+	return true;
+}
+
+TArray<FGridCoord> AGridSystem::GetValidPlacements(TSubclassOf<ABuildingBase> BuildingType) 
+{
+	TArray<FGridCoord> Placements;
+
+	if (const FGridBitMask* Mask = GetPlacementMask(BuildingType))
+	{
+		Placements.Reserve(Mask->CountSetBits());
+		Mask->ForEachSetBit([&Placements](const FGridCoord& Coordinate)
+		{
+			Placements.Add(Coordinate);
+		});
+	}
+
+	return Placements;
+}
+
+void AGridSystem::ShowValidPlacements(TSubclassOf<ABuildingBase> BuildingType) 
+{
+	const FGridBitMask* Mask = GetPlacementMask(BuildingType);
+	if (!Mask || !bShowPreviewGrid || !PreviewGridHISM)
+	{
+		GenerateVisualGrid();
+		return;
+	}
+
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_GenerateVisualGrid);
+
+	PreviewGridHISM->ClearInstances();
+	PreviewGridHISM->bAutoRebuildTreeOnInstanceChanges = false;
+
+	const FVector Scale = FVector(CellSize * 0.01);
+	Mask->ForEachSetBit([this, &Scale](const FGridCoord& Coordinate)
+	{
+		const FVector TileLocation = FVector(Coordinate.Row * CellSize, Coordinate.Column * CellSize, 0);
+		PreviewGridHISM->AddInstance(FTransform(FRotator::ZeroRotator, TileLocation, Scale));
+	});
+
+	PreviewGridHISM->bAutoRebuildTreeOnInstanceChanges = true;
+	PreviewGridHISM->BuildTreeIfOutdated(true, true);
+}
+
+const FGridBitMask* AGridSystem::GetPlacementMask(TSubclassOf<ABuildingBase> BuildingType) 
+{
+	if (bSparseStorage || !BuildingType)
+	{
+		return nullptr;
+	}
+
+	return &SyncPlacementMask(BuildingType).GetMask();
+}
+
+FGridPlacementMask& AGridSystem::SyncPlacementMask(TSubclassOf<ABuildingBase> BuildingType) 
+{
+	const FGridOccupancy& CurrentOccupancy = SyncOccupancy();
+	const ABuildingBase* Building = BuildingType.GetDefaultObject();
+
+	// Rules edited on the class since the last refresh are picked up here
+	FGridPlacementMask& PlacementMask = PlacementMasks.FindOrAdd(TWeakObjectPtr<UClass>(BuildingType.Get()));
+	PlacementMask.SetRules(Building->PlacementRules, Building->FootprintSize);
+	PlacementMask.Refresh({ CurrentOccupancy, TileLayers, CellSlopes });
+
+	return PlacementMask;
+}
+
+void AGridSystem::MarkPlacementMasksDirty(int32 Column) 
+{
+	for (TPair<TWeakObjectPtr<UClass>, FGridPlacementMask>& Pair : PlacementMasks)
+	{
+		if (Column == INDEX_NONE)
+		{
+			Pair.Value.MarkAllDirty();
+		}
+		else
+		{
+			Pair.Value.MarkDirty(Column);
+		}
+	}
+}
+
+bool AGridSystem::StartLockstep(int32 NumPeers, int32 LocalPeer) 
+{
+	if (RejectSparseStorage(TEXT("run lockstep")))
+	{
+		return false;
+	}
+
+	Lockstep.Reset(NumPeers, LocalPeer, LockstepInputDelay);
+	bLockstepRunning = true;
+	bReportedDesync = false;
+	return true;
+}
+
+void AGridSystem::StopLockstep() 
+{
+	bLockstepRunning = false;
+}
+
+bool AGridSystem::IsLockstepRunning() const
+{
+	return bLockstepRunning;
+}
+
+bool AGridSystem::QueueLockstepPlacement(TSubclassOf<ABuildingBase> BuildingType, FGridCoord Coordinate) 
+{
+	const int32 BuildingTypeIndex = LockstepBuildingTypes.IndexOfByKey(BuildingType);
+	if (!bLockstepRunning || BuildingTypeIndex == INDEX_NONE || !CanPlaceBuilding(BuildingType, Coordinate))
+	{
+		return false;
+	}
+
+	Lockstep.QueueLocal(BuildingTypeIndex, GetLayout().ToCellID(Coordinate));
+	return true;
+}
+
+TArray<uint8> AGridSystem::WriteLockstepPacket() 
+{
+	TArray<uint8> Packet;
+	if (bLockstepRunning)
+	{
+		Lockstep.WriteLocalPacket(Packet);
+	}
+	return Packet;
+}
+
+bool AGridSystem::ReceiveLockstepPacket(const TArray<uint8>& Packet) 
+{
+	return bLockstepRunning && Lockstep.ReceivePacket(Packet);
+}
+
+int32 AGridSystem::AdvanceLockstep() 
+{
+	if (!bLockstepRunning)
+	{
+		return 0;
+	}
+
+	// Switched to sparse storage after starting, the occupancy the checksums come from is gone
+	if (RejectSparseStorage(TEXT("run lockstep")))
+	{
+		StopLockstep();
+		return 0;
+	}
+
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_AdvanceLockstep);
+
+	int32 NumTicks = 0;
+	TArray<FGridLockstepCommand> Commands;
+	while (Lockstep.IsTickReady())
+	{
+		const int32 Tick = Lockstep.GetCurrentTick();
+		Lockstep.PopTick(Commands);
+
+		for (const FGridLockstepCommand& Command : Commands)
+		{
+			ApplyLockstepCommand(Command);
+		}
+
+		Lockstep.RecordChecksum(Tick, SyncOccupancy().GetChecksum());
+		NumTicks++;
+	}
+
+	if (Lockstep.HasDesynced() && !bReportedDesync)
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("%s desynced from the other lockstep peers at tick %d"), *GetName(), Lockstep.GetDesyncTick());
+		bReportedDesync = true;
+	}
+
+	return NumTicks;
+}
+
+int32 AGridSystem::GetLockstepTick() const
+{
+	return Lockstep.GetCurrentTick();
+}
+
+bool AGridSystem::HasLockstepDesynced() const
+{
+	return Lockstep.HasDesynced();
+}
+
+int32 AGridSystem::GetOccupancyChecksum() 
+{
+	if (RejectSparseStorage(TEXT("checksum the occupancy")))
+	{
+		return 0;
+	}
+
+	return (int32)SyncOccupancy().GetChecksum();
+}
+
+const FGridLockstep& AGridSystem::GetLockstep() const
+{
+	return Lockstep;
+}
+
+void AGridSystem::ApplyLockstepCommand(const FGridLockstepCommand& Command) 
+{
+	// Commands come from other machines, anything that does not decode to a tile is dropped the same everywhere
+	const FGridLayout& CurrentLayout = SyncOccupancy().GetLayout();
+	if (!LockstepBuildingTypes.IsValidIndex(Command.BuildingType) || Command.CellID >= CurrentLayout.GetNumCellIDs())
+	{
+		return;
+	}
+
+	const TSubclassOf<ABuildingBase> BuildingType = LockstepBuildingTypes[Command.BuildingType];
+	const FGridCoord Coordinate = CurrentLayout.ToCoordinate(Command.CellID);
+	if (!BuildingType || !CurrentLayout.IsInBounds(Coordinate))
+	{
+		return;
+	}
+
+	// Placement rules read tile layers and baked slopes, which each peer keeps for itself, the peer that queued the command checked them.
+	// Clearance and regions only come from the occupancy, the same on every peer
+	const ABuildingBase* Defaults = BuildingType.GetDefaultObject();
+	const int32 FootprintSize = FMath::Max(Defaults->FootprintSize, 1);
+	if (!CanFitFootprint(Coordinate, FootprintSize))
+	{
+		return;
+	}
+
+	TArray<FGridCoord> Footprint;
+	GridSystem::GetFootprint(Coordinate, FootprintSize, Footprint);
+	if (Defaults->bMustNotSealRegions && WouldSealRegion(Footprint))
+	{
+		return;
+	}
+
+	// The actor is only what players see, the grid never reads it back
+	ABuildingBase* Building = nullptr;
+	if (bLockstepSpawnBuildings && GetWorld())
+	{
+		FActorSpawnParameters Params;
+		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		const FVector Location = GetActorLocation() + FVector(Coordinate.Row * CellSize, Coordinate.Column * CellSize, 0.0f);
+		Building = GetWorld()->SpawnActor<ABuildingBase>(BuildingType, Location, FRotator::ZeroRotator, Params);
+	}
+
+	// Not journaled, undoing it on one peer would desync the others
+	for (const FGridCoord& Tile : Footprint)
+	{
+		ApplyTileBlocked(Tile, true);
+	}
+	INC_DWORD_STAT(STAT_RTSGrid_Placements);
+
+	if (Building)
+	{
+		Building->OnPlacementCompleted();
+	}
+}
+
+bool AGridSystem::ReserveCell(FGridCoord Coordinate, int32 Time, int32 Unit) 
+{
+	if (!IsValidLocation(Coordinate))
+	{
+		return false;
+	}
+
+	FGridReservationTable& CurrentReservations = SyncReservations();
+	return CurrentReservations.Reserve(Layout.ToCellID(Coordinate), Time, Unit);
+}
+
+void AGridSystem::ReleaseCell(FGridCoord Coordinate, int32 Time, int32 Unit) 
+{
+	if (IsInGridBounds(Coordinate))
+	{
+		FGridReservationTable& CurrentReservations = SyncReservations();
+		CurrentReservations.Release(Layout.ToCellID(Coordinate), Time, Unit);
+	}
+}
+
+int32 AGridSystem::GetCellReservation(FGridCoord Coordinate, int32 Time) 
+{
+	if (!IsInGridBounds(Coordinate))
+	{
+		return INDEX_NONE;
+	}
+
+	const FGridReservationTable& CurrentReservations = SyncReservations();
+	return CurrentReservations.GetReservation(Layout.ToCellID(Coordinate), Time);
+}
+
+bool AGridSystem::ReservePath(const TArray<FGridCoord>& Path, int32 StartTime, int32 Unit) 
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_ReservePath);
+
+	FGridReservationTable& CurrentReservations = SyncReservations();
+
+	TArray<int32, TInlineAllocator<64>> CellIDs;
+	CellIDs.Reserve(Path.Num());
+
+	for (const FGridCoord& Coordinate : Path)
+	{
+		if (!IsValidLocation(Coordinate))
+		{
+			return false;
+		}
+		CellIDs.Add(Layout.ToCellID(Coordinate));
+	}
+
+	return CurrentReservations.ReservePath(CellIDs, StartTime, Unit);
+}
+
+void AGridSystem::ReleasePath(const TArray<FGridCoord>& Path, int32 StartTime, int32 Unit) 
+{
+	FGridReservationTable& CurrentReservations = SyncReservations();
+
+	for (int32 Index = 0; Index < Path.Num(); Index++)
+	{
+		if (IsInGridBounds(Path[Index]))
+		{
+			CurrentReservations.Release(Layout.ToCellID(Path[Index]), StartTime + Index, Unit);
+		}
+	}
+}
+
+void AGridSystem::AdvanceReservations(int32 Steps) 
+{
+	SyncReservations().Advance(FMath::Max(Steps, 0));
+}
+
+int32 AGridSystem::GetReservationTime() 
+{
+	return SyncReservations().GetCurrentTime();
+}
+
+const FGridReservationTable& AGridSystem::GetReservations() 
+{
+	return SyncReservations();
+}
+
+FGridReservationTable& AGridSystem::SyncReservations() 
+{
+	const FGridLayout& CurrentLayout = GetLayout();
+
+	if (Reservations.GetHorizon() != (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(ReservationHorizon, 1))
+		|| Reservations.GetMaxReservationsPerStep() != FMath::Max(MaxReservationsPerStep, 1)
+		|| ReservationLayout.Dimensions != CurrentLayout.Dimensions || ReservationLayout.Layout != CurrentLayout.Layout)
+	{
+		// Reservations refer to cells by CellID, which a new layout changes
+		Reservations.Reset(ReservationHorizon, MaxReservationsPerStep);
+		ReservationLayout = CurrentLayout;
+	}
+
+	return Reservations;
+}
+
+void AGridSystem::SetInfluenceKernel(FName Layer, int32 Radius, float Decay) 
+{
+	if (FGridInfluenceMap* InfluenceMap = FindOrAddInfluenceMap(Layer))
+	{
+		InfluenceMap->SetKernel(Radius, Decay);
+	}
+}
+
+void AGridSystem::AddInfluenceSource(FName Layer, FGridCoord Coordinate, float Weight) 
+{
+	if (FGridInfluenceMap* InfluenceMap = FindOrAddInfluenceMap(Layer))
+	{
+		InfluenceMap->AddSource(Coordinate, Weight);
+	}
+}
+
+float AGridSystem::GetInfluence(FName Layer, FGridCoord Coordinate) 
+{
+	const FGridInfluenceMap* InfluenceMap = GetInfluenceMap(Layer);
+	return InfluenceMap ? InfluenceMap->GetInfluence(Coordinate) : 0.0f;
+}
+
+const FGridInfluenceMap* AGridSystem::GetInfluenceMap(FName Layer) const
+{
+	const TUniquePtr<FGridInfluenceMap>* InfluenceMap = InfluenceMaps.Find(Layer);
+	return InfluenceMap ? InfluenceMap->Get() : nullptr;
+}
+
+FGridInfluenceMap* AGridSystem::FindOrAddInfluenceMap(FName Layer) 
+{
+	// Influence is stored for every cell, three times over
+	if (RejectSparseStorage(TEXT("compute influence maps")))
+	{
+		return nullptr;
+	}
+
+	TUniquePtr<FGridInfluenceMap>& InfluenceMap = InfluenceMaps.FindOrAdd(Layer);
+	if (!InfluenceMap.IsValid())
+	{
+		InfluenceMap = MakeUnique<FGridInfluenceMap>();
+		InfluenceMap->Reset(GridDimensions);
+	}
+
+	return InfluenceMap.Get();
+}
+
+void AGridSystem::TickInfluenceMaps(float DeltaTime) 
+{
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_TickInfluenceMaps);
+
+	// Layers made before switching to sparse storage would be resized to the whole grid
+	if (bSparseStorage)
+	{
+		InfluenceMaps.Empty();
+		return;
+	}
+
+	for (TPair<FName, TUniquePtr<FGridInfluenceMap>>& InfluenceMap : InfluenceMaps)
+	{
+		if (InfluenceMap.Value->GetDimensions() != GridDimensions)
+		{
+			InfluenceMap.Value->Reset(GridDimensions);
+		}
+
+		InfluenceMap.Value->Tick(DeltaTime, InfluenceMapUpdateInterval);
+	}
+}
+
+int32 AGridSystem::AddFogOfWarUnit(int32 Player, FGridCoord Coordinate, int32 SightRadius) 
+{
+	return FogOfWar.AddUnit(Player, Coordinate, SightRadius);
+}
+
+void AGridSystem::MoveFogOfWarUnit(int32 Unit, FGridCoord Coordinate) 
+{
+	FogOfWar.MoveUnit(Unit, Coordinate);
+}
+
+void AGridSystem::RemoveFogOfWarUnit(int32 Unit) 
+{
+	FogOfWar.RemoveUnit(Unit);
+}
+
+void AGridSystem::UpdateFogOfWar() 
+{
+	// Visibility is stored for every cell, and the sparse tiles cannot be read from worker threads
+	if (RejectSparseStorage(TEXT("update the fog of war")))
+	{
+		return;
+	}
+
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_UpdateFogOfWar);
+
+	const FGridOccupancy& CurrentOccupancy = SyncOccupancy();
+	const FGridLayout& FogLayout = FogOfWar.GetLayout();
+
+	if (bFogOfWarDirty || FogOfWar.GetNumPlayers() != FogOfWarPlayers || FogLayout.Dimensions != Layout.Dimensions || FogLayout.Layout != Layout.Layout)
+	{
+		FogOfWar.Reset(Layout, FogOfWarPlayers);
+		bFogOfWarDirty = false;
+		bFogOfWarCellsDirty = false;
+	}
+
+	if (bFogOfWarCellsDirty)
+	{
+		FogOfWar.InvalidateRect(FogOfWarDirtyMin, FogOfWarDirtyMax);
+		bFogOfWarCellsDirty = false;
+	}
+
+	INC_DWORD_STAT_BY(STAT_RTSGrid_FogOfWarUnitsUpdated, FogOfWar.GetNumDirtyUnits());
+	FogOfWar.Update(bFogOfWarLineOfSight ? &CurrentOccupancy : nullptr);
+}
+
+bool AGridSystem::IsVisibleToPlayer(int32 Player, FGridCoord Coordinate) 
+{
+	return FogOfWar.IsVisible(Player, Coordinate);
 }
 
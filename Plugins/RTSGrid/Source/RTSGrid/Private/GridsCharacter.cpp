@@ -2,6 +2,7 @@
 
 
 #include "GridsCharacter.h"
+#include "RTSGridStats.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/PlayerController.h"
@@ -46,6 +47,8 @@ void AGridsCharacter::BeginPlay()
 // Called every frame
 void AGridsCharacter::Tick(float DeltaTime)
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_CharacterTick);
+
 	Super::Tick(DeltaTime);
 
 	if (!Controller)
@@ -54,7 +57,11 @@ void AGridsCharacter::Tick(float DeltaTime)
 	}
 
 	FHitResult HitResult;
-	bool HasHit = Controller->GetHitResultUnderCursorByChannel(ETraceTypeQuery::TraceTypeQuery1, true, HitResult);
+	bool HasHit;
+	{
+		RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_CursorTrace);
+		HasHit = Controller->GetHitResultUnderCursorByChannel(ETraceTypeQuery::TraceTypeQuery1, true, HitResult);
+	}
 
 	if (!HasHit)
 	{
@@ -74,7 +81,8 @@ void AGridsCharacter::Tick(float DeltaTime)
 	{
 		int32 CellID;
 		FGridCoord Location = TargetGrid->GetCoordinateFromRelative(PlacementLocation, CellID);
-		if (TargetGrid->IsValidLocation(Location))
+		// A bit test in the placement mask of the building type
+		if (TargetGrid->IsValidPlacement(BuildingBase->GetClass(), Location))
 		{
 			FVector CellCenter = TargetGrid->GetCellCenterFromRelative(PlacementLocation, true);
 			BuildingBase->SetActorLocation(CellCenter);
@@ -92,14 +100,32 @@ void AGridsCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComp
 
 void AGridsCharacter::HandlePlacement() 
 {
+	RTSGRID_SCOPE_CYCLE_COUNTER(STAT_RTSGrid_HandlePlacement);
+
 	if (BuildingBase)
 	{
 		if (TargetGrid)
 		{
 			int32 CellID;
 			FGridCoord Location = TargetGrid->GetCoordinateFromRelative(PlacementLocation, CellID);
-			FGridCoord BlockedTile = FGridCoord(Location);
-			TargetGrid->BlockedTiles.Add(BlockedTile);
+
+			// A few bytes to every peer instead of a replicated actor, each peer spawns the building when it applies the command
+			if (TargetGrid->IsLockstepRunning())
+			{
+				if (TargetGrid->QueueLockstepPlacement(BuildingBase->GetClass(), Location))
+				{
+					BuildingBase->Destroy();
+					BuildingBase = nullptr;
+				}
+				return;
+			}
+
+			// The building stays on the cursor so another tile can be picked
+			if (!TargetGrid->PlaceBuilding(BuildingBase->GetClass(), Location, BuildingBase))
+			{
+				return;
+			}
+
 			BuildingBase->OnPlacementCompleted();
 			BuildingBase = nullptr;
 			return;
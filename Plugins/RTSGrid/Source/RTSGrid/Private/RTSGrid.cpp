@@ -1,6 +1,52 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "RTSGrid.h"
+#include "RTSGridStats.h"
+
+DEFINE_LOG_CATEGORY(LogRTSGrid);
+
+DEFINE_STAT(STAT_RTSGrid_GenerateGrid);
+DEFINE_STAT(STAT_RTSGrid_GenerateVisualGrid);
+DEFINE_STAT(STAT_RTSGrid_GridTick);
+DEFINE_STAT(STAT_RTSGrid_BoundsQueries);
+DEFINE_STAT(STAT_RTSGrid_IsValidLocation);
+DEFINE_STAT(STAT_RTSGrid_IsClearTile);
+DEFINE_STAT(STAT_RTSGrid_RelativeConversion);
+DEFINE_STAT(STAT_RTSGrid_CellIDConversion);
+DEFINE_STAT(STAT_RTSGrid_CharacterTick);
+DEFINE_STAT(STAT_RTSGrid_CursorTrace);
+DEFINE_STAT(STAT_RTSGrid_HandlePlacement);
+DEFINE_STAT(STAT_RTSGrid_RebuildOccupancy);
+DEFINE_STAT(STAT_RTSGrid_UpdateFogOfWar);
+DEFINE_STAT(STAT_RTSGrid_LineOfSight);
+DEFINE_STAT(STAT_RTSGrid_OccupancySnapshot);
+DEFINE_STAT(STAT_RTSGrid_TickInfluenceMaps);
+DEFINE_STAT(STAT_RTSGrid_ComputeInfluenceMap);
+DEFINE_STAT(STAT_RTSGrid_Bake);
+DEFINE_STAT(STAT_RTSGrid_ApplyBake);
+DEFINE_STAT(STAT_RTSGrid_ReservePath);
+DEFINE_STAT(STAT_RTSGrid_RebuildRegions);
+DEFINE_STAT(STAT_RTSGrid_UpdateRegions);
+DEFINE_STAT(STAT_RTSGrid_RebuildClearance);
+DEFINE_STAT(STAT_RTSGrid_UpdateClearance);
+DEFINE_STAT(STAT_RTSGrid_RefreshPlacementMask);
+DEFINE_STAT(STAT_RTSGrid_EnforceMemoryBudget);
+DEFINE_STAT(STAT_RTSGrid_AdvanceLockstep);
+DEFINE_STAT(STAT_RTSGrid_NumCells);
+DEFINE_STAT(STAT_RTSGrid_NumBlockedCells);
+DEFINE_STAT(STAT_RTSGrid_NumPreviewInstances);
+DEFINE_STAT(STAT_RTSGrid_NumTextComponents);
+DEFINE_STAT(STAT_RTSGrid_GridMemory);
+DEFINE_STAT(STAT_RTSGrid_VisualGridRebuilds);
+DEFINE_STAT(STAT_RTSGrid_BlockedTileLookups);
+DEFINE_STAT(STAT_RTSGrid_CellIDConversions);
+DEFINE_STAT(STAT_RTSGrid_Placements);
+DEFINE_STAT(STAT_RTSGrid_FogOfWarUnitsUpdated);
+DEFINE_STAT(STAT_RTSGrid_LineOfSightQueries);
+DEFINE_STAT(STAT_RTSGrid_OccupancyChunksCopied);
+DEFINE_STAT(STAT_RTSGrid_OccupancySnapshotCopies);
+DEFINE_STAT(STAT_RTSGrid_RegionCellsVisited);
+DEFINE_STAT(STAT_RTSGrid_ClearanceCellsUpdated);
 
 #define LOCTEXT_NAMESPACE "FRTSGridModule"
 
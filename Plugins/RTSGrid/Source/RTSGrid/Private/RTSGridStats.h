@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Grid stats, shown in game with "stat RTSGrid" and as timing events in Unreal Insights.
+// Everything in this file compiles out in shipping builds.
+DECLARE_STATS_GROUP(TEXT("RTSGrid"), STATGROUP_RTSGrid, STATCAT_Advanced);
+
+// Timers
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateGrid"), STAT_RTSGrid_GenerateGrid, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateVisualGrid"), STAT_RTSGrid_GenerateVisualGrid, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GridSystem Tick"), STAT_RTSGrid_GridTick, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grid Bounds Queries"), STAT_RTSGrid_BoundsQueries, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("IsValidLocation"), STAT_RTSGrid_IsValidLocation, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("IsClearTile"), STAT_RTSGrid_IsClearTile, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Relative Location Conversion"), STAT_RTSGrid_RelativeConversion, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CellID Conversion"), STAT_RTSGrid_CellIDConversion, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GridsCharacter Tick"), STAT_RTSGrid_CharacterTick, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cursor Trace"), STAT_RTSGrid_CursorTrace, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HandlePlacement"), STAT_RTSGrid_HandlePlacement, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rebuild Occupancy"), STAT_RTSGrid_RebuildOccupancy, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Fog Of War"), STAT_RTSGrid_UpdateFogOfWar, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Line Of Sight"), STAT_RTSGrid_LineOfSight, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Occupancy Snapshot"), STAT_RTSGrid_OccupancySnapshot, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick Influence Maps"), STAT_RTSGrid_TickInfluenceMaps, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Compute Influence Map"), STAT_RTSGrid_ComputeInfluenceMap, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bake"), STAT_RTSGrid_Bake, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Bake"), STAT_RTSGrid_ApplyBake, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Reserve Path"), STAT_RTSGrid_ReservePath, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rebuild Regions"), STAT_RTSGrid_RebuildRegions, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Regions"), STAT_RTSGrid_UpdateRegions, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rebuild Clearance"), STAT_RTSGrid_RebuildClearance, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Clearance"), STAT_RTSGrid_UpdateClearance, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Refresh Placement Mask"), STAT_RTSGrid_RefreshPlacementMask, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enforce Memory Budget"), STAT_RTSGrid_EnforceMemoryBudget, STATGROUP_RTSGrid, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Advance Lockstep"), STAT_RTSGrid_AdvanceLockstep, STATGROUP_RTSGrid, );
+
+// Totals across every grid in the world
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Grid Cells"), STAT_RTSGrid_NumCells, STATGROUP_RTSGrid, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Blocked Cells"), STAT_RTSGrid_NumBlockedCells, STATGROUP_RTSGrid, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Preview Instances"), STAT_RTSGrid_NumPreviewInstances, STATGROUP_RTSGrid, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Text Components"), STAT_RTSGrid_NumTextComponents, STATGROUP_RTSGrid, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Grid Memory"), STAT_RTSGrid_GridMemory, STATGROUP_RTSGrid, );
+
+// Per frame counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Visual Grid Rebuilds"), STAT_RTSGrid_VisualGridRebuilds, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Blocked Tile Lookups"), STAT_RTSGrid_BlockedTileLookups, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("CellID Conversions"), STAT_RTSGrid_CellIDConversions, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Placements"), STAT_RTSGrid_Placements, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fog Of War Units Updated"), STAT_RTSGrid_FogOfWarUnitsUpdated, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Line Of Sight Queries"), STAT_RTSGrid_LineOfSightQueries, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Occupancy Chunks Copied"), STAT_RTSGrid_OccupancyChunksCopied, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Occupancy Snapshot Copies"), STAT_RTSGrid_OccupancySnapshotCopies, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Region Cells Visited"), STAT_RTSGrid_RegionCellsVisited, STATGROUP_RTSGrid, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Clearance Cells Updated"), STAT_RTSGrid_ClearanceCellsUpdated, STATGROUP_RTSGrid, );
+
+/**
+ * The CellID conversions are a handful of instructions and are called from
+ * the tightest loops, only time them when building with RTSGRID_VERBOSE_STATS=1,
+ * they are always counted by STAT_RTSGrid_CellIDConversions.
+ */
+#ifndef RTSGRID_VERBOSE_STATS
+#define RTSGRID_VERBOSE_STATS 0
+#endif
+
+#if !UE_BUILD_SHIPPING
+	// Times the enclosing scope in the stat system and in Unreal Insights
+	#define RTSGRID_SCOPE_CYCLE_COUNTER(Stat) \
+		SCOPE_CYCLE_COUNTER(Stat); \
+		TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+#else
+	#define RTSGRID_SCOPE_CYCLE_COUNTER(Stat)
+#endif
+
+#if !UE_BUILD_SHIPPING && RTSGRID_VERBOSE_STATS
+	#define RTSGRID_SCOPE_CYCLE_COUNTER_VERBOSE(Stat) RTSGRID_SCOPE_CYCLE_COUNTER(Stat)
+#else
+	#define RTSGRID_SCOPE_CYCLE_COUNTER_VERBOSE(Stat)
+#endif
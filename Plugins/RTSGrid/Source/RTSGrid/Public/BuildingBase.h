@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "GridPlacementRules.h"
 #include "BuildingBase.generated.h"
 
 UCLASS()
@@ -36,6 +37,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeable")
 	float BuildDurationMultiply;
 
+	// Width in tiles of the square the building covers, placed with its smallest Column and Row corner on the cursor tile
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeable", meta = (ClampMin = "1"))
+	int32 FootprintSize;
+
+	// Refuses tiles where the building would wall some clear tiles off from the rest of the grid
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeable")
+	bool bMustNotSealRegions;
+
+	// Checked on top of a clear footprint, for every tile of the grid at once, see AGridSystem::IsValidPlacement
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeable")
+	TArray<FGridPlacementRule> PlacementRules;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Placeable")
 	class UStaticMeshComponent* StaticMesh;
 
@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Engine/EngineTypes.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "GridCoords.h"
+#include "GridBake.generated.h"
+
+USTRUCT(BlueprintType)
+struct FGridBakeSettings
+{
+	GENERATED_BODY()
+
+	// Channel traced down to find the ground of each cell
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids")
+	TEnumAsByte<ECollisionChannel> GroundChannel = ECC_Visibility;
+
+	// Whether to test each cell for obstacles standing on the ground
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids")
+	bool bTestObstacles = true;
+
+	// Channel of the obstacle test
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids", meta = (EditCondition = "bTestObstacles"))
+	TEnumAsByte<ECollisionChannel> ObstacleChannel = ECC_WorldStatic;
+
+	// Obstacles lower than this over the ground are ignored
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids", meta = (EditCondition = "bTestObstacles", ClampMin = "0.0"))
+	float StepHeight = 30.0f;
+
+	// Height over the ground that has to be free of obstacles
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids", meta = (EditCondition = "bTestObstacles", ClampMin = "1.0"))
+	float ClearanceHeight = 150.0f;
+
+	// Cells with a steeper ground are blocked, in degrees
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids", meta = (ClampMin = "0.0", ClampMax = "90.0"))
+	float MaxSlope = 35.0f;
+
+	// Ground traces run this far above and below the grid
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids", meta = (ClampMin = "1.0"))
+	float TraceHalfHeight = 5000.0f;
+
+	// Whether cells with no ground under them are blocked
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids")
+	bool bBlockWithoutGround = true;
+
+	// Whether to keep the ground height and slope of every cell
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids")
+	bool bBakeHeightAndSlope = false;
+};
+
+// What to bake, everything a bake reads while it runs
+struct FGridBakeRequest
+{
+	UWorld* World = nullptr;
+
+	// World location of the center of the cell (0, 0)
+	FVector Origin = FVector::ZeroVector;
+	float CellSize = 100.0f;
+
+	// Cells to bake, Max included, inside the grid
+	FGridCoord Min;
+	FGridCoord Max;
+
+	FGridBakeSettings Settings;
+
+	// Actors the traces ignore, such as the grid itself
+	TArray<const AActor*> IgnoredActors;
+};
+
+/**
+ * Derives blocked cells, and optionally ground height and slope, from the collision of a world.
+ *
+ * Each cell traces down to its ground and tests for obstacles over it, obstacles that block
+ * the ground channel are seen as ground, so buildings should only block the obstacle channel. The cells are split
+ * by Column across worker threads, so the results only appear once the bake finished. Whoever
+ * owns the bake has to keep the world alive until it finished or was cancelled and waited for.
+ */
+class RTSGRID_API FGridBake
+{
+public:
+
+	~FGridBake();
+
+	/**
+	 * Starts baking on worker threads, cancels and waits for a bake that is still running.
+	 *
+	 * @param InRequest cells to bake and how, Min and Max must be inside the grid
+	 */
+	void Start(const FGridBakeRequest& InRequest);
+
+	// Asks the running bake to stop, it stops after the Columns it is working on
+	void Cancel();
+
+	// Blocks until the running bake finished or stopped
+	void Wait();
+
+	/** @return true while a bake runs */
+	bool IsRunning() const;
+
+	/** @return true once a bake finished or stopped and was not released yet */
+	bool IsFinished() const;
+
+	/** @return true if the finished bake stopped before baking every cell */
+	FORCEINLINE bool WasCancelled() const
+	{
+		return bCancelRequested;
+	}
+
+	/** @return fraction of the Columns baked, between 0 and 1 */
+	float GetProgress() const;
+
+	FORCEINLINE const FGridBakeRequest& GetRequest() const
+	{
+		return Request;
+	}
+
+	/**
+	 * @param Coordinate a cell between Min and Max of the finished bake
+	 * @return true if the cell has no usable ground or an obstacle over it
+	 */
+	FORCEINLINE bool IsBlocked(const FGridCoord& Coordinate) const
+	{
+		return Blocked[ToIndex(Coordinate)] != 0;
+	}
+
+	// Ground height in world space, only baked with bBakeHeightAndSlope
+	FORCEINLINE float GetHeight(const FGridCoord& Coordinate) const
+	{
+		return Heights[ToIndex(Coordinate)];
+	}
+
+	// Ground slope in degrees, only baked with bBakeHeightAndSlope
+	FORCEINLINE float GetSlope(const FGridCoord& Coordinate) const
+	{
+		return Slopes[ToIndex(Coordinate)];
+	}
+
+	// Frees the results of the finished bake
+	void Release();
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	FORCEINLINE int32 ToIndex(const FGridCoord& Coordinate) const
+	{
+		return (Coordinate.Column - Request.Min.Column) * NumRows + (Coordinate.Row - Request.Min.Row);
+	}
+
+	// Bakes every cell of a Column, runs on worker threads
+	void BakeColumn(int32 Column);
+
+	FGridBakeRequest Request;
+	int32 NumColumns = 0;
+	int32 NumRows = 0;
+
+	// One byte per cell so Columns can be written from different threads, Rows are contiguous
+	TArray<uint8> Blocked;
+	TArray<float> Heights;
+	TArray<float> Slopes;
+
+	TFuture<void> Running;
+	FThreadSafeBool bCancelRequested;
+	FThreadSafeCounter NumColumnsDone;
+};
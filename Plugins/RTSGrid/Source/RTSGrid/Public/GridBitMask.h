@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCoords.h"
+
+/**
+ * One bit per tile of a grid, stored Column by Column with 64 Rows per word whatever the cell
+ * layout of the grid, so whole masks are combined, shifted and grown 64 tiles per instruction.
+ * Bits past the last Row of a Column are kept at zero.
+ */
+class RTSGRID_API FGridBitMask
+{
+public:
+
+	/**
+	 * Resizes the mask and sets every bit to a value.
+	 *
+	 * @param InDimensions number of Columns and Rows
+	 * @param bValue value of every bit
+	 */
+	void Init(const FGridCoord& InDimensions, bool bValue);
+
+	FORCEINLINE bool Get(const FGridCoord& Coordinate) const
+	{
+		return (Words[GetWordIndex(Coordinate)] >> (Coordinate.Row & 63)) & 1;
+	}
+
+	/** @return the bit of a coordinate, false outside the mask */
+	FORCEINLINE bool IsSet(const FGridCoord& Coordinate) const
+	{
+		return Coordinate >= FGridCoord(0, 0) && Coordinate < Dimensions && Get(Coordinate);
+	}
+
+	FORCEINLINE void Set(const FGridCoord& Coordinate, bool bValue)
+	{
+		uint64& Word = Words[GetWordIndex(Coordinate)];
+		const uint64 Mask = 1ull << (Coordinate.Row & 63);
+		Word = bValue ? Word | Mask : Word & ~Mask;
+	}
+
+	FORCEINLINE const FGridCoord& GetDimensions() const
+	{
+		return Dimensions;
+	}
+
+	FORCEINLINE int32 GetWordsPerColumn() const
+	{
+		return WordsPerColumn;
+	}
+
+	FORCEINLINE uint64* GetColumn(int32 Column)
+	{
+		return &Words[Column * WordsPerColumn];
+	}
+
+	FORCEINLINE const uint64* GetColumn(int32 Column) const
+	{
+		return &Words[Column * WordsPerColumn];
+	}
+
+	// Bitwise operations with a mask of the same dimensions
+	void And(const FGridBitMask& Other);
+	void Or(const FGridBitMask& Other);
+	void AndNot(const FGridBitMask& Other);
+	void Not();
+
+	/** Sets the bits within Radius tiles of a set bit, in chessboard distance. */
+	void Dilate(int32 Radius);
+
+	/** Keeps the bits where some bit of the Size x Size square towards greater Columns and Rows is set. */
+	void AnyInFootprint(int32 Size);
+
+	/** Keeps the bits where every bit of the Size x Size square towards greater Columns and Rows is set, bits outside the mask count as unset. */
+	void AllInFootprint(int32 Size);
+
+	/**
+	 * Copies whole Columns from a mask with as many Rows.
+	 *
+	 * @param Source the mask to copy from
+	 * @param SourceColumn first Column copied
+	 * @param DestColumn Column of this mask the first one is copied to
+	 * @param NumColumns number of Columns copied
+	 */
+	void CopyColumns(const FGridBitMask& Source, int32 SourceColumn, int32 DestColumn, int32 NumColumns);
+
+	int32 CountSetBits() const;
+
+	/** Calls Func with the coordinate of every set bit, in Column then Row order. */
+	template<typename FuncType>
+	void ForEachSetBit(FuncType&& Func) const
+	{
+		for (int32 Column = 0; Column < Dimensions.Column; Column++)
+		{
+			const uint64* ColumnWords = GetColumn(Column);
+			for (int32 WordIndex = 0; WordIndex < WordsPerColumn; WordIndex++)
+			{
+				for (uint64 Word = ColumnWords[WordIndex]; Word != 0; Word &= Word - 1)
+				{
+					Func(FGridCoord(Column, WordIndex * 64 + (int32)FMath::CountTrailingZeros64(Word)));
+				}
+			}
+		}
+	}
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	FORCEINLINE int32 GetWordIndex(const FGridCoord& Coordinate) const
+	{
+		return Coordinate.Column * WordsPerColumn + (Coordinate.Row >> 6);
+	}
+
+	// Combines every bit with the Size - 1 bits after it, or before it, along Rows then along Columns
+	template<bool bAnd, bool bBackwards>
+	void CombineWindow(int32 Size);
+
+	// Clears the bits past the last Row of every Column
+	void ClearPadding();
+
+	FGridCoord Dimensions = FGridCoord(0);
+	int32 WordsPerColumn = 0;
+	TArray<uint64> Words;
+};
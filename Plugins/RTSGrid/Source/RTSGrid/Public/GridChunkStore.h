@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCoords.h"
+
+class IFileHandle;
+
+/**
+ * Sparse blocked flags for grids too large to store densely.
+ *
+ * Cells are grouped in square chunks that are only allocated once one of their cells is
+ * blocked. At most MaxResidentChunks chunks stay in memory, the least recently used ones
+ * are compressed to a page file and read back when accessed again. Chunks with no blocked
+ * cell are freed, so memory follows the blocked tiles in use rather than the grid size.
+ *
+ * Reads page chunks in, so even const queries are game thread only.
+ */
+class RTSGRID_API FGridChunkStore
+{
+public:
+
+	// log2 of the cells along each side of a chunk
+	static constexpr int32 ChunkBits = 6;
+	static constexpr int32 ChunkSize = 1 << ChunkBits;
+	static constexpr int32 WordsPerChunk = ChunkSize * ChunkSize / 64;
+
+	FGridChunkStore();
+	~FGridChunkStore();
+
+	/**
+	 * Clears every cell and deletes the page file.
+	 *
+	 * @param InPageFilePath file cold chunks are paged to, created on the first eviction
+	 * @param InMaxResidentChunks chunks kept in memory, at least 1
+	 */
+	void Reset(const FString& InPageFilePath, int32 InMaxResidentChunks);
+
+	/**
+	 * @param Coordinate any coordinate, including negative ones
+	 * @return true if the cell is blocked, cells never written to are clear
+	 */
+	bool IsBlocked(const FGridCoord& Coordinate) const;
+
+	/**
+	 * @param Coordinate any coordinate, including negative ones
+	 * @param bBlocked the new flag
+	 * @return true if the flag changed
+	 */
+	bool SetBlocked(const FGridCoord& Coordinate, bool bBlocked);
+
+	FORCEINLINE int32 GetNumBlocked() const
+	{
+		return NumBlocked;
+	}
+
+	/** @return chunks with at least one blocked cell, in memory or paged out */
+	FORCEINLINE int32 GetNumChunks() const
+	{
+		return NumChunks;
+	}
+
+	FORCEINLINE int32 GetNumResidentChunks() const
+	{
+		return ResidentByKey.Num();
+	}
+
+	/** @return number of chunks read back from the page file since the last Reset */
+	FORCEINLINE int32 GetNumPageIns() const
+	{
+		return NumPageIns;
+	}
+
+	/** Evicts chunks until at most InMaxResidentChunks stay in memory. */
+	void SetMaxResidentChunks(int32 InMaxResidentChunks);
+
+	/** @return memory used by resident chunks and the page index, the page file is not counted */
+	SIZE_T GetAllocatedSize() const;
+
+	/** @return size of the page file in bytes */
+	int64 GetPageFileSize() const;
+
+private:
+
+	struct FChunk
+	{
+		uint64 Words[WordsPerChunk];
+		FIntPoint Key;
+		int32 NumBlocked;
+
+		// Changed since it was last written to the page file
+		bool bDirty;
+
+		// Neighbours in the LRU list, indices into Resident
+		int32 Newer;
+		int32 Older;
+	};
+
+	// Where a chunk is stored in the page file
+	struct FPage
+	{
+		int64 Offset;
+		int32 Size;
+		int32 NumBlocked;
+	};
+
+	static FORCEINLINE FIntPoint GetChunkKey(const FGridCoord& Coordinate)
+	{
+		// Arithmetic shifts keep negative coordinates in their own chunks
+		return FIntPoint(Coordinate.Column >> ChunkBits, Coordinate.Row >> ChunkBits);
+	}
+
+	static FORCEINLINE int32 GetCellIndex(const FGridCoord& Coordinate)
+	{
+		return ((Coordinate.Column & (ChunkSize - 1)) << ChunkBits) | (Coordinate.Row & (ChunkSize - 1));
+	}
+
+	/**
+	 * Finds a chunk in memory, paging it in if it was paged out.
+	 *
+	 * @param bCreate whether to allocate the chunk if it does not exist
+	 * @return index into Resident, INDEX_NONE if the chunk does not exist and bCreate is false
+	 */
+	int32 FindChunk(const FIntPoint& Key, bool bCreate);
+
+	// Frees a resident slot, writing its chunk to the page file if needed, false if it could not be written
+	bool Evict(int32 Index);
+
+	// Forgets a chunk that has no blocked cell left
+	void FreeChunk(int32 Index);
+
+	void RemoveResident(int32 Index);
+
+	// Moves a resident chunk to the front of the LRU list
+	void Touch(int32 Index);
+	void Unlink(int32 Index);
+
+	bool WritePage(const FChunk& Chunk);
+	bool ReadPage(const FPage& Page, FChunk& OutChunk);
+
+	// Rewrites the page file without the pages of chunks that were written again or freed
+	void CompactPageFile();
+
+	TSparseArray<FChunk> Resident;
+	TMap<FIntPoint, int32> ResidentByKey;
+	TMap<FIntPoint, FPage> Pages;
+
+	// Most and least recently used resident chunks
+	int32 Newest;
+	int32 Oldest;
+
+	// Last chunk accessed, most accesses hit the same chunk
+	FIntPoint CachedKey;
+	int32 CachedIndex;
+
+	int32 MaxResidentChunks;
+	int32 NumBlocked;
+	int32 NumChunks;
+	int32 NumPageIns;
+
+	FString PageFilePath;
+	TUniquePtr<IFileHandle> PageFile;
+	int64 PageFileSize;
+	int64 LivePageBytes;
+};
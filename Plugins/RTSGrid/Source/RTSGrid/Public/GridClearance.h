@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridLayout.h"
+
+class FGridOccupancy;
+
+/**
+ * Clearance of every cell of a grid, the size of the biggest square of free cells whose
+ * smallest Column and Row corner is the cell, capped at 255. It is the chessboard distance
+ * to the nearest blocked cell or grid edge towards greater Columns and Rows, so a unit
+ * covering N x N cells fits with its corner on a cell if its clearance is at least N.
+ *
+ * Computed in one pass over the grid, each cell from the three cells after it. A changed
+ * cell only affects the cells before it, which are updated until the values stop changing.
+ */
+class RTSGRID_API FGridClearance
+{
+public:
+
+	static constexpr int32 MaxClearance = 255;
+
+	/**
+	 * Computes the clearance of every cell of an occupancy.
+	 *
+	 * @param Occupancy the blocked cells, its layout becomes the layout of the clearance
+	 */
+	void Reset(const FGridOccupancy& Occupancy);
+
+	/**
+	 * Updates the clearance around a cell that was blocked or cleared.
+	 *
+	 * @param Coordinate the cell that changed, inside the grid
+	 * @param bBlocked the new flag of the cell
+	 */
+	void SetBlocked(const FGridCoord& Coordinate, bool bBlocked);
+
+	/** @return the clearance of a cell, 0 if it is blocked */
+	FORCEINLINE uint8 GetClearance(int32 CellID) const
+	{
+		return Values[CellID];
+	}
+
+	/**
+	 * @param CellID the cell under the smallest Column and Row corner of the footprint
+	 * @param Size the width of the square footprint, in cells
+	 * @return true if every cell of the footprint is free and inside the grid
+	 */
+	FORCEINLINE bool Fits(int32 CellID, int32 Size) const
+	{
+		return Values[CellID] >= Size;
+	}
+
+	FORCEINLINE const FGridLayout& GetLayout() const
+	{
+		return Layout;
+	}
+
+	/** @return cells whose clearance changed with the last SetBlocked */
+	FORCEINLINE int32 GetNumCellsUpdated() const
+	{
+		return NumCellsUpdated;
+	}
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	// Clearance of a cell from the cells after it, the grid edge counts as blocked
+	FORCEINLINE uint8 ComputeClearance(int32 Column, int32 Row) const;
+
+	FGridLayout Layout;
+
+	// Clearance of each CellID
+	TArray<uint8> Values;
+
+	int32 NumCellsUpdated = 0;
+};
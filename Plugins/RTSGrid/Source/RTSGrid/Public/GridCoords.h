@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GridCoords.generated.h"
 
+struct FGridLayout;
+
 USTRUCT(BlueprintType)
 struct FGridCoord
 {
@@ -202,6 +204,23 @@ struct FGridCoord
 	 * @return FVector2D with X value as Row and Y as Column values
 	*/
 	FORCEINLINE FVector2D ToVector2D() const;
+
+	/**
+	 * Converts a FGridCoord to a CellID, defined in GridLayout.h
+	 *
+	 * @param Layout the layout of the grid
+	 * @return the CellID of this coordinate in the grid
+	 */
+	FORCEINLINE int32 ToCellID(const FGridLayout& Layout) const;
+
+	/**
+	 * Converts a CellID to a FGridCoord, defined in GridLayout.h
+	 *
+	 * @param ID the CellID to convert
+	 * @param Layout the layout of the grid
+	 * @return the coordinate of the CellID in the grid
+	 */
+	static FORCEINLINE FGridCoord FromCellID(int32 ID, const FGridLayout& Layout);
 };
 
 FORCEINLINE FGridCoord::FGridCoord()
@@ -269,6 +288,11 @@ FORCEINLINE FGridCoord FGridCoord::operator-(const float InF) const
 	return FGridCoord(Column - InF, Row - InF);
 }
 
+FORCEINLINE FGridCoord FGridCoord::operator-(const FVector2D& InV) const
+{
+	return FGridCoord(Column - InV.Y, Row - InV.X);
+}
+
 FORCEINLINE FGridCoord FGridCoord::operator/(float Scale) const
 {
 	return FGridCoord(Column/Scale, Row/Scale);
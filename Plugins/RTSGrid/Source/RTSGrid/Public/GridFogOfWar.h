@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/BitArray.h"
+#include "Containers/SparseArray.h"
+#include "GridCoords.h"
+#include "GridLayout.h"
+
+class FGridOccupancy;
+
+/**
+ * Per player visibility of the cells of a grid.
+ *
+ * Each player has a count of the units seeing every cell and a bit per cell set while
+ * the count is not zero. Update only re-stamps the sight of units that changed cells:
+ * the sight of those units is computed and swapped into the counts in parallel across
+ * units, then the bits of the cells whose count went to or from zero are refreshed.
+ */
+class RTSGRID_API FGridFogOfWar
+{
+public:
+
+	/**
+	 * Sizes the visibility to a grid, every unit is stamped again on the next Update.
+	 *
+	 * @param InLayout the layout of the grid
+	 * @param InNumPlayers number of players with their own visibility
+	 */
+	void Reset(const FGridLayout& InLayout, int32 InNumPlayers);
+
+	/**
+	 * Adds a unit that gives sight to a player.
+	 *
+	 * @param Player index of the player
+	 * @param Coordinate cell of the unit
+	 * @param SightRadius sight radius in cells
+	 * @return handle of the unit
+	 */
+	int32 AddUnit(int32 Player, const FGridCoord& Coordinate, int32 SightRadius);
+
+	/**
+	 * Moves a unit, its sight is only updated if it changed cells.
+	 *
+	 * @param Unit handle returned by AddUnit
+	 * @param Coordinate new cell of the unit
+	 */
+	void MoveUnit(int32 Unit, const FGridCoord& Coordinate);
+
+	/**
+	 * Removes a unit, its sight is removed on the next Update.
+	 *
+	 * @param Unit handle returned by AddUnit
+	 */
+	void RemoveUnit(int32 Unit);
+
+	/**
+	 * Marks the units that can see a cell as dirty, used when the cell blocks or unblocks sight.
+	 *
+	 * @param Coordinate the cell that changed
+	 */
+	void InvalidateCell(const FGridCoord& Coordinate);
+
+	/**
+	 * Marks the units that can see any cell of a rectangle as dirty, one pass over the units
+	 * however many cells of the rectangle changed.
+	 *
+	 * @param Min smallest Column and Row of the cells that changed
+	 * @param Max largest Column and Row of the cells that changed
+	 */
+	void InvalidateRect(const FGridCoord& Min, const FGridCoord& Max);
+
+	/**
+	 * Applies the moves, removals and invalidations since the last update.
+	 *
+	 * @param Occupancy blocked cells stopping sight, or null to ignore line of sight
+	 */
+	void Update(const FGridOccupancy* Occupancy);
+
+	/**
+	 * @param Player index of the player
+	 * @param CellID a valid CellID of the layout
+	 * @return true if any unit of the player sees the cell
+	 */
+	FORCEINLINE bool IsVisible(int32 Player, int32 CellID) const
+	{
+		return Players.IsValidIndex(Player) && Players[Player].Visible[CellID];
+	}
+
+	/**
+	 * @param Player index of the player
+	 * @param Coordinate any coordinate
+	 * @return true if the coordinate is in the grid and any unit of the player sees it
+	 */
+	FORCEINLINE bool IsVisible(int32 Player, const FGridCoord& Coordinate) const
+	{
+		return Layout.IsInBounds(Coordinate) && IsVisible(Player, Layout.ToCellID(Coordinate));
+	}
+
+	/**
+	 * @param Player index of the player
+	 * @return the visibility bits of the player, indexed by CellID
+	 */
+	const TBitArray<>& GetVisibility(int32 Player) const
+	{
+		return Players[Player].Visible;
+	}
+
+	/** @return true if the unit handle is in use */
+	FORCEINLINE bool IsValidUnit(int32 Unit) const
+	{
+		return Units.IsValidIndex(Unit) && !Units[Unit].bRemoved;
+	}
+
+	FORCEINLINE int32 GetNumPlayers() const
+	{
+		return Players.Num();
+	}
+
+	/** @return the layout the visibility was built for */
+	FORCEINLINE const FGridLayout& GetLayout() const
+	{
+		return Layout;
+	}
+
+	/** @return number of units that will be updated by the next Update */
+	FORCEINLINE int32 GetNumDirtyUnits() const
+	{
+		return DirtyUnits.Num();
+	}
+
+	/** @return the memory used by the visibility and the units */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	struct FUnit
+	{
+		int32 Player;
+		FGridCoord Coordinate;
+		int32 SightRadius;
+
+		// CellIDs currently stamped in the player visibility
+		TArray<int32> VisibleCells;
+
+		// CellIDs computed by the last Update, swapped with VisibleCells once applied
+		TArray<int32> PendingCells;
+
+		// CellIDs whose count this unit took to or from zero during the last Update
+		TArray<int32> FlippedCells;
+
+		bool bDirty;
+		bool bRemoved;
+	};
+
+	struct FPlayer
+	{
+		// Number of units of the player seeing each CellID, changed atomically by the units
+		TArray<int32> Counts;
+		TBitArray<> Visible;
+	};
+
+	// Computes the cells seen by a unit into its PendingCells
+	void ComputeSight(FUnit& Unit, const FGridOccupancy* Occupancy) const;
+
+	void MarkDirty(int32 Unit);
+
+	FGridLayout Layout;
+	TSparseArray<FUnit> Units;
+	TArray<FPlayer> Players;
+	TArray<int32> DirtyUnits;
+};
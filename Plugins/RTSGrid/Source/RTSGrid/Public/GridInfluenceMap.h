@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "GridCoords.h"
+
+/**
+ * Influence (threat, control...) of weighted sources spread over a grid, for AI decisions.
+ *
+ * Sources are stamped, then spread with a separable kernel where influence decays by
+ * Decay for every cell of Manhattan distance, up to Radius cells in each axis. The spread
+ * runs on a worker task, vectorized along Rows and parallel across Columns, into a back
+ * buffer. Readers only see the front buffer, the result of the last completed update.
+ */
+class RTSGRID_API FGridInfluenceMap
+{
+public:
+
+	FGridInfluenceMap();
+	~FGridInfluenceMap();
+
+	/**
+	 * Sizes the map to a grid, clears both buffers and the pending sources.
+	 *
+	 * @param InDimensions number of Columns and Rows of the grid
+	 */
+	void Reset(const FGridCoord& InDimensions);
+
+	/**
+	 * Sets how far sources spread, used from the next scheduled update.
+	 *
+	 * @param InRadius cells of spread in each axis
+	 * @param InDecay factor applied for every cell of distance, between 0 and 1
+	 */
+	void SetKernel(int32 InRadius, float InDecay);
+
+	/**
+	 * Adds a source to the next scheduled update.
+	 *
+	 * @param Coordinate cell of the source, ignored if outside the grid
+	 * @param Weight influence at the source cell
+	 */
+	void AddSource(const FGridCoord& Coordinate, float Weight);
+
+	/**
+	 * Starts an update with the sources added since the last one, unless one is running.
+	 *
+	 * @return true if an update was started
+	 */
+	bool ScheduleUpdate();
+
+	/**
+	 * Makes the last completed update readable, call once per frame.
+	 *
+	 * @param DeltaTime time since the last call
+	 * @param UpdateInterval seconds between scheduled updates, 0 schedules one every call
+	 */
+	void Tick(float DeltaTime, float UpdateInterval);
+
+	/** Blocks until the running update finishes and makes it readable. */
+	void Flush();
+
+	/**
+	 * @param Coordinate any coordinate
+	 * @return influence of the last completed update, 0 outside the grid
+	 */
+	FORCEINLINE float GetInfluence(const FGridCoord& Coordinate) const
+	{
+		return Coordinate >= FGridCoord(0, 0) && Coordinate < Dimensions ? Front[Coordinate.Column * Dimensions.Row + Coordinate.Row] : 0.0f;
+	}
+
+	/** @return influence of every cell of the last completed update, Rows are contiguous */
+	FORCEINLINE const TArray<float>& GetValues() const
+	{
+		return Front;
+	}
+
+	FORCEINLINE const FGridCoord& GetDimensions() const
+	{
+		return Dimensions;
+	}
+
+	/** @return true while an update runs */
+	bool IsUpdating() const;
+
+	/** @return memory used by the buffers and pending sources */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	struct FSource
+	{
+		int32 Index;
+		float Weight;
+	};
+
+	// Makes the finished update readable, if any
+	void TryFlip();
+
+	// Stamps Sources into Back and spreads them, runs on the worker task
+	void Compute(const TArray<FSource>& Sources, int32 KernelRadius, const TArray<float>& Kernel);
+
+	FGridCoord Dimensions;
+	int32 Radius;
+	float Decay;
+
+	// Readable result, and buffers only used by the worker task
+	TArray<float> Front;
+	TArray<float> Back;
+	TArray<float> Scratch;
+
+	TArray<FSource> PendingSources;
+	TFuture<void> Running;
+	float TimeSinceUpdate;
+};
@@ -0,0 +1,317 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCoords.h"
+#include "GridLayout.generated.h"
+
+UENUM(BlueprintType)
+enum class EGridCellLayout : uint8
+{
+	// CellID = Column * GridDimensions.Row + Row, IDs are dense
+	RowMajor,
+
+	// Rows padded to a power of two so CellIDs are built with shifts and masks,
+	// IDs past the last Row of each Column are never used
+	PowerOfTwo,
+
+	// 16 x 16 tiles of cells in Z-order, so cells close on the grid are close in memory.
+	// Neighbour offsets are not constant, IDs past the last tile of each Column are never used
+	Morton,
+};
+
+/**
+ * Maps grid coordinates to CellIDs and back for a grid of a given size.
+ * Every structure indexed by CellID should be sized with GetNumCellIDs().
+ */
+struct FGridLayout
+{
+	// Number of Columns and Rows of the grid
+	FGridCoord Dimensions;
+
+	// How CellIDs are laid out
+	EGridCellLayout Layout;
+
+	// CellID distance between two consecutive Columns, or Columns of tiles with the Morton layout
+	int32 ColumnStride;
+
+	// log2 of ColumnStride and ColumnStride - 1 with the PowerOfTwo layout,
+	// of the number of tiles per Column of tiles with the Morton layout
+	uint32 RowBits;
+	int32 RowMask;
+
+	// log2 of the Columns and Rows of a Morton tile
+	static constexpr uint32 MortonTileBits = 4;
+	static constexpr int32 MortonTileSize = 1 << MortonTileBits;
+	static constexpr int32 MortonTileMask = MortonTileSize - 1;
+
+	// Default Constructor, an empty grid.
+	FORCEINLINE FGridLayout();
+
+	/**
+	 * Constructor from the grid size
+	 *
+	 * @param InDimensions number of Columns and Rows of the grid
+	 * @param InLayout how CellIDs are laid out
+	 */
+	FORCEINLINE FGridLayout(FGridCoord InDimensions, EGridCellLayout InLayout);
+
+	/**
+	 * Converts a coordinate to a CellID, the coordinate is not bounds checked.
+	 *
+	 * @param Coordinate the coordinate to convert
+	 * @return the CellID of the coordinate
+	 */
+	FORCEINLINE int32 ToCellID(const FGridCoord& Coordinate) const;
+
+	/**
+	 * Converts a CellID to a coordinate.
+	 *
+	 * @param ID the CellID to convert
+	 * @return the coordinate of the CellID
+	 */
+	FORCEINLINE FGridCoord ToCoordinate(int32 ID) const;
+
+	/**
+	 * CellID difference between a cell and its neighbour, the same for every cell of the grid.
+	 * Only valid when HasConstantNeighborOffsets(), use GetNeighborCellID otherwise.
+	 *
+	 * @param DeltaColumn Columns between the cell and its neighbour
+	 * @param DeltaRow Rows between the cell and its neighbour
+	 * @return the value to add to a CellID to get the CellID of the neighbour
+	 */
+	FORCEINLINE int32 GetNeighborOffset(int32 DeltaColumn, int32 DeltaRow) const;
+
+	/**
+	 * CellID of a neighbour of a cell, the neighbour is not bounds checked.
+	 *
+	 * @param ID CellID of the cell
+	 * @param DeltaColumn Columns between the cell and its neighbour
+	 * @param DeltaRow Rows between the cell and its neighbour
+	 * @return the CellID of the neighbour
+	 */
+	FORCEINLINE int32 GetNeighborCellID(int32 ID, int32 DeltaColumn, int32 DeltaRow) const;
+
+	/** @return true if GetNeighborOffset can be used with this layout */
+	FORCEINLINE bool HasConstantNeighborOffsets() const;
+
+	/**
+	 * Checks a coordinate against the grid dimensions.
+	 *
+	 * @param Coordinate the coordinate to check
+	 * @return true if the coordinate is inside the grid
+	 */
+	FORCEINLINE bool IsInBounds(const FGridCoord& Coordinate) const;
+
+	/** @return number of cells of the grid */
+	FORCEINLINE int32 GetNumCells() const;
+
+	/** @return one past the biggest CellID of the grid, the size of arrays indexed by CellID */
+	FORCEINLINE int32 GetNumCellIDs() const;
+
+	/**
+	 * Interleaves the bits of the local coordinates of a cell in its Morton tile,
+	 * Row bits go to the even bits and Column bits to the odd ones.
+	 *
+	 * @param LocalColumn Column inside the tile
+	 * @param LocalRow Row inside the tile
+	 * @return the Z-order index of the cell in its tile
+	 */
+	static FORCEINLINE uint32 MortonEncode(uint32 LocalColumn, uint32 LocalRow);
+
+	/**
+	 * Inverse of MortonEncode.
+	 *
+	 * @param Code the Z-order index of a cell in its tile
+	 * @return the local coordinate of the cell in its tile
+	 */
+	static FORCEINLINE FGridCoord MortonDecode(uint32 Code);
+
+private:
+
+	// Spreads the low 4 bits of V to the even bits of the result
+	static FORCEINLINE uint32 SpreadBits(uint32 V);
+
+	// Inverse of SpreadBits
+	static FORCEINLINE uint32 CompactBits(uint32 V);
+};
+
+FORCEINLINE FGridLayout::FGridLayout()
+	: FGridLayout(FGridCoord(0), EGridCellLayout::RowMajor)
+{}
+
+FORCEINLINE FGridLayout::FGridLayout(FGridCoord InDimensions, EGridCellLayout InLayout)
+	: Dimensions(FMath::Max(InDimensions.Column, 0), FMath::Max(InDimensions.Row, 0))
+	, Layout(InLayout)
+	, ColumnStride(Dimensions.Row)
+	, RowBits(0)
+	, RowMask(0)
+{
+	if (Layout == EGridCellLayout::PowerOfTwo)
+	{
+		ColumnStride = (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(Dimensions.Row, 1));
+		RowBits = FMath::FloorLog2(ColumnStride);
+		RowMask = ColumnStride - 1;
+	}
+	else if (Layout == EGridCellLayout::Morton)
+	{
+		const int32 NumTileRows = (int32)FMath::RoundUpToPowerOfTwo(FMath::Max(FMath::DivideAndRoundUp(Dimensions.Row, MortonTileSize), 1));
+		RowBits = FMath::FloorLog2(NumTileRows);
+		RowMask = NumTileRows - 1;
+		ColumnStride = NumTileRows << (2 * MortonTileBits);
+	}
+}
+
+FORCEINLINE int32 FGridLayout::ToCellID(const FGridCoord& Coordinate) const
+{
+	if (Layout == EGridCellLayout::PowerOfTwo)
+	{
+		return (Coordinate.Column << RowBits) | Coordinate.Row;
+	}
+
+	if (Layout == EGridCellLayout::Morton)
+	{
+		const int32 Tile = ((Coordinate.Column >> MortonTileBits) << RowBits) | (Coordinate.Row >> MortonTileBits);
+		return (Tile << (2 * MortonTileBits)) | MortonEncode(Coordinate.Column & MortonTileMask, Coordinate.Row & MortonTileMask);
+	}
+
+	return (ColumnStride * Coordinate.Column) + Coordinate.Row;
+}
+
+FORCEINLINE FGridCoord FGridLayout::ToCoordinate(int32 ID) const
+{
+	if (Layout == EGridCellLayout::PowerOfTwo)
+	{
+		return FGridCoord(ID >> RowBits, ID & RowMask);
+	}
+
+	if (Layout == EGridCellLayout::Morton)
+	{
+		const int32 Tile = ID >> (2 * MortonTileBits);
+		const FGridCoord Local = MortonDecode(ID & ((1 << (2 * MortonTileBits)) - 1));
+		return FGridCoord(((Tile >> RowBits) << MortonTileBits) | Local.Column, ((Tile & RowMask) << MortonTileBits) | Local.Row);
+	}
+
+	return ColumnStride > 0 ? FGridCoord(ID / ColumnStride, ID % ColumnStride) : FGridCoord(0);
+}
+
+FORCEINLINE int32 FGridLayout::GetNeighborOffset(int32 DeltaColumn, int32 DeltaRow) const
+{
+	return (DeltaColumn * ColumnStride) + DeltaRow;
+}
+
+FORCEINLINE int32 FGridLayout::GetNeighborCellID(int32 ID, int32 DeltaColumn, int32 DeltaRow) const
+{
+	if (Layout == EGridCellLayout::Morton)
+	{
+		const FGridCoord Coordinate = ToCoordinate(ID);
+		return ToCellID(FGridCoord(Coordinate.Column + DeltaColumn, Coordinate.Row + DeltaRow));
+	}
+
+	return ID + GetNeighborOffset(DeltaColumn, DeltaRow);
+}
+
+FORCEINLINE bool FGridLayout::HasConstantNeighborOffsets() const
+{
+	return Layout != EGridCellLayout::Morton;
+}
+
+FORCEINLINE bool FGridLayout::IsInBounds(const FGridCoord& Coordinate) const
+{
+	return Coordinate >= FGridCoord(0, 0) && Coordinate < Dimensions;
+}
+
+FORCEINLINE int32 FGridLayout::GetNumCells() const
+{
+	return Dimensions.Column * Dimensions.Row;
+}
+
+FORCEINLINE int32 FGridLayout::GetNumCellIDs() const
+{
+	if (Layout == EGridCellLayout::Morton)
+	{
+		return FMath::DivideAndRoundUp(Dimensions.Column, MortonTileSize) * ColumnStride;
+	}
+
+	return Dimensions.Column * ColumnStride;
+}
+
+FORCEINLINE uint32 FGridLayout::SpreadBits(uint32 V)
+{
+	V = (V | (V << 2)) & 0x33;
+	V = (V | (V << 1)) & 0x55;
+	return V;
+}
+
+FORCEINLINE uint32 FGridLayout::CompactBits(uint32 V)
+{
+	V &= 0x55;
+	V = (V | (V >> 1)) & 0x33;
+	V = (V | (V >> 2)) & 0x0F;
+	return V;
+}
+
+FORCEINLINE uint32 FGridLayout::MortonEncode(uint32 LocalColumn, uint32 LocalRow)
+{
+	return SpreadBits(LocalRow) | (SpreadBits(LocalColumn) << 1);
+}
+
+FORCEINLINE FGridCoord FGridLayout::MortonDecode(uint32 Code)
+{
+	return FGridCoord(CompactBits(Code >> 1), CompactBits(Code));
+}
+
+FORCEINLINE int32 FGridCoord::ToCellID(const FGridLayout& Layout) const
+{
+	return Layout.ToCellID(*this);
+}
+
+FORCEINLINE FGridCoord FGridCoord::FromCellID(int32 ID, const FGridLayout& Layout)
+{
+	return Layout.ToCoordinate(ID);
+}
+
+/**
+ * Grid layout with its size fixed at compile time, every conversion is a shift or a mask.
+ * Use it for storage that is always the same size, such as chunks of a bigger grid.
+ *
+ * @param RowBitsValue log2 of the number of Rows
+ * @param ColumnBitsValue log2 of the number of Columns
+ */
+template<uint32 RowBitsValue, uint32 ColumnBitsValue>
+struct TStaticGridLayout
+{
+	static constexpr uint32 RowBits = RowBitsValue;
+	static constexpr uint32 ColumnBits = ColumnBitsValue;
+	static constexpr int32 NumRows = 1 << RowBits;
+	static constexpr int32 NumColumns = 1 << ColumnBits;
+	static constexpr int32 NumCells = NumRows * NumColumns;
+	static constexpr int32 RowMask = NumRows - 1;
+
+	static FORCEINLINE constexpr int32 ToCellID(int32 Column, int32 Row)
+	{
+		return (Column << RowBits) | Row;
+	}
+
+	static FORCEINLINE int32 ToCellID(const FGridCoord& Coordinate)
+	{
+		return ToCellID(Coordinate.Column, Coordinate.Row);
+	}
+
+	static FORCEINLINE FGridCoord ToCoordinate(int32 ID)
+	{
+		return FGridCoord(ID >> RowBits, ID & RowMask);
+	}
+
+	static FORCEINLINE constexpr int32 GetNeighborOffset(int32 DeltaColumn, int32 DeltaRow)
+	{
+		return DeltaColumn * NumRows + DeltaRow;
+	}
+
+	static FORCEINLINE bool IsInBounds(const FGridCoord& Coordinate)
+	{
+		// Negative values wrap to huge unsigned values and fail the test too
+		return (uint32)Coordinate.Column < (uint32)NumColumns && (uint32)Coordinate.Row < (uint32)NumRows;
+	}
+};
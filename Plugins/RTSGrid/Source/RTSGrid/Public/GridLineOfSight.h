@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCoords.h"
+#include "GridLineOfSight.generated.h"
+
+class FGridOccupancy;
+class FGridChunkStore;
+struct FGridLayout;
+
+USTRUCT(BlueprintType)
+struct FGridLineQuery
+{
+	GENERATED_BODY()
+
+	// Cell the line starts from
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids")
+	FGridCoord From;
+
+	// Cell the line ends on
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Grids")
+	FGridCoord To;
+
+	FGridLineQuery() {}
+
+	FGridLineQuery(const FGridCoord& InFrom, const FGridCoord& InTo)
+		: From(InFrom)
+		, To(InTo)
+	{}
+};
+
+/**
+ * Grid line walking and line of sight queries against an occupancy.
+ *
+ * The queries only read the occupancy, so they can run on any thread as long as
+ * nothing writes to it meanwhile, such as a snapshot from AGridSystem::GetOccupancySnapshot.
+ */
+struct RTSGRID_API FGridLineOfSight
+{
+	/**
+	 * Walks the cells of the Bresenham line from From to To, both included.
+	 *
+	 * @param From first cell of the line
+	 * @param To last cell of the line
+	 * @param Visitor called with each FGridCoord of the line in order, returns false to stop the walk
+	 * @return true if the walk reached To
+	 */
+	template<typename VisitorType>
+	static FORCEINLINE bool ForEachCellOnLine(const FGridCoord& From, const FGridCoord& To, VisitorType&& Visitor)
+	{
+		const int32 DeltaColumn = FMath::Abs(To.Column - From.Column);
+		const int32 DeltaRow = -FMath::Abs(To.Row - From.Row);
+		const int32 StepColumn = From.Column < To.Column ? 1 : -1;
+		const int32 StepRow = From.Row < To.Row ? 1 : -1;
+
+		FGridCoord Current = From;
+		int32 Error = DeltaColumn + DeltaRow;
+
+		while (true)
+		{
+			if (!Visitor(Current))
+			{
+				return false;
+			}
+
+			if (Current == To)
+			{
+				return true;
+			}
+
+			const int32 DoubleError = 2 * Error;
+			if (DoubleError >= DeltaRow)
+			{
+				Error += DeltaRow;
+				Current.Column += StepColumn;
+			}
+			if (DoubleError <= DeltaColumn)
+			{
+				Error += DeltaColumn;
+				Current.Row += StepRow;
+			}
+		}
+	}
+
+	/**
+	 * Checks that no blocked cell lies on the line between two cells. The end cells are
+	 * not checked, so a tower on a blocked tile can see out of it. Lines leaving the grid
+	 * are blocked. The line from A to B can differ from the line from B to A by a cell.
+	 *
+	 * @param Occupancy the blocked cells
+	 * @param From first cell of the line
+	 * @param To last cell of the line
+	 * @return true if the line is clear
+	 */
+	static bool HasLineOfSight(const FGridOccupancy& Occupancy, const FGridCoord& From, const FGridCoord& To);
+
+	/**
+	 * HasLineOfSight against sparse storage, game thread only as it may page chunks in.
+	 *
+	 * @param Tiles the blocked cells
+	 * @param Layout the layout of the grid, for its bounds
+	 * @param From first cell of the line
+	 * @param To last cell of the line
+	 * @return true if the line is clear
+	 */
+	static bool HasLineOfSight(const FGridChunkStore& Tiles, const FGridLayout& Layout, const FGridCoord& From, const FGridCoord& To);
+
+	/**
+	 * Runs many HasLineOfSight queries in parallel.
+	 *
+	 * @param Occupancy the blocked cells, must not be written to until the call returns
+	 * @param Queries the lines to check
+	 * @param OutResults one result per query, written at the same index
+	 */
+	static void HasLineOfSightBatch(const FGridOccupancy& Occupancy, TArrayView<const FGridLineQuery> Queries, TArrayView<bool> OutResults);
+};
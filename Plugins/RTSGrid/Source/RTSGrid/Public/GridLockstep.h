@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A placement one peer asked for, applied at the same tick on every peer. */
+struct FGridLockstepCommand
+{
+	int32 Peer = 0;
+
+	// Index in the building types every peer registered in the same order
+	int32 BuildingType = 0;
+
+	int32 CellID = 0;
+};
+
+/**
+ * Command stream of a lockstep simulation: instead of replicating what placements did, every
+ * peer sends the commands it issued and applies everybody's commands in the same order at the
+ * same tick, so every grid goes through the same states.
+ *
+ * Local commands are delayed InputDelay ticks to leave time for the packet to arrive. Each peer
+ * sends a packet for every tick, empty or not, and a tick is applied once every peer's packet for
+ * it is in. Packets are variable length integers, a placement is a couple of bytes on top of a few
+ * bytes per tick, and carry a checksum of the sender's last applied tick to detect desyncs.
+ *
+ * A peer never sends past its current tick plus InputDelay, and cannot apply a tick before this
+ * peer's packet for it is in, so no packet is more than 2 * InputDelay + 1 ticks past the current
+ * tick. Packets beyond that are refused, which bounds the ticks waiting for their packets.
+ */
+class RTSGRID_API FGridLockstep
+{
+public:
+
+	// Ticks whose checksums are kept to compare with the other peers
+	static constexpr int32 ChecksumHistory = 256;
+
+	// Peers are tracked with the bits of a uint32
+	static constexpr int32 MaxPeers = 32;
+
+	FGridLockstep();
+
+	/**
+	 * Drops every command and starts again from tick 0.
+	 *
+	 * @param InNumPeers number of peers, including this one
+	 * @param InLocalPeer index of this peer, in [0, InNumPeers)
+	 * @param InInputDelay ticks between issuing a command and applying it
+	 */
+	void Reset(int32 InNumPeers, int32 InLocalPeer, int32 InInputDelay);
+
+	/** Queues a command of this peer for the tick of the next packet. */
+	void QueueLocal(int32 BuildingType, int32 CellID);
+
+	/**
+	 * Closes the next tick of this peer without a packet and writes its packet, to send to every other peer.
+	 * Up to the current tick plus InputDelay, while waiting for other peers the commands stay queued.
+	 *
+	 * @param OutPacket the packet, replaced, empty if none was written
+	 * @return false if this peer already sent its packet for the current tick plus InputDelay
+	 */
+	bool WriteLocalPacket(TArray<uint8>& OutPacket);
+
+	/**
+	 * Adds the commands of another peer's packet.
+	 *
+	 * @param Packet a packet written by WriteLocalPacket on another peer
+	 * @return false if the packet is malformed, late, too far ahead, or a duplicate, nothing is added then
+	 */
+	bool ReceivePacket(TArrayView<const uint8> Packet);
+
+	/** @return true if every peer's commands for the current tick are in */
+	bool IsTickReady() const;
+
+	/**
+	 * Takes the commands of the current tick, ordered by peer then issue order, and moves to the next tick.
+	 *
+	 * @param OutCommands the commands to apply, replaced
+	 * @return false if the tick is not ready, nothing changes then
+	 */
+	bool PopTick(TArray<FGridLockstepCommand>& OutCommands);
+
+	/**
+	 * Records the checksum of the grid after applying a tick, sent with the next packet.
+	 *
+	 * @param Tick the tick PopTick returned the commands of
+	 * @param Checksum the checksum of the grid
+	 */
+	void RecordChecksum(int32 Tick, uint32 Checksum);
+
+	/** @return the next tick to apply */
+	FORCEINLINE int32 GetCurrentTick() const
+	{
+		return CurrentTick;
+	}
+
+	/** @return true once a peer reported another checksum for a tick */
+	FORCEINLINE bool HasDesynced() const
+	{
+		return DesyncTick != INDEX_NONE;
+	}
+
+	/** @return the first tick the peers disagreed on, INDEX_NONE if none */
+	FORCEINLINE int32 GetDesyncTick() const
+	{
+		return DesyncTick;
+	}
+
+	FORCEINLINE int32 GetNumPeers() const
+	{
+		return NumPeers;
+	}
+
+	FORCEINLINE int32 GetLocalPeer() const
+	{
+		return LocalPeer;
+	}
+
+private:
+
+	struct FTickInputs
+	{
+		TArray<FGridLockstepCommand> Commands;
+		uint32 ReceivedPeers = 0;
+	};
+
+	// Adds the commands of a peer for a tick
+	void AddInputs(int32 Peer, int32 Tick, TArrayView<const FGridLockstepCommand> Commands);
+
+	// Compares a checksum with the first one known for the tick
+	void CompareChecksum(int32 Tick, uint32 Checksum);
+
+	int32 NumPeers = 1;
+	int32 LocalPeer = 0;
+	int32 InputDelay = 0;
+
+	int32 CurrentTick = 0;
+	int32 NextLocalTick = 0;
+
+	TArray<FGridLockstepCommand> LocalCommands;
+	TMap<int32, FTickInputs> PendingInputs;
+
+	// First checksum known for each of the last ticks, indexed by tick modulo ChecksumHistory
+	int32 ChecksumTicks[ChecksumHistory];
+	uint32 Checksums[ChecksumHistory];
+
+	int32 LastRecordedTick = INDEX_NONE;
+	uint32 LastRecordedChecksum = 0;
+	int32 DesyncTick = INDEX_NONE;
+};
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCoords.h"
+#include "GridLayout.h"
+
+/**
+ * Dense blocked flags of a grid, one bit per CellID.
+ * Mirrors AGridSystem::BlockedTiles for code that reads many cells, such as
+ * visibility and path queries, where hashing every coordinate is too slow.
+ *
+ * The bits are stored in reference counted chunks shared by copies, a chunk is only
+ * copied the first time it is written to while shared. Copying the occupancy is
+ * therefore cheap, and copies are immutable snapshots safe to read from any thread.
+ */
+class RTSGRID_API FGridOccupancy
+{
+public:
+
+	// log2 of the cells in a chunk
+	static constexpr int32 ChunkBits = 12;
+	static constexpr int32 CellsPerChunk = 1 << ChunkBits;
+	static constexpr int32 WordsPerChunk = CellsPerChunk / 64;
+
+	struct FChunk
+	{
+		uint64 Words[WordsPerChunk];
+	};
+
+	/**
+	 * Resizes the occupancy to a grid and clears every cell.
+	 *
+	 * @param InLayout the layout of the grid
+	 */
+	void Reset(const FGridLayout& InLayout);
+
+	/**
+	 * Fills the occupancy from a set of blocked coordinates, coordinates outside the grid are ignored.
+	 *
+	 * @param InLayout the layout of the grid
+	 * @param BlockedTiles the blocked coordinates
+	 */
+	void Reset(const FGridLayout& InLayout, const TSet<FGridCoord>& BlockedTiles);
+
+	/**
+	 * Sets the blocked flag of a cell, copying its chunk if it is shared.
+	 *
+	 * @param CellID the cell to change, must be a valid CellID of the layout
+	 * @param bBlocked the new flag
+	 * @return true if the flag changed
+	 */
+	FORCEINLINE bool SetBlocked(int32 CellID, bool bBlocked)
+	{
+		const int32 ChunkIndex = CellID >> ChunkBits;
+		const int32 WordIndex = (CellID >> 6) & (WordsPerChunk - 1);
+		const uint64 Mask = 1ull << (CellID & 63);
+
+		if (((Chunks[ChunkIndex]->Words[WordIndex] & Mask) != 0) == bBlocked)
+		{
+			return false;
+		}
+
+		uint64& Word = MakeChunkUnique(ChunkIndex).Words[WordIndex];
+		Word = bBlocked ? (Word | Mask) : (Word & ~Mask);
+		NumBlocked += bBlocked ? 1 : -1;
+		Checksum ^= HashCellID(CellID);
+		return true;
+	}
+
+	/**
+	 * @param CellID a valid CellID of the layout
+	 * @return true if the cell is blocked
+	 */
+	FORCEINLINE bool IsBlocked(int32 CellID) const
+	{
+		return (Chunks[CellID >> ChunkBits]->Words[(CellID >> 6) & (WordsPerChunk - 1)] >> (CellID & 63)) & 1;
+	}
+
+	/**
+	 * @param Coordinate any coordinate
+	 * @return true if the coordinate is outside the grid or blocked
+	 */
+	FORCEINLINE bool IsBlocked(const FGridCoord& Coordinate) const
+	{
+		return !Layout.IsInBounds(Coordinate) || IsBlocked(Layout.ToCellID(Coordinate));
+	}
+
+	/** @return the layout the occupancy was built for */
+	FORCEINLINE const FGridLayout& GetLayout() const
+	{
+		return Layout;
+	}
+
+	/** @return the number of blocked cells */
+	FORCEINLINE int32 GetNumBlocked() const
+	{
+		return NumBlocked;
+	}
+
+	/** @return a hash of which cells are blocked, equal on every machine with the same blocked CellIDs */
+	FORCEINLINE uint32 GetChecksum() const
+	{
+		return Checksum;
+	}
+
+	FORCEINLINE int32 GetNumChunks() const
+	{
+		return Chunks.Num();
+	}
+
+	/**
+	 * @param Other another occupancy of the same grid
+	 * @param ChunkIndex index of the chunk to compare
+	 * @return true if both occupancies share the memory of the chunk
+	 */
+	FORCEINLINE bool SharesChunk(const FGridOccupancy& Other, int32 ChunkIndex) const
+	{
+		return Chunks[ChunkIndex] == Other.Chunks[ChunkIndex];
+	}
+
+	/**
+	 * Points chunks to the chunks of another occupancy of the same layout, and takes its counts.
+	 * Equal to a copy of Source if the chunks not listed are already shared with it.
+	 *
+	 * @param Source occupancy with the same number of chunks
+	 * @param ChunkIndices chunks that differ from Source
+	 */
+	void CopyChunks(const FGridOccupancy& Source, TArrayView<const int32> ChunkIndices);
+
+	/** @return the memory used by the chunks this occupancy wrote to, and the chunk table */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	using FChunkPtr = TSharedPtr<FChunk, ESPMode::ThreadSafe>;
+
+	// Chunk every cleared cell points to, never written to
+	static const FChunkPtr& GetEmptyChunk();
+
+	// Copies a chunk shared with another occupancy before it is written to
+	FChunk& MakeChunkUnique(int32 ChunkIndex);
+
+	// Integer mix of a CellID, the checksum is the XOR of the hashes of the blocked cells so each change updates it
+	static FORCEINLINE uint32 HashCellID(int32 CellID)
+	{
+		uint32 Hash = (uint32)CellID + 0x9E3779B9u;
+		Hash = (Hash ^ (Hash >> 16)) * 0x85EBCA6Bu;
+		Hash = (Hash ^ (Hash >> 13)) * 0xC2B2AE35u;
+		return Hash ^ (Hash >> 16);
+	}
+
+	FGridLayout Layout;
+	TArray<FChunkPtr> Chunks;
+	int32 NumBlocked = 0;
+	uint32 Checksum = 0;
+};
+
+// Read only occupancy shared with worker threads
+using FGridOccupancySnapshotRef = TSharedRef<const FGridOccupancy, ESPMode::ThreadSafe>;
+
+/**
+ * Publishes read only copies of an occupancy at a cost that follows the chunks written, not the grid size.
+ *
+ * Readers only ever get the last published snapshot. The one before it is kept, and once no reader
+ * holds it anymore it is brought up to date by pointing the chunks written since it was published
+ * to the chunks of the occupancy, then published again. The table of chunks is only copied when a
+ * reader still holds it, or after Reset.
+ */
+class RTSGRID_API FGridOccupancyPublisher
+{
+public:
+
+	/** Forgets the chunks written, call when the occupancy is rebuilt so the next Publish copies it whole. */
+	void Reset();
+
+	/**
+	 * Records a write to the occupancy since the last Publish.
+	 *
+	 * @param CellID the cell that changed
+	 */
+	FORCEINLINE void MarkChanged(int32 CellID)
+	{
+		const int32 ChunkIndex = CellID >> FGridOccupancy::ChunkBits;
+		if (!ChunkChanged.IsValidIndex(ChunkIndex))
+		{
+			bInSync = false;
+		}
+		else if (!ChunkChanged[ChunkIndex])
+		{
+			ChunkChanged[ChunkIndex] = true;
+			ChangedChunks.Add(ChunkIndex);
+		}
+	}
+
+	/**
+	 * Publishes the occupancy as it is now.
+	 *
+	 * @param Occupancy the occupancy every write to was recorded with MarkChanged since the last Publish
+	 * @return the new snapshot
+	 */
+	FGridOccupancySnapshotRef Publish(const FGridOccupancy& Occupancy);
+
+	/** @return the last published snapshot, null until the first Publish */
+	FORCEINLINE TSharedPtr<const FGridOccupancy, ESPMode::ThreadSafe> GetPublished() const
+	{
+		return Published;
+	}
+
+	/** @return the memory used to track the chunks written, the snapshots share their chunks with the occupancy */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	TSharedPtr<FGridOccupancy, ESPMode::ThreadSafe> Published;
+
+	// Snapshot published before Published, behind it by RecycledChangedChunks
+	TSharedPtr<FGridOccupancy, ESPMode::ThreadSafe> Recycled;
+	TArray<int32> RecycledChangedChunks;
+
+	// Chunks written since Published
+	TArray<int32> ChangedChunks;
+	TBitArray<> ChunkChanged;
+
+	// False when Published is not behind the occupancy by exactly ChangedChunks
+	bool bInSync = false;
+};
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+// Consecutive CellIDs that had the same blocked flag before an edit
+struct FGridJournalRun
+{
+	int32 FirstCellID;
+	int32 NumCells;
+	bool bWasBlocked;
+};
+
+// One undoable edit, the runs of the cells it changed
+struct FGridJournalOp
+{
+	int32 FirstRun;
+	int32 NumRuns;
+
+	// Actor placed by the edit, hidden while the edit is undone, handed back to be destroyed once an undone edit is discarded
+	TWeakObjectPtr<AActor> Actor;
+};
+
+/**
+ * Undo history of blocked tile edits.
+ * Only the cells an edit changed are recorded, as runs of CellIDs, so undoing
+ * or redoing an edit costs as much as the edit itself whatever the grid size.
+ * The journal does not apply anything, Undo and Redo return the edit to replay.
+ */
+class RTSGRID_API FGridPlacementJournal
+{
+public:
+
+	/**
+	 * Forgets every edit.
+	 *
+	 * @param OutDiscardedActors appended with the actors of the undone edits, hidden and now never shown again
+	 */
+	void Reset(TArray<TWeakObjectPtr<AActor>>& OutDiscardedActors);
+
+	/**
+	 * Starts recording an edit, the edits that could be redone are discarded when it ends, unless it changed nothing.
+	 *
+	 * @param Actor actor placed by the edit, if any
+	 */
+	void BeginOp(AActor* Actor = nullptr);
+
+	/**
+	 * Records a cell changed by the current edit, cells changed in CellID order are merged into runs.
+	 *
+	 * @param CellID the changed cell
+	 * @param bWasBlocked the flag of the cell before the edit
+	 */
+	void Record(int32 CellID, bool bWasBlocked);
+
+	/**
+	 * Finishes the current edit, dropped if it changed nothing, the oldest edits are dropped past MaxOps.
+	 *
+	 * @param OutDiscardedActors appended with the actors of the undone edits it replaced, hidden and now never shown again
+	 */
+	void EndOp(TArray<TWeakObjectPtr<AActor>>& OutDiscardedActors);
+
+	/**
+	 * Steps back one edit, its runs have to be set back to bWasBlocked by the caller.
+	 *
+	 * @return the edit to revert, null if there is nothing to undo
+	 */
+	const FGridJournalOp* Undo();
+
+	/**
+	 * Steps forward one edit, its runs have to be set to !bWasBlocked by the caller.
+	 *
+	 * @return the edit to apply again, null if there is nothing to redo
+	 */
+	const FGridJournalOp* Redo();
+
+	FORCEINLINE TArrayView<const FGridJournalRun> GetRuns(const FGridJournalOp& Op) const
+	{
+		return TArrayView<const FGridJournalRun>(Runs.GetData() + Op.FirstRun, Op.NumRuns);
+	}
+
+	FORCEINLINE bool CanUndo() const
+	{
+		return NumApplied > 0;
+	}
+
+	FORCEINLINE bool CanRedo() const
+	{
+		return NumApplied < Ops.Num();
+	}
+
+	FORCEINLINE int32 GetNumOps() const
+	{
+		return Ops.Num();
+	}
+
+	// Maximum number of edits kept, at least 1
+	void SetMaxOps(int32 InMaxOps);
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	// Adds the actors of the edits after NumApplied
+	void CollectUndoneActors(TArray<TWeakObjectPtr<AActor>>& OutActors) const;
+
+	TArray<FGridJournalOp> Ops;
+	TArray<FGridJournalRun> Runs;
+
+	// Edits before this index are applied, the ones after it can be redone
+	int32 NumApplied = 0;
+
+	int32 MaxOps = 128;
+	bool bRecording = false;
+};
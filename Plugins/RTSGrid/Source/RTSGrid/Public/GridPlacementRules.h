@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridBitMask.h"
+#include "GridPlacementRules.generated.h"
+
+class FGridOccupancy;
+
+UENUM(BlueprintType)
+enum class EGridPlacementRule : uint8
+{
+	// Some tile of the footprint is at most Distance tiles from a tile of Layer, like a road
+	NearLayer,
+
+	// No tile of the footprint is at most Distance tiles from a tile of Layer, like enemy buildings
+	AwayFromLayer,
+
+	// Every tile of the footprint is on Layer
+	OnLayer,
+
+	// Every tile of the footprint has a baked slope of at most MaxSlope degrees
+	MaxSlope,
+};
+
+USTRUCT(BlueprintType)
+struct FGridPlacementRule
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	EGridPlacementRule Type = EGridPlacementRule::NearLayer;
+
+	// Tile layer the rule reads, set with AGridSystem::SetTileLayer, a missing layer has no tiles
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	FName Layer;
+
+	// Chessboard distance in tiles for NearLayer and AwayFromLayer, 0 only counts the footprint tiles
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "0"))
+	int32 Distance = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "0"))
+	float MaxSlope = 10.0f;
+
+	FORCEINLINE bool operator==(const FGridPlacementRule& Other) const
+	{
+		return Type == Other.Type && Layer == Other.Layer && Distance == Other.Distance && MaxSlope == Other.MaxSlope;
+	}
+
+	FORCEINLINE bool operator!=(const FGridPlacementRule& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+FORCEINLINE uint32 GetTypeHash(const FGridPlacementRule& Rule)
+{
+	uint32 Hash = HashCombine(GetTypeHash((uint8)Rule.Type), GetTypeHash(Rule.Layer));
+	Hash = HashCombine(Hash, GetTypeHash(Rule.Distance));
+	return HashCombine(Hash, GetTypeHash(Rule.MaxSlope));
+}
+
+/**
+ * Tiles of a grid a building type can be placed on, with its smallest Column and Row corner
+ * on the tile: every tile of the footprint is clear and every rule holds. Each rule is a
+ * handful of whole mask operations, footprints and distances are grown with shifts, so
+ * checking a tile afterwards is a single bit test.
+ *
+ * A changed tile only affects the Columns within the reach of the rules, the mask keeps the
+ * Columns that changed since it was refreshed and only evaluates those again.
+ */
+class RTSGRID_API FGridPlacementMask
+{
+public:
+
+	/** Everything the rules read, CellSlopes and the layers may be empty. */
+	struct FInputs
+	{
+		const FGridOccupancy& Occupancy;
+		const TMap<FName, FGridBitMask>& Layers;
+		const TArray<float>& CellSlopes;
+	};
+
+	/**
+	 * Sets the rules of the building type, the whole mask is evaluated again if they changed.
+	 *
+	 * @param InRules rules on top of the clear footprint
+	 * @param InFootprintSize width of the square footprint, in tiles
+	 */
+	void SetRules(TArrayView<const FGridPlacementRule> InRules, int32 InFootprintSize);
+
+	/** Notes a changed tile, or layer tile, of a Column. */
+	void MarkDirty(int32 Column);
+
+	void MarkAllDirty();
+
+	FORCEINLINE bool IsDirty() const
+	{
+		return bAllDirty || DirtyBegin < DirtyEnd;
+	}
+
+	/**
+	 * Evaluates the Columns affected by the changes since the last refresh.
+	 *
+	 * @param Inputs the grid, the whole mask is evaluated again if its dimensions changed
+	 * @return the up to date mask
+	 */
+	const FGridBitMask& Refresh(const FInputs& Inputs);
+
+	FORCEINLINE const FGridBitMask& GetMask() const
+	{
+		return Mask;
+	}
+
+	/** @return how many Columns before or after a changed tile the rules can affect */
+	int32 GetReach() const;
+
+	/** @return Columns evaluated by the last refresh that had anything to do */
+	FORCEINLINE int32 GetNumColumnsEvaluated() const
+	{
+		return NumColumnsEvaluated;
+	}
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	// Evaluates Columns [ColumnBegin, ColumnEnd) into the mask from a window of Columns wide enough for the rules
+	void Evaluate(const FInputs& Inputs, int32 ColumnBegin, int32 ColumnEnd);
+
+	// Copy of the rules the mask was evaluated for, compared rule by rule with the rules set
+	TArray<FGridPlacementRule> Rules;
+	int32 FootprintSize = 1;
+
+	FGridBitMask Mask;
+
+	// Columns with changed tiles since the last refresh
+	bool bAllDirty = true;
+	int32 DirtyBegin = 0;
+	int32 DirtyEnd = 0;
+
+	int32 NumColumnsEvaluated = 0;
+};
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridLayout.h"
+
+class FGridOccupancy;
+
+/**
+ * Connected regions of the free cells of a grid, 4-connected, one label per CellID.
+ * Two cells are reachable from each other if they have the same label, which is
+ * checked with two array reads before spending time on a path query.
+ *
+ * Labels are updated in place when a single cell changes. Clearing a cell merges the
+ * regions around it by relabeling the smaller ones. Blocking a cell only searches when
+ * the cells around it are not linked through its 8 neighbours, and then searches from
+ * each side at the same pace so the cost follows the smaller part cut off.
+ */
+class RTSGRID_API FGridRegions
+{
+public:
+
+	/**
+	 * Labels every free cell of an occupancy.
+	 *
+	 * @param Occupancy the blocked cells, its layout becomes the layout of the regions
+	 */
+	void Reset(const FGridOccupancy& Occupancy);
+
+	/**
+	 * Updates the labels after a cell was blocked or cleared.
+	 *
+	 * @param CellID the cell that changed
+	 * @param bBlocked the new flag of the cell
+	 */
+	void SetBlocked(int32 CellID, bool bBlocked);
+
+	/**
+	 * Checks whether blocking cells would cut a region in two or more parts, the labels are left as they are.
+	 *
+	 * @param CellIDs the cells to block together
+	 * @return true if some free cells would no longer reach each other
+	 */
+	bool WouldSplit(TArrayView<const int32> CellIDs);
+
+	/** @return the region of a cell, INDEX_NONE if it is blocked */
+	FORCEINLINE int32 GetRegion(int32 CellID) const
+	{
+		return Labels[CellID];
+	}
+
+	/** @return true if both cells are free and in the same region */
+	FORCEINLINE bool AreConnected(int32 CellA, int32 CellB) const
+	{
+		const int32 Region = Labels[CellA];
+		return Region != INDEX_NONE && Region == Labels[CellB];
+	}
+
+	/** @return number of cells of a region */
+	FORCEINLINE int32 GetRegionSize(int32 Region) const
+	{
+		return RegionSizes.IsValidIndex(Region) ? RegionSizes[Region] : 0;
+	}
+
+	FORCEINLINE int32 GetNumRegions() const
+	{
+		return NumRegions;
+	}
+
+	FORCEINLINE const FGridLayout& GetLayout() const
+	{
+		return Layout;
+	}
+
+	/** @return cells visited or relabeled by the last SetBlocked or WouldSplit */
+	FORCEINLINE int32 GetNumCellsVisited() const
+	{
+		return NumCellsVisited;
+	}
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	// Label of the free cells Reset has not reached yet
+	static constexpr int32 Unlabeled = -2;
+
+	// Writes the in bounds 4-neighbours of a cell, returns how many there are
+	int32 GetNeighbours(int32 CellID, int32 (&OutNeighbours)[4]) const;
+
+	FORCEINLINE bool IsFree(int32 CellID) const
+	{
+		return Labels[CellID] != INDEX_NONE;
+	}
+
+	// True if the free 4-neighbours of a cell are linked through its free 8-neighbours
+	bool AreNeighboursLinked(int32 CellID) const;
+
+	// Relabels the cells labeled From connected to Seed, returns how many there were
+	int32 FloodFill(int32 Seed, int32 From, int32 To);
+
+	/**
+	 * Searches from every seed at the same pace until all but one of the parts they
+	 * reach are closed off, every seed must be free and in the same region.
+	 *
+	 * @param bRelabel gives every part closed off a region of its own
+	 * @return true if the seeds reach more than one part
+	 */
+	bool SearchSplit(TArrayView<const int32> Seeds, bool bRelabel);
+
+	int32 AllocateRegion();
+	void FreeRegion(int32 Region);
+
+	FGridLayout Layout;
+
+	// Region of each CellID, INDEX_NONE for blocked cells
+	TArray<int32> Labels;
+
+	// Cells of each region, 0 for the labels in FreeRegionLabels
+	TArray<int32> RegionSizes;
+	TArray<int32> FreeRegionLabels;
+	int32 NumRegions = 0;
+
+	// Search that visited each cell, valid where VisitEpochs matches Epoch
+	TArray<uint32> VisitEpochs;
+	TArray<uint16> VisitOwners;
+	uint32 Epoch = 0;
+
+	// Cells visited by each search, kept to reuse the allocations
+	TArray<TArray<int32>> Queues;
+
+	int32 NumCellsVisited = 0;
+};
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Cells reserved by units at future time steps, for cooperative pathfinding.
+ *
+ * A ring of Horizon time steps, each an open addressing hash table of CellID to unit
+ * with a fixed capacity. Entries are stamped with their time step, so advancing the
+ * current time frees a whole step without touching it, and lookups, reservations and
+ * releases are O(1). Memory only depends on the horizon and the capacity per step.
+ */
+class RTSGRID_API FGridReservationTable
+{
+public:
+
+	/**
+	 * Clears every reservation and sizes the table, the current time goes back to 0.
+	 *
+	 * @param InHorizon time steps that can be reserved ahead, rounded up to a power of two
+	 * @param MaxReservationsPerStep reservations each time step can hold
+	 */
+	void Reset(int32 InHorizon, int32 MaxReservationsPerStep);
+
+	/**
+	 * Moves the current time forward, the reservations of the steps left behind are dropped.
+	 *
+	 * @param Steps time steps to advance
+	 */
+	FORCEINLINE void Advance(int32 Steps = 1)
+	{
+		CurrentTime += Steps;
+	}
+
+	FORCEINLINE int32 GetCurrentTime() const
+	{
+		return CurrentTime;
+	}
+
+	FORCEINLINE int32 GetHorizon() const
+	{
+		return Horizon;
+	}
+
+	FORCEINLINE int32 GetMaxReservationsPerStep() const
+	{
+		return MaxReservations;
+	}
+
+	/** @return true if Time is between the current time and the horizon */
+	FORCEINLINE bool IsInHorizon(int32 Time) const
+	{
+		return Time >= CurrentTime && Time - CurrentTime < Horizon;
+	}
+
+	/**
+	 * @param CellID the cell
+	 * @param Time the time step
+	 * @return the unit that reserved the cell at that time, INDEX_NONE if none did
+	 */
+	int32 GetReservation(int32 CellID, int32 Time) const;
+
+	/**
+	 * Reserves a cell for a unit at a time step.
+	 *
+	 * @return true if the cell is now reserved by the unit, false if another unit has it,
+	 * Time is outside the horizon or the time step is full
+	 */
+	bool Reserve(int32 CellID, int32 Time, int32 Unit);
+
+	/** Releases a reservation, only if Unit holds it. */
+	void Release(int32 CellID, int32 Time, int32 Unit);
+
+	/**
+	 * Checks a move between two cells, from Time to Time + 1, against the reservations of other units.
+	 * The move conflicts if another unit holds ToCellID at Time + 1, or moves the opposite way at the same time.
+	 *
+	 * @param FromCellID cell the unit is on at Time
+	 * @param ToCellID cell the unit is on at Time + 1, the same cell to wait
+	 * @param Time time step the move starts at
+	 * @param Unit the moving unit, its own reservations never conflict
+	 * @return true if the move is free
+	 */
+	bool IsMoveFree(int32 FromCellID, int32 ToCellID, int32 Time, int32 Unit) const;
+
+	/**
+	 * Reserves the cells of a path, one per time step, if every move of it is free.
+	 *
+	 * @param CellIDs the path, CellIDs[0] is reserved at StartTime
+	 * @param StartTime time step of the first cell
+	 * @param Unit the unit following the path
+	 * @return true if the whole path was reserved, nothing is reserved otherwise
+	 */
+	bool ReservePath(TArrayView<const int32> CellIDs, int32 StartTime, int32 Unit);
+
+	/** Releases the reservations of a path made with ReservePath. */
+	void ReleasePath(TArrayView<const int32> CellIDs, int32 StartTime, int32 Unit);
+
+	/** @return number of reservations held at a time step */
+	int32 GetNumReservations(int32 Time) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	struct FEntry
+	{
+		int32 CellID;
+
+		// INDEX_NONE for a released entry, which lookups probe past
+		int32 Unit;
+
+		// Entries stamped with another time step are empty
+		int32 Time;
+	};
+
+	struct FStep
+	{
+		int32 Time;
+		int32 NumUsed;
+	};
+
+	FORCEINLINE uint32 Hash(int32 CellID) const
+	{
+		return ((uint32)CellID * 0x9E3779B1u) >> HashShift;
+	}
+
+	FORCEINLINE FEntry* GetStepEntries(int32 Time)
+	{
+		return &Entries[(Time & (Horizon - 1)) * Capacity];
+	}
+
+	FORCEINLINE const FEntry* GetStepEntries(int32 Time) const
+	{
+		return &Entries[(Time & (Horizon - 1)) * Capacity];
+	}
+
+	// Index of the live entry of a cell in its time step, INDEX_NONE if there is none
+	int32 FindEntry(int32 CellID, int32 Time) const;
+
+	TArray<FEntry> Entries;
+	TArray<FStep> Steps;
+
+	int32 CurrentTime = 0;
+	int32 Horizon = 0;
+
+	// Entries per time step, a power of two
+	int32 Capacity = 0;
+	int32 MaxUsed = 0;
+	int32 MaxReservations = 0;
+	uint32 HashShift = 32;
+};
@@ -5,6 +5,19 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "GridCoords.h"
+#include "GridLayout.h"
+#include "GridOccupancy.h"
+#include "GridFogOfWar.h"
+#include "GridLineOfSight.h"
+#include "GridInfluenceMap.h"
+#include "GridPlacementJournal.h"
+#include "GridBake.h"
+#include "GridChunkStore.h"
+#include "GridReservationTable.h"
+#include "GridRegions.h"
+#include "GridClearance.h"
+#include "GridPlacementRules.h"
+#include "GridLockstep.h"
 #include "GridSystem.generated.h"
 
 UCLASS(HideCategories = (Physics, LOD, Replication, Cooking, Activation), CollapseCategories = (Actor, Input, AssetUserData, Collision, Tags), AutoExpandCategories = (Grids), ClassGroup = "GridSystem")
@@ -28,12 +41,32 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
 	float CellSize;
 
+	// How CellIDs are laid out, PowerOfTwo trades unused IDs for cheaper conversions,
+	// Morton keeps cells that are close on the grid close in memory
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	EGridCellLayout CellLayout;
+
+	// Change with SetTileBlocked, or call MarkOccupancyDirty after editing it directly
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
 	TSet<FGridCoord> BlockedTiles;
 
+	// Every coordinate of the grid, indexed by CellID with the RowMajor layout
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grids")
 	TArray<FGridCoord> GeneratedGrid;
 
+	// Open World
+
+	// Stores blocked tiles in chunks allocated only where tiles are blocked, paging the least recently
+	// used ones to disk, for grids too large to store densely. BlockedTiles is only read by GenerateGrid,
+	// GeneratedGrid and the preview grid are not generated. Features that need every cell in memory, such as
+	// the fog of war, regions, lockstep and the dense occupancy, log a warning and return what their comment says
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	bool bSparseStorage;
+
+	// Chunks of 64x64 tiles kept in memory with bSparseStorage
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "1", EditCondition = "bSparseStorage"))
+	int32 SparseResidentChunks;
+
 	// Dev Options
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
@@ -45,6 +78,63 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
 	bool bDrawBoundingBox;
 
+	// Fog Of War
+
+	// Number of players with their own visibility, 0 disables the fog of war
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	int32 FogOfWarPlayers;
+
+	// Whether blocked tiles hide the cells behind them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	bool bFogOfWarLineOfSight;
+
+	// Number of tile edits that can be undone
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "1"))
+	int32 TileEditHistory;
+
+	// Bake
+
+	// How BakeBlockedTiles derives blocked tiles from the collision of the level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	FGridBakeSettings BakeSettings;
+
+	// Reservations
+
+	// Time steps ahead units can reserve cells for, rounded up to a power of two
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "1"))
+	int32 ReservationHorizon;
+
+	// Cells that can be reserved at each time step, across every unit
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "1"))
+	int32 MaxReservationsPerStep;
+
+	// Influence Maps
+
+	// Seconds between influence map updates, 0 updates them every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "0.0"))
+	float InfluenceMapUpdateInterval;
+
+	// Lockstep
+
+	// Building types lockstep commands refer to by index, the same list in the same order on every peer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	TArray<TSubclassOf<class ABuildingBase>> LockstepBuildingTypes;
+
+	// Ticks between queuing a placement and every peer applying it, covers the time packets take to arrive
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "0"))
+	int32 LockstepInputDelay;
+
+	// Spawns the building actors of applied lockstep placements, off for simulations without visuals
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids")
+	bool bLockstepSpawnBuildings;
+
+	// Memory
+
+	// Megabytes this grid may use, 0 for no budget. Over budget the tile labels are dropped first, then the
+	// preview grid gets coarser, then caches rebuilt on demand are released, until a new budget is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grids", meta = (ClampMin = "0.0"))
+	float MemoryBudgetMB;
+
 	// Core Functions
 
 	UFUNCTION(BlueprintCallable, Category = "Grids")
@@ -86,12 +176,337 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Grids")
 	int32 GetCellIDFromCoordinate(FGridCoord Coordinate);
 
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void SetTileBlocked(FGridCoord Coordinate, bool bBlocked);
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void MarkOccupancyDirty();
+
+	// Tile Edit Functions
+
+	// Blocks or clears tiles as one undoable edit, tiles outside the grid are ignored,
+	// PlacedActor is hidden while the edit is undone
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void SetTilesBlocked(const TArray<FGridCoord>& Coordinates, bool bBlocked, AActor* PlacedActor = nullptr);
+
+	// Blocks or clears every tile between Min and Max, included, as one undoable edit
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void SetRectBlocked(FGridCoord Min, FGridCoord Max, bool bBlocked);
+
+	// Reverts the last tile edit, costs as much as the edit whatever the grid size. Does nothing while lockstep runs, lockstep placements are not journaled
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Grids")
+	void UndoTileEdit();
+
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Grids")
+	void RedoTileEdit();
+
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool CanUndoTileEdit() const;
+
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool CanRedoTileEdit() const;
+
+	// Bake Functions
+
+	// Starts baking every tile from the level collision on worker threads, applied as one undoable tile edit once done
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Grids")
+	void BakeBlockedTiles();
+
+	// Starts baking the tiles between Min and Max, included, cancels a running bake. With bSparseStorage the
+	// rectangle may hold at most SparseResidentChunks chunks of tiles, and heights and slopes are not baked
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void BakeBlockedTilesInRect(FGridCoord Min, FGridCoord Max);
+
+	// Bakes the tiles under WorldBounds again once no bake runs, call after changing the terrain or level geometry
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void MarkBakeDirty(FBox WorldBounds);
+
+	// Stops the running bake, the tiles it baked so far are thrown away
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Grids")
+	void CancelBake();
+
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool IsBaking() const;
+
+	// Fraction of the running bake done, between 0 and 1
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	float GetBakeProgress() const;
+
+	// Baked ground height in world space, the grid height if none was baked
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	float GetCellHeight(FGridCoord Coordinate);
+
+	// Baked ground slope in degrees, 0 if none was baked
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	float GetCellSlope(FGridCoord Coordinate);
+
+	// Waits for the running bake and applies it, for code that needs the result right away
+	void FinishBake();
+
+	// Fog Of War Functions
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	int32 AddFogOfWarUnit(int32 Player, FGridCoord Coordinate, int32 SightRadius);
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void MoveFogOfWarUnit(int32 Unit, FGridCoord Coordinate);
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void RemoveFogOfWarUnit(int32 Unit);
+
+	// Applies the unit changes to the visibility, called every Tick while FogOfWarPlayers > 0.
+	// Does nothing with bSparseStorage, where no cell is ever visible
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void UpdateFogOfWar();
+
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool IsVisibleToPlayer(int32 Player, FGridCoord Coordinate);
+
+	// Line Of Sight Functions
+
+	// True if no blocked tile lies between From and To, see FGridLineOfSight::HasLineOfSight
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool HasLineOfSight(FGridCoord From, FGridCoord To);
+
+	// HasLineOfSight for every query, run in parallel
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	TArray<bool> HasLineOfSightBatch(const TArray<FGridLineQuery>& Queries);
+
+	// Region Functions
+
+	// True if both tiles are clear and a path between them exists, two array reads once the regions are up to date.
+	// Always false with bSparseStorage, where regions are not labeled
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool AreCellsConnected(FGridCoord From, FGridCoord To);
+
+	// Connected region of clear tiles holding a tile, -1 for blocked tiles and with bSparseStorage
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int32 GetCellRegion(FGridCoord Coordinate);
+
+	// True if blocking the tiles would cut some clear tiles off from others, always false with bSparseStorage
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	bool WouldSealRegion(const TArray<FGridCoord>& Coordinates);
+
+	// Regions of the clear tiles, updated with every tile change
+	const FGridRegions& GetRegions();
+
+	// Clearance Functions
+
+	// Width of the biggest square of clear tiles with its smallest Column and Row corner on a tile, 0 if it is blocked
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int32 GetCellClearance(FGridCoord Coordinate);
+
+	// True if a Size x Size footprint with its smallest Column and Row corner on Coordinate only covers clear tiles
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool CanFitFootprint(FGridCoord Coordinate, int32 Size);
+
+	// Clearance of every tile, updated with every tile change, not maintained with bSparseStorage
+	const FGridClearance& GetClearance();
+
+	// Placement Functions
+
+	// True if IsValidPlacement accepts the tile and, for buildings with bMustNotSealRegions, no clear tiles get walled off
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool CanPlaceBuilding(TSubclassOf<class ABuildingBase> BuildingType, FGridCoord Coordinate);
+
+	// Blocks the footprint of the building type if CanPlaceBuilding, journaled with the placed actor
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	bool PlaceBuilding(TSubclassOf<class ABuildingBase> BuildingType, FGridCoord Coordinate, AActor* PlacedActor = nullptr);
+
+	// Puts a tile on, or takes it off, a named layer the placement rules of buildings read, ignored with bSparseStorage
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void SetTileLayer(FName Layer, FGridCoord Coordinate, bool bOnLayer);
+
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool IsOnTileLayer(FName Layer, FGridCoord Coordinate) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void ClearTileLayer(FName Layer);
+
+	// True if the footprint of the building type fits with its corner on the tile and every placement rule holds, a single bit test once the mask of the type is up to date
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool IsValidPlacement(TSubclassOf<class ABuildingBase> BuildingType, FGridCoord Coordinate);
+
+	// Every tile IsValidPlacement accepts for the building type, empty with bSparseStorage
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	TArray<FGridCoord> GetValidPlacements(TSubclassOf<class ABuildingBase> BuildingType);
+
+	// Only shows the preview tiles the building type can be placed on, or every tile again without a type
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void ShowValidPlacements(TSubclassOf<class ABuildingBase> BuildingType);
+
+	// Up to date placement mask of a building type, null with bSparseStorage where only footprints are checked
+	const FGridBitMask* GetPlacementMask(TSubclassOf<class ABuildingBase> BuildingType);
+
+	// Lockstep Functions
+
+	// Placements go through a command stream applied at the same tick on every peer, false with bSparseStorage
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	bool StartLockstep(int32 NumPeers, int32 LocalPeer);
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void StopLockstep();
+
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool IsLockstepRunning() const;
+
+	// Queues a placement of this peer if it is valid now. The type must be in LockstepBuildingTypes
+	// When applied, every peer only checks again that the footprint is clear: tile layers and baked slopes are not synchronized, placement rules are only checked here
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	bool QueueLockstepPlacement(TSubclassOf<class ABuildingBase> BuildingType, FGridCoord Coordinate);
+
+	// Closes the next tick of this peer, the packet is sent to every other peer, once per fixed step. Empty while this peer waits InputDelay ticks ahead of the others
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	TArray<uint8> WriteLockstepPacket();
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	bool ReceiveLockstepPacket(const TArray<uint8>& Packet);
+
+	// Applies every tick all peers sent their commands for, returns how many
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	int32 AdvanceLockstep();
+
+	// Next tick AdvanceLockstep applies
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int32 GetLockstepTick() const;
+
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	bool HasLockstepDesynced() const;
+
+	// Hash of the blocked cells, compared between peers every tick, 0 with bSparseStorage
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int32 GetOccupancyChecksum();
+
+	const FGridLockstep& GetLockstep() const;
+
+	// Memory Functions
+
+	// Bytes used by this grid, its tile labels and its preview grid
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int64 GetMemoryUsage();
+
+	// Bytes used by each part of the grid, the figures GetResourceSizeEx reports to memreport
+	void GetMemoryUsageBySubsystem(TMap<FName, SIZE_T>& OutBytes);
+
+	// Drops detail until the grid fits MemoryBudgetMB, called after generating the grid and from Tick when the budget or the usage changed
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void EnforceMemoryBudget();
+
+	// Tiles on each side of a preview grid instance, above 1 when the memory budget coarsened it
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int32 GetPreviewCoarseness() const;
+
+	// Reservation Functions
+
+	// Reserves a clear tile for a unit at a time step, false if another unit has it or Time is beyond the horizon
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	bool ReserveCell(FGridCoord Coordinate, int32 Time, int32 Unit);
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void ReleaseCell(FGridCoord Coordinate, int32 Time, int32 Unit);
+
+	// Unit that reserved a tile at a time step, -1 if none did
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int32 GetCellReservation(FGridCoord Coordinate, int32 Time);
+
+	// Reserves Path[i] at StartTime + i if every tile is clear and no other unit is in the way, nothing is reserved otherwise
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	bool ReservePath(const TArray<FGridCoord>& Path, int32 StartTime, int32 Unit);
+
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void ReleasePath(const TArray<FGridCoord>& Path, int32 StartTime, int32 Unit);
+
+	// Moves to the next time steps, the reservations left behind are dropped
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void AdvanceReservations(int32 Steps = 1);
+
+	// Current time step of the reservations
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	int32 GetReservationTime();
+
+	// Reservations of units by cell and time step, for cooperative pathfinding
+	const FGridReservationTable& GetReservations();
+
+	// Influence Map Functions
+
+	// Sets how far the sources of an influence layer spread, from its next update. Influence maps are not
+	// available with bSparseStorage, where every influence is 0
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void SetInfluenceKernel(FName Layer, int32 Radius, float Decay);
+
+	// Adds a source to the next update of an influence layer, the layer is created if needed
+	UFUNCTION(BlueprintCallable, Category = "Grids")
+	void AddInfluenceSource(FName Layer, FGridCoord Coordinate, float Weight);
+
+	// Influence of the last completed update of a layer
+	UFUNCTION(BlueprintPure, Category = "Grids")
+	float GetInfluence(FName Layer, FGridCoord Coordinate);
+
+	// Last completed update of a layer, null if the layer does not exist
+	const FGridInfluenceMap* GetInfluenceMap(FName Layer) const;
+
+	// Blocked flags of every cell, in sync with BlockedTiles. An empty grid with bSparseStorage, where every
+	// coordinate reads as blocked, the tiles are only in GetSparseTiles
+	const FGridOccupancy& GetOccupancy();
+
+	/**
+	 * Read only occupancy for worker threads, as it was when last published.
+	 * Snapshots are published once per frame after every actor ticked, changes made during
+	 * a frame are seen by readers from the next frame on. With bSparseStorage snapshots are
+	 * of the empty occupancy GetOccupancy returns.
+	 *
+	 * @return the last published snapshot, publishes one if there is none yet
+	 */
+	FGridOccupancySnapshotRef GetOccupancySnapshot();
+
+	/**
+	 * Publishes the current occupancy to GetOccupancySnapshot if tiles changed since the last one.
+	 * Only the chunks written since are re-pointed once readers let go of the older snapshot,
+	 * chunks are copied when next written to.
+	 */
+	void PublishOccupancySnapshot();
+
+	// Blocked tiles with bSparseStorage
+	FORCEINLINE const FGridChunkStore& GetSparseTiles() const
+	{
+		return SparseTiles;
+	}
+
+	FORCEINLINE const FGridFogOfWar& GetFogOfWar() const
+	{
+		return FogOfWar;
+	}
+
+	// CellID conversions for the current GridDimensions and CellLayout, for code looping over the grid
+	FORCEINLINE const FGridLayout& GetLayout()
+	{
+		if (Layout.Dimensions != GridDimensions || Layout.Layout != CellLayout)
+		{
+			Layout = FGridLayout(GridDimensions, CellLayout);
+		}
+		return Layout;
+	}
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	virtual void BeginDestroy() override;
+
+	// Ticks in the editor while a bake runs so it gets applied
+	virtual bool ShouldTickIfViewportsOnly() const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// Components are only added with EResourceSizeMode::EstimatedTotal, they are objects of their own otherwise
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -100,6 +515,148 @@ private:
 
 	void GenerateVisualGrid();
 	TArray<class UTextRenderComponent*> TextComponents;
+
+	// Calls Report with the bytes of every part of the grid
+	void CollectMemoryUsage(TFunctionRef<void(FName, SIZE_T)> Report);
+
+	// Frees what is rebuilt the next time it is asked for
+	void ReleaseCaches();
+
+	// Measures the usage every few frames and enforces the budget once it changed or the usage grew past it
+	void TickMemoryBudget(float DeltaTime);
+
+	// True with bSparseStorage, where Feature needs dense data it does not have, warns the first time
+	bool RejectSparseStorage(const TCHAR* Feature);
+
+	TSet<FName> ReportedSparseRejections;
+
+	// True while lockstep runs, where Feature would only change this peer, warns
+	bool RejectLockstep(const TCHAR* Feature);
+
+	// What the memory budget dropped, kept until MemoryBudgetMB changes so regenerating stays within it
+	float EnforcedMemoryBudgetMB;
+	int32 PreviewCoarseness;
+	bool bBudgetDroppedLabels;
+	bool bReportedOverBudget;
+
+	// Usage GetMemoryUsage last measured and the seconds since
+	int64 MemoryUsage;
+	float MemoryUsageAge;
+
+	// Usage that went over the budget the last time it was enforced, Tick leaves anything up to it alone
+	int64 EnforcedMemoryUsage;
+
+	FGridLayout Layout;
+
+	// Brings Occupancy up to date with BlockedTiles and the layout
+	FGridOccupancy& SyncOccupancy();
+
+	FGridOccupancy Occupancy;
+	bool bOccupancyDirty;
+
+	// Layout the occupancy, the journal and the baked cells were last built for
+	FGridLayout SyncedLayout;
+
+	// Updates BlockedTiles and the occupancy, returns true if an in bounds tile changed
+	bool ApplyTileBlocked(const FGridCoord& Coordinate, bool bBlocked);
+
+	// Sets every cell of a journal edit back to, or away from, its previous flag
+	void ReplayTileEdit(const FGridJournalOp& Op, bool bUndo);
+
+	// Finishes the journal edit and destroys the actors of the undone edits it discarded
+	void EndTileEdit();
+
+	// Actors of undone placements are only hidden, once the journal discards their edits nothing can show them again
+	void DestroyDiscardedActors(const TArray<TWeakObjectPtr<AActor>>& Actors);
+
+	FGridPlacementJournal TileJournal;
+
+	// Applies a finished bake and starts baking the dirty tiles
+	void PollBake();
+	void ApplyBake();
+
+	FGridBake Bake;
+
+	// Source of the blocked tiles with bSparseStorage
+	FGridChunkStore SparseTiles;
+
+	// Labels the regions again if the occupancy was rebuilt since
+	FGridRegions& SyncRegions();
+
+	// Regions are labeled the first time they are asked for, then kept up to date tile by tile
+	FGridRegions Regions;
+	bool bRegionsDirty;
+
+	// Computes the clearance again if the occupancy was rebuilt since
+	FGridClearance& SyncClearance();
+
+	// Computed the first time it is asked for, then kept up to date tile by tile
+	FGridClearance Clearance;
+	bool bClearanceDirty;
+
+	// Refreshes the placement mask of a building type, evaluated the first time the type is asked for
+	FGridPlacementMask& SyncPlacementMask(TSubclassOf<class ABuildingBase> BuildingType);
+
+	// Tells every placement mask a tile of a Column changed, INDEX_NONE for every tile
+	void MarkPlacementMasksDirty(int32 Column);
+
+	TMap<TWeakObjectPtr<UClass>, FGridPlacementMask> PlacementMasks;
+
+	// Tile layers by name, Column by Column whatever the cell layout
+	TMap<FName, FGridBitMask> TileLayers;
+
+	// Places a building of a lockstep command, only from the occupancy and what is derived from it so every peer does the same
+	void ApplyLockstepCommand(const FGridLockstepCommand& Command);
+
+	FGridLockstep Lockstep;
+	bool bLockstepRunning;
+	bool bReportedDesync;
+
+	// Sizes the reservations for ReservationHorizon and MaxReservationsPerStep, and clears them on a new layout
+	FGridReservationTable& SyncReservations();
+
+	FGridReservationTable Reservations;
+	FGridLayout ReservationLayout;
+
+	// Tiles MarkBakeDirty asked to bake again
+	bool bBakeDirty;
+	FGridCoord BakeDirtyMin;
+	FGridCoord BakeDirtyMax;
+
+	// Baked ground of every cell by CellID, empty until baked with bBakeHeightAndSlope
+	TArray<float> CellHeights;
+	TArray<float> CellSlopes;
+
+	// Publishes the occupancy snapshot once every actor of the world ticked
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	FGridOccupancyPublisher OccupancyPublisher;
+	bool bOccupancySnapshotDirty;
+	FDelegateHandle PostActorTickHandle;
+
+	FGridFogOfWar FogOfWar;
+	bool bFogOfWarDirty;
+
+	// Tiles changed since the last fog of war update, the units seeing them are invalidated then
+	bool bFogOfWarCellsDirty;
+	FGridCoord FogOfWarDirtyMin;
+	FGridCoord FogOfWarDirtyMax;
+
+	// Null with bSparseStorage
+	FGridInfluenceMap* FindOrAddInfluenceMap(FName Layer);
+	void TickInfluenceMaps(float DeltaTime);
+
+	TMap<FName, TUniquePtr<FGridInfluenceMap>> InfluenceMaps;
+
+	// Pushes this grid's counts to the RTSGrid stats group
+	void UpdateStats();
+
+	// Values this grid last added to the RTSGrid accumulator stats
+	int32 ReportedNumCells;
+	int32 ReportedNumBlockedTiles;
+	int32 ReportedNumPreviewInstances;
+	int32 ReportedNumTextComponents;
+	int64 ReportedMemoryBytes;
 };
 
 
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GridBakeTests
+{
+	// A 16x16 grid over a floor that stops before Row 14, with an obstacle on (5, 5) and a tilted cube on (10, 3)
+	static AGridSystem* SpawnBakeScene(FGridTestWorld& TestWorld, AActor*& OutObstacle)
+	{
+		AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(16));
+		Grid->BakeSettings.bBakeHeightAndSlope = true;
+
+		// Top at Z 0, from Row -0.5 to 13.5
+		TestWorld.SpawnCube(FVector(650.0f, 750.0f, -5.0f), FVector(14.0f, 20.0f, 0.1f));
+
+		// Buildings only block the obstacle test, the ground under them is the floor
+		OutObstacle = TestWorld.SpawnCube(FVector(500.0f, 500.0f, 50.0f), FVector(1.0f));
+		CastChecked<AStaticMeshActor>(OutObstacle)->GetStaticMeshComponent()->SetCollisionResponseToChannel(ECC_Visibility, ECR_Ignore);
+
+		// Sunk into the floor so its sides stay under the obstacle test of the next cells
+		TestWorld.SpawnCube(FVector(320.0f, 1000.0f, -30.0f), FVector(1.0f), FRotator(45.0f, 0.0f, 0.0f));
+
+		return Grid;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridBakeTest, "RTSGrid.Bake.BlockedTiles", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridBakeTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AActor* Obstacle = nullptr;
+	AGridSystem* Grid = GridBakeTests::SpawnBakeScene(TestWorld, Obstacle);
+
+	Grid->BakeBlockedTiles();
+	Grid->FinishBake();
+
+	TestTrue(TEXT("Open floor is clear"), Grid->IsClearTile(FGridCoord(2, 2)));
+	TestFalse(TEXT("Obstacle is blocked"), Grid->IsClearTile(FGridCoord(5, 5)));
+	TestTrue(TEXT("Next to the obstacle is clear"), Grid->IsClearTile(FGridCoord(5, 6)));
+	TestFalse(TEXT("Steep ground is blocked"), Grid->IsClearTile(FGridCoord(10, 3)));
+	TestFalse(TEXT("No ground is blocked"), Grid->IsClearTile(FGridCoord(8, 14)));
+	TestEqual(TEXT("Blocked tiles"), Grid->BlockedTiles.Num(), 16 * 2 + 2);
+
+	TestEqual(TEXT("Floor height"), Grid->GetCellHeight(FGridCoord(2, 2)), 0.0f, 1.0f);
+	TestEqual(TEXT("Floor slope"), Grid->GetCellSlope(FGridCoord(2, 2)), 0.0f, 1.0f);
+	TestEqual(TEXT("Tilted cube slope"), Grid->GetCellSlope(FGridCoord(10, 3)), 45.0f, 1.0f);
+
+	// Only the tiles under the removed obstacle are baked again
+	const FBox ObstacleBounds = Obstacle->GetComponentsBoundingBox();
+	Obstacle->Destroy();
+	Grid->SetTileBlocked(FGridCoord(12, 12), true);
+	Grid->MarkBakeDirty(ObstacleBounds);
+	Grid->FinishBake();
+
+	TestTrue(TEXT("Removed obstacle is clear"), Grid->IsClearTile(FGridCoord(5, 5)));
+	TestFalse(TEXT("Tiles outside the dirty rectangle are kept"), Grid->IsClearTile(FGridCoord(12, 12)));
+
+	Grid->UndoTileEdit();
+	TestFalse(TEXT("Bakes are undoable tile edits"), Grid->IsClearTile(FGridCoord(5, 5)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridBakeCancelTest, "RTSGrid.Bake.Cancel", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridBakeCancelTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AActor* Obstacle = nullptr;
+	AGridSystem* Grid = GridBakeTests::SpawnBakeScene(TestWorld, Obstacle);
+
+	Grid->BakeBlockedTiles();
+	Grid->CancelBake();
+	Grid->FinishBake();
+
+	TestFalse(TEXT("Cancelled bake is not running"), Grid->IsBaking());
+	TestEqual(TEXT("Cancelled bake changes no tile"), Grid->BlockedTiles.Num(), 0);
+	TestFalse(TEXT("Cancelled bake is not an edit"), Grid->CanUndoTileEdit());
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+struct FGridBenchmarkResult
+{
+	// Name of the measured operation
+	FString Name;
+
+	// Number of cells of the grid the operation ran on
+	int32 NumCells;
+
+	// Operations timed in each sample
+	int32 OpsPerSample;
+
+	// Median and fastest nanoseconds per operation across samples
+	double MedianNsPerOp;
+	double MinNsPerOp;
+};
+
+/**
+ * Times grid operations and writes the results as JSON to
+ * Saved/Automation/RTSGrid/<Suite>.json so they can be tracked across runs.
+ */
+class FGridBenchmarkReport
+{
+public:
+	explicit FGridBenchmarkReport(const FString& InSuite)
+		: Suite(InSuite)
+		, Sink(0)
+	{}
+
+	/**
+	 * Runs Func NumSamples times and records the time per operation.
+	 *
+	 * @param Name name of the operation
+	 * @param NumCells number of cells of the grid used
+	 * @param OpsPerSample number of operations done by one call of Func
+	 * @param Func callable returning an int64 that is kept alive so the work is not optimized away
+	 * @param NumSamples number of timed calls
+	 */
+	template<typename FuncType>
+	const FGridBenchmarkResult& Run(const FString& Name, int32 NumCells, int32 OpsPerSample, FuncType&& Func, int32 NumSamples = 7)
+	{
+		TArray<double> Samples;
+		Samples.Reserve(NumSamples);
+
+		for (int32 Sample = 0; Sample < NumSamples; Sample++)
+		{
+			const double Start = FPlatformTime::Seconds();
+			Sink += Func();
+			const double Elapsed = FPlatformTime::Seconds() - Start;
+			Samples.Add(Elapsed * 1.0e9 / FMath::Max(OpsPerSample, 1));
+		}
+
+		Samples.Sort();
+
+		FGridBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+		Result.Name = Name;
+		Result.NumCells = NumCells;
+		Result.OpsPerSample = OpsPerSample;
+		Result.MedianNsPerOp = Samples[Samples.Num() / 2];
+		Result.MinNsPerOp = Samples[0];
+		return Result;
+	}
+
+	/**
+	 * Records a value that is not a timing, such as a memory size.
+	 *
+	 * @param Name name of the metric
+	 * @param Value value of the metric
+	 */
+	void AddMetric(const FString& Name, double Value)
+	{
+		Metrics.Add(Name, Value);
+	}
+
+	/**
+	 * Logs the results to the test and writes the JSON report.
+	 *
+	 * @param Test the automation test owning this report
+	 * @return true if the report file was written
+	 */
+	bool Write(FAutomationTestBase& Test) const
+	{
+		TArray<TSharedPtr<FJsonValue>> JsonResults;
+
+		for (const FGridBenchmarkResult& Result : Results)
+		{
+			TSharedRef<FJsonObject> JsonResult = MakeShared<FJsonObject>();
+			JsonResult->SetStringField(TEXT("name"), Result.Name);
+			JsonResult->SetNumberField(TEXT("cells"), Result.NumCells);
+			JsonResult->SetNumberField(TEXT("ops_per_sample"), Result.OpsPerSample);
+			JsonResult->SetNumberField(TEXT("median_ns_per_op"), Result.MedianNsPerOp);
+			JsonResult->SetNumberField(TEXT("min_ns_per_op"), Result.MinNsPerOp);
+			JsonResults.Add(MakeShared<FJsonValueObject>(JsonResult));
+
+			Test.AddInfo(FString::Printf(TEXT("%s [%d cells]: %.2f ns/op (min %.2f)"),
+				*Result.Name, Result.NumCells, Result.MedianNsPerOp, Result.MinNsPerOp));
+		}
+
+		TSharedRef<FJsonObject> JsonMetrics = MakeShared<FJsonObject>();
+		for (const TPair<FString, double>& Metric : Metrics)
+		{
+			JsonMetrics->SetNumberField(Metric.Key, Metric.Value);
+			Test.AddInfo(FString::Printf(TEXT("%s: %.0f"), *Metric.Key, Metric.Value));
+		}
+
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("suite"), Suite);
+		Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+		Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+		Root->SetArrayField(TEXT("results"), JsonResults);
+		Root->SetObjectField(TEXT("metrics"), JsonMetrics);
+
+		FString Output;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+		FJsonSerializer::Serialize(Root, Writer);
+
+		const FString Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Automation"), TEXT("RTSGrid"), Suite + TEXT(".json"));
+		return FFileHelper::SaveStringToFile(Output, *Path);
+	}
+
+private:
+
+	FString Suite;
+	TArray<FGridBenchmarkResult> Results;
+	TMap<FString, double> Metrics;
+
+	// Accumulates the values returned by the benchmarked callables
+	volatile int64 Sink;
+};
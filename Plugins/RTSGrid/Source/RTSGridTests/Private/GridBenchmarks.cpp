@@ -0,0 +1,1208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridBenchmark.h"
+#include "GridChunkStore.h"
+#include "GridClearance.h"
+#include "GridFogOfWar.h"
+#include "GridInfluenceMap.h"
+#include "GridLineOfSight.h"
+#include "GridOccupancy.h"
+#include "GridPlacementRules.h"
+#include "GridRegions.h"
+#include "GridReservationTable.h"
+#include "GridTestWorld.h"
+#include "GridSystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GridBenchmarks
+{
+	// Square grid sizes every benchmark runs at
+	static const int32 GridSizes[] = { 32, 128, 512 };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridGenerateBenchmark, "RTSGrid.Benchmarks.GenerateGrid", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridGenerateBenchmark::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	FGridBenchmarkReport Report(TEXT("GenerateGrid"));
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(Size));
+		const int32 NumCells = Size * Size;
+
+		Grid->bShowPreviewGrid = false;
+		Report.Run(TEXT("GenerateGrid"), NumCells, NumCells, [Grid]()
+		{
+			return (int64)Grid->GenerateGrid().Num();
+		}, 5);
+
+		// The difference with the run above is the cost of GenerateVisualGrid
+		Grid->bShowPreviewGrid = true;
+		Report.Run(TEXT("GenerateGrid+VisualGrid"), NumCells, NumCells, [Grid]()
+		{
+			return (int64)Grid->GenerateGrid().Num();
+		}, 3);
+
+		Grid->Destroy();
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridCoordinateConversionBenchmark, "RTSGrid.Benchmarks.CoordinateConversion", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridCoordinateConversionBenchmark::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	FGridBenchmarkReport Report(TEXT("CoordinateConversion"));
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(Size));
+		const int32 NumCells = Size * Size;
+
+		Report.Run(TEXT("GetCoordinateFromCellID"), NumCells, NumCells, [Grid, NumCells]()
+		{
+			int64 Sum = 0;
+			for (int32 ID = 0; ID < NumCells; ID++)
+			{
+				const FGridCoord Coord = Grid->GetCoordinateFromCellID(ID);
+				Sum += Coord.Column + Coord.Row;
+			}
+			return Sum;
+		});
+
+		Report.Run(TEXT("GetCellIDFromCoordinate"), NumCells, NumCells, [Grid]()
+		{
+			int64 Sum = 0;
+			for (const FGridCoord& Coord : Grid->GeneratedGrid)
+			{
+				Sum += Grid->GetCellIDFromCoordinate(Coord);
+			}
+			return Sum;
+		});
+
+		const float CellSize = Grid->CellSize;
+		Report.Run(TEXT("GetCoordinateFromRelative"), NumCells, NumCells, [Grid, CellSize]()
+		{
+			int64 Sum = 0;
+			for (const FGridCoord& Coord : Grid->GeneratedGrid)
+			{
+				int32 CellID;
+				const FVector Relative(Coord.Row * CellSize + 10.0f, Coord.Column * CellSize - 10.0f, 0.0f);
+				Grid->GetCoordinateFromRelative(Relative, CellID);
+				Sum += CellID;
+			}
+			return Sum;
+		});
+
+		Grid->Destroy();
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridCellLayoutBenchmark, "RTSGrid.Benchmarks.CellLayout", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridCellLayoutBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("CellLayout"));
+
+	// Sums the 4 neighbours of every inner cell, the access pattern of most grid algorithms
+	auto SumNeighbours = [](const FGridLayout& Layout, const TArray<int32>& Values)
+	{
+		const int32 Offsets[] = { Layout.GetNeighborOffset(-1, 0), Layout.GetNeighborOffset(1, 0), Layout.GetNeighborOffset(0, -1), Layout.GetNeighborOffset(0, 1) };
+		int64 Sum = 0;
+		for (int32 Column = 1; Column < Layout.Dimensions.Column - 1; Column++)
+		{
+			for (int32 Row = 1; Row < Layout.Dimensions.Row - 1; Row++)
+			{
+				const int32 ID = Layout.ToCellID(FGridCoord(Column, Row));
+				Sum += Values[ID + Offsets[0]] + Values[ID + Offsets[1]] + Values[ID + Offsets[2]] + Values[ID + Offsets[3]];
+			}
+		}
+		return Sum;
+	};
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		const int32 NumCells = Size * Size;
+
+		// Odd sizes are the worst case for the padded layout
+		for (const int32 Dimension : { Size, Size + 3 })
+		{
+			const FGridLayout RowMajor(FGridCoord(Dimension), EGridCellLayout::RowMajor);
+			const FGridLayout PowerOfTwo(FGridCoord(Dimension), EGridCellLayout::PowerOfTwo);
+			const FString Suffix = Dimension == Size ? TEXT("") : TEXT(" (padded)");
+
+			for (const FGridLayout* Layout : { &RowMajor, &PowerOfTwo })
+			{
+				const FString Name = (Layout == &RowMajor ? TEXT("RowMajor") : TEXT("PowerOfTwo")) + Suffix;
+				const int32 NumIDs = Layout->GetNumCellIDs();
+
+				Report.Run(Name + TEXT(" ToCoordinate"), NumCells, NumIDs, [Layout, NumIDs]()
+				{
+					int64 Sum = 0;
+					for (int32 ID = 0; ID < NumIDs; ID++)
+					{
+						const FGridCoord Coord = Layout->ToCoordinate(ID);
+						Sum += Coord.Column + Coord.Row;
+					}
+					return Sum;
+				});
+
+				Report.Run(Name + TEXT(" ToCellID"), NumCells, Dimension * Dimension, [Layout]()
+				{
+					int64 Sum = 0;
+					for (int32 Column = 0; Column < Layout->Dimensions.Column; Column++)
+					{
+						for (int32 Row = 0; Row < Layout->Dimensions.Row; Row++)
+						{
+							Sum += Layout->ToCellID(FGridCoord(Column, Row));
+						}
+					}
+					return Sum;
+				});
+
+				TArray<int32> Values;
+				Values.Init(1, NumIDs);
+				Report.Run(Name + TEXT(" Neighbours"), NumCells, Dimension * Dimension, [Layout, &Values, &SumNeighbours]()
+				{
+					return SumNeighbours(*Layout, Values);
+				});
+			}
+		}
+	}
+
+	// Compile time layout of a 128 x 128 grid
+	using FStaticLayout = TStaticGridLayout<7, 7>;
+	Report.Run(TEXT("Static ToCoordinate"), FStaticLayout::NumCells, FStaticLayout::NumCells, []()
+	{
+		int64 Sum = 0;
+		for (int32 ID = 0; ID < FStaticLayout::NumCells; ID++)
+		{
+			const FGridCoord Coord = FStaticLayout::ToCoordinate(ID);
+			Sum += Coord.Column + Coord.Row;
+		}
+		return Sum;
+	});
+
+	// Through the AGridSystem UFUNCTIONs, which is what Blueprint and gameplay code pay
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(128));
+	const EGridCellLayout Layouts[] = { EGridCellLayout::RowMajor, EGridCellLayout::PowerOfTwo };
+	for (const EGridCellLayout CellLayout : Layouts)
+	{
+		Grid->CellLayout = CellLayout;
+		const int32 NumIDs = Grid->GetLayout().GetNumCellIDs();
+		Report.Run(CellLayout == EGridCellLayout::RowMajor ? TEXT("AGridSystem RowMajor GetCoordinateFromCellID") : TEXT("AGridSystem PowerOfTwo GetCoordinateFromCellID"), NumIDs, NumIDs, [Grid, NumIDs]()
+		{
+			int64 Sum = 0;
+			for (int32 ID = 0; ID < NumIDs; ID++)
+			{
+				const FGridCoord Coord = Grid->GetCoordinateFromCellID(ID);
+				Sum += Coord.Column + Coord.Row;
+			}
+			return Sum;
+		});
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridMortonLocalityBenchmark, "RTSGrid.Benchmarks.MortonLocality", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridMortonLocalityBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("MortonLocality"));
+
+	const int32 LargeGridSizes[] = { 512, 1024, 2048 };
+	const int32 RectSize = 6;
+	const int32 NumRects = 100000;
+
+	for (const int32 Size : LargeGridSizes)
+	{
+		const int32 NumCells = Size * Size;
+
+		for (const EGridCellLayout CellLayout : { EGridCellLayout::RowMajor, EGridCellLayout::Morton })
+		{
+			const FGridLayout Layout(FGridCoord(Size), CellLayout);
+			const FString Name = CellLayout == EGridCellLayout::RowMajor ? TEXT("RowMajor") : TEXT("Morton");
+
+			// One byte per cell, about one cell in six blocked
+			TArray<uint8> Blocked;
+			Blocked.SetNumZeroed(Layout.GetNumCellIDs());
+			FRandomStream Random(42);
+			for (int32 Column = 0; Column < Size; Column++)
+			{
+				for (int32 Row = 0; Row < Size; Row++)
+				{
+					Blocked[Layout.ToCellID(FGridCoord(Column, Row))] = Random.FRand() < 0.16f ? 1 : 0;
+				}
+			}
+
+			const FGridCoord Start(Size / 2, Size / 2);
+			Blocked[Layout.ToCellID(Start)] = 0;
+
+			Report.Run(Name + TEXT(" FloodFill"), NumCells, NumCells, [&Layout, &Blocked, Start]()
+			{
+				TArray<uint8> Visited;
+				Visited.SetNumZeroed(Layout.GetNumCellIDs());
+				TArray<int32> Queue;
+				Queue.Reserve(Layout.GetNumCells());
+
+				const int32 StartID = Layout.ToCellID(Start);
+				Queue.Add(StartID);
+				Visited[StartID] = 1;
+
+				const FGridCoord Deltas[] = { FGridCoord(-1, 0), FGridCoord(1, 0), FGridCoord(0, -1), FGridCoord(0, 1) };
+				for (int32 Head = 0; Head < Queue.Num(); Head++)
+				{
+					const FGridCoord Coord = Layout.ToCoordinate(Queue[Head]);
+					for (const FGridCoord& Delta : Deltas)
+					{
+						const FGridCoord Neighbour(Coord.Column + Delta.Column, Coord.Row + Delta.Row);
+						if (!Layout.IsInBounds(Neighbour))
+						{
+							continue;
+						}
+
+						const int32 NeighbourID = Layout.ToCellID(Neighbour);
+						if (!Visited[NeighbourID] && !Blocked[NeighbourID])
+						{
+							Visited[NeighbourID] = 1;
+							Queue.Add(NeighbourID);
+						}
+					}
+				}
+				return (int64)Queue.Num();
+			}, 3);
+
+			TArray<FGridCoord> RectOrigins;
+			RectOrigins.Reserve(NumRects);
+			FRandomStream RectRandom(7);
+			for (int32 Index = 0; Index < NumRects; Index++)
+			{
+				RectOrigins.Add(FGridCoord(RectRandom.RandRange(0, Size - RectSize), RectRandom.RandRange(0, Size - RectSize)));
+			}
+
+			Report.Run(Name + TEXT(" RectClear"), NumCells, NumRects, [&Layout, &Blocked, &RectOrigins, RectSize]()
+			{
+				int64 NumClear = 0;
+				for (const FGridCoord& Origin : RectOrigins)
+				{
+					bool bClear = true;
+					for (int32 Column = Origin.Column; Column < Origin.Column + RectSize && bClear; Column++)
+					{
+						for (int32 Row = Origin.Row; Row < Origin.Row + RectSize; Row++)
+						{
+							if (Blocked[Layout.ToCellID(FGridCoord(Column, Row))])
+							{
+								bClear = false;
+								break;
+							}
+						}
+					}
+					NumClear += bClear ? 1 : 0;
+				}
+				return NumClear;
+			});
+
+			// Cache misses are not portable to measure, count the 64 byte lines a full rect read touches instead
+			int64 NumLines = 0;
+			TSet<int32> Lines;
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				const FGridCoord& Origin = RectOrigins[Index];
+				Lines.Reset();
+				for (int32 Column = Origin.Column; Column < Origin.Column + RectSize; Column++)
+				{
+					for (int32 Row = Origin.Row; Row < Origin.Row + RectSize; Row++)
+					{
+						Lines.Add(Layout.ToCellID(FGridCoord(Column, Row)) / PLATFORM_CACHE_LINE_SIZE);
+					}
+				}
+				NumLines += Lines.Num();
+			}
+			Report.AddMetric(FString::Printf(TEXT("%s %d cache lines per %dx%d rect"), *Name, Size, RectSize, RectSize), NumLines / 1000.0);
+		}
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridFogOfWarBenchmark, "RTSGrid.Benchmarks.FogOfWar", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridFogOfWarBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("FogOfWar"));
+
+	const int32 Size = 512;
+	const int32 NumUnits = 1000;
+	const int32 NumPlayers = 4;
+	const int32 SightRadius = 8;
+	const double BudgetMs = 2.0;
+
+	const FGridLayout Layout(FGridCoord(Size), EGridCellLayout::RowMajor);
+
+	// Short walls every few cells so line of sight has work to do
+	FGridOccupancy Occupancy;
+	Occupancy.Reset(Layout);
+	FRandomStream Random(99);
+	for (int32 Wall = 0; Wall < 4000; Wall++)
+	{
+		const FGridCoord Start(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+		for (int32 Step = 0; Step < 5; Step++)
+		{
+			const FGridCoord Cell(Start.Column, Start.Row + Step);
+			if (Layout.IsInBounds(Cell))
+			{
+				Occupancy.SetBlocked(Layout.ToCellID(Cell), true);
+			}
+		}
+	}
+
+	for (const bool bLineOfSight : { false, true })
+	{
+		for (const int32 MovingPercent : { 10, 100 })
+		{
+			FGridFogOfWar FogOfWar;
+			FogOfWar.Reset(Layout, NumPlayers);
+
+			TArray<int32> Units;
+			TArray<FGridCoord> Positions;
+			for (int32 Index = 0; Index < NumUnits; Index++)
+			{
+				Positions.Add(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)));
+				Units.Add(FogOfWar.AddUnit(Index % NumPlayers, Positions.Last(), SightRadius));
+			}
+			FogOfWar.Update(bLineOfSight ? &Occupancy : nullptr);
+
+			const int32 NumMoving = NumUnits * MovingPercent / 100;
+			const FString Name = FString::Printf(TEXT("Update %d units, %d%% moving%s"), NumUnits, MovingPercent, bLineOfSight ? TEXT(", line of sight") : TEXT(""));
+
+			int32 Frame = 0;
+			const FGridBenchmarkResult& Result = Report.Run(Name, Size * Size, 1, [&]()
+			{
+				// Every moving unit steps one cell, alternating direction each frame
+				const int32 Step = (Frame++ & 1) ? 1 : -1;
+				for (int32 Index = 0; Index < NumMoving; Index++)
+				{
+					FGridCoord& Position = Positions[Index];
+					Position.Row = FMath::Clamp(Position.Row + Step, 0, Size - 1);
+					FogOfWar.MoveUnit(Units[Index], Position);
+				}
+
+				FogOfWar.Update(bLineOfSight ? &Occupancy : nullptr);
+				return (int64)FogOfWar.GetVisibility(0).Num();
+			}, 15);
+
+			if (Result.MedianNsPerOp > BudgetMs * 1.0e6)
+			{
+				AddWarning(FString::Printf(TEXT("%s took %.3f ms, over the %.1f ms budget"), *Name, Result.MedianNsPerOp / 1.0e6, BudgetMs));
+			}
+		}
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridLineOfSightBenchmark, "RTSGrid.Benchmarks.LineOfSight", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridLineOfSightBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("LineOfSight"));
+
+	const int32 Size = 512;
+	const int32 NumQueries = 20000;
+	const int32 MaxRange = 24;
+
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(Size));
+
+	FRandomStream Random(3);
+	for (int32 Index = 0; Index < Size * Size / 10; Index++)
+	{
+		Grid->SetTileBlocked(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)), true);
+	}
+
+	// Tower style queries, short lines from a cell to a cell in range
+	TArray<FGridLineQuery> Queries;
+	for (int32 Index = 0; Index < NumQueries; Index++)
+	{
+		const FGridCoord From(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+		const FGridCoord To(
+			FMath::Clamp(From.Column + Random.RandRange(-MaxRange, MaxRange), 0, Size - 1),
+			FMath::Clamp(From.Row + Random.RandRange(-MaxRange, MaxRange), 0, Size - 1));
+		Queries.Add(FGridLineQuery(From, To));
+	}
+
+	FGridOccupancySnapshotRef Snapshot = Grid->GetOccupancySnapshot();
+	TArray<bool> Results;
+	Results.SetNumUninitialized(NumQueries);
+
+	Report.Run(TEXT("HasLineOfSight"), Size * Size, NumQueries, [&Snapshot, &Queries]()
+	{
+		int64 NumClear = 0;
+		for (const FGridLineQuery& Query : Queries)
+		{
+			NumClear += FGridLineOfSight::HasLineOfSight(*Snapshot, Query.From, Query.To) ? 1 : 0;
+		}
+		return NumClear;
+	});
+
+	Report.Run(TEXT("HasLineOfSightBatch"), Size * Size, NumQueries, [&Snapshot, &Queries, &Results]()
+	{
+		FGridLineOfSight::HasLineOfSightBatch(*Snapshot, Queries, Results);
+		return (int64)Results[0];
+	});
+
+	// Physics traces of the same lines in a scene with no collision at all, a lower bound for the physics cost
+	UWorld* World = TestWorld.GetWorld();
+	const float CellSize = Grid->CellSize;
+	const int32 NumTraces = NumQueries / 10;
+	Report.Run(TEXT("LineTraceSingleByChannel (empty scene)"), Size * Size, NumTraces, [World, &Queries, CellSize, NumTraces]()
+	{
+		int64 NumHits = 0;
+		for (int32 Index = 0; Index < NumTraces; Index++)
+		{
+			FHitResult Hit;
+			const FVector Start(Queries[Index].From.Row * CellSize, Queries[Index].From.Column * CellSize, 50.0f);
+			const FVector End(Queries[Index].To.Row * CellSize, Queries[Index].To.Column * CellSize, 50.0f);
+			NumHits += World->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility) ? 1 : 0;
+		}
+		return NumHits;
+	});
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridInfluenceMapBenchmark, "RTSGrid.Benchmarks.InfluenceMap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridInfluenceMapBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("InfluenceMap"));
+
+	const int32 NumSources = 1000;
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		for (const int32 Radius : { 4, 12 })
+		{
+			FGridInfluenceMap InfluenceMap;
+			InfluenceMap.Reset(FGridCoord(Size));
+			InfluenceMap.SetKernel(Radius, 0.7f);
+
+			FRandomStream Random(11);
+			Report.Run(FString::Printf(TEXT("Update radius %d"), Radius), Size * Size, Size * Size, [&InfluenceMap, &Random, Size, NumSources]()
+			{
+				for (int32 Index = 0; Index < NumSources; Index++)
+				{
+					InfluenceMap.AddSource(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)), 1.0f);
+				}
+
+				InfluenceMap.ScheduleUpdate();
+				InfluenceMap.Flush();
+				return (int64)InfluenceMap.GetValues()[0];
+			});
+		}
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridOccupancySnapshotBenchmark, "RTSGrid.Benchmarks.OccupancySnapshot", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridOccupancySnapshotBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("OccupancySnapshot"));
+
+	const int32 LargeGridSizes[] = { 512, 1024, 2048 };
+	const int32 NumFrames = 100;
+	const int32 ChangesPerFrame = 8;
+
+	for (const int32 Size : LargeGridSizes)
+	{
+		const FGridLayout Layout(FGridCoord(Size), EGridCellLayout::Morton);
+		const int32 NumCells = Layout.GetNumCells();
+
+		FGridOccupancy Occupancy;
+		Occupancy.Reset(Layout);
+		FGridOccupancyPublisher Publisher;
+		TSharedPtr<const FGridOccupancy, ESPMode::ThreadSafe> Snapshot;
+		FRandomStream Random(9);
+
+		// A few placements per frame then a publish, the previous snapshot is still held by a reader
+		Report.Run(FString::Printf(TEXT("Publish %d changes"), ChangesPerFrame), NumCells, NumFrames, [&Occupancy, &Publisher, &Snapshot, &Random, &Layout, Size, NumFrames, ChangesPerFrame]()
+		{
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
+			{
+				for (int32 Change = 0; Change < ChangesPerFrame; Change++)
+				{
+					const FGridCoord Cell(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+					if (Occupancy.SetBlocked(Layout.ToCellID(Cell), Random.RandRange(0, 1) == 1))
+					{
+						Publisher.MarkChanged(Layout.ToCellID(Cell));
+					}
+				}
+				Snapshot = Publisher.Publish(Occupancy);
+			}
+			return (int64)Snapshot->GetNumBlocked();
+		});
+
+		// Baseline, copying the whole grid as a dense bit array every frame
+		TBitArray<> Bits(false, Layout.GetNumCellIDs());
+		TSharedPtr<const TBitArray<>, ESPMode::ThreadSafe> BitsSnapshot;
+		Report.Run(FString::Printf(TEXT("Full copy %d changes"), ChangesPerFrame), NumCells, NumFrames, [&Bits, &BitsSnapshot, &Random, &Layout, Size, NumFrames, ChangesPerFrame]()
+		{
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
+			{
+				for (int32 Change = 0; Change < ChangesPerFrame; Change++)
+				{
+					const FGridCoord Cell(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+					Bits[Layout.ToCellID(Cell)] = Random.RandRange(0, 1) == 1;
+				}
+				BitsSnapshot = MakeShared<TBitArray<>, ESPMode::ThreadSafe>(Bits);
+			}
+			return (int64)BitsSnapshot->Num();
+		});
+
+		Report.AddMetric(FString::Printf(TEXT("Occupancy bytes %d"), Size), (double)Occupancy.GetAllocatedSize());
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridTileJournalBenchmark, "RTSGrid.Benchmarks.TileJournal", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridTileJournalBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("TileJournal"));
+
+	// A 1000 tile wall, 40 by 25 tiles
+	const FGridCoord WallMin(4, 4);
+	const FGridCoord WallMax(43, 28);
+	const int32 WallTiles = 1000;
+
+	for (const int32 Size : { 128, 512 })
+	{
+		FGridTestWorld TestWorld;
+		AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(Size));
+		const int32 NumCells = Size * Size;
+
+		// Tiles already blocked elsewhere on the grid, the undo cost should not depend on them
+		FRandomStream Random(11);
+		for (int32 Index = 0; Index < NumCells / 10; Index++)
+		{
+			Grid->SetTileBlocked(FGridCoord(Random.RandRange(50, Size - 1), Random.RandRange(50, Size - 1)), true);
+		}
+
+		Grid->SetRectBlocked(WallMin, WallMax, true);
+
+		Report.Run(TEXT("Undo+Redo wall"), NumCells, WallTiles, [Grid]()
+		{
+			Grid->UndoTileEdit();
+			Grid->RedoTileEdit();
+			return (int64)Grid->BlockedTiles.Num();
+		});
+
+		// What snapshotting the whole set for every edit would cost instead
+		Report.Run(TEXT("Copy BlockedTiles"), NumCells, WallTiles, [Grid]()
+		{
+			TSet<FGridCoord> Copy = Grid->BlockedTiles;
+			return (int64)Copy.Num();
+		});
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridBakeBenchmark, "RTSGrid.Benchmarks.Bake", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridBakeBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("Bake"));
+
+	const int32 Size = 512;
+	const int32 NumCells = Size * Size;
+	const float CellSize = 100.0f;
+
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(Size), CellSize);
+
+	// A floor under the whole grid with scattered obstacles ignored by the ground traces
+	const float Extent = Size * CellSize;
+	TestWorld.SpawnCube(FVector(Extent * 0.5f, Extent * 0.5f, -5.0f), FVector(Size + 1.0f, Size + 1.0f, 0.1f));
+
+	FRandomStream Random(13);
+	for (int32 Index = 0; Index < 2000; Index++)
+	{
+		const FVector Location(Random.FRandRange(0.0f, Extent), Random.FRandRange(0.0f, Extent), 50.0f);
+		AStaticMeshActor* Obstacle = TestWorld.SpawnCube(Location, FVector(Random.FRandRange(1.0f, 4.0f), Random.FRandRange(1.0f, 4.0f), 1.0f));
+		Obstacle->GetStaticMeshComponent()->SetCollisionResponseToChannel(ECC_Visibility, ECR_Ignore);
+	}
+
+	for (const bool bHeightAndSlope : { false, true })
+	{
+		Grid->BakeSettings.bBakeHeightAndSlope = bHeightAndSlope;
+
+		Report.Run(bHeightAndSlope ? TEXT("Bake 512x512 with height and slope") : TEXT("Bake 512x512"), NumCells, NumCells, [Grid]()
+		{
+			Grid->BakeBlockedTiles();
+			Grid->FinishBake();
+			return (int64)Grid->BlockedTiles.Num();
+		}, 3);
+	}
+
+	// Rebaking around a building that was placed or removed
+	Report.Run(TEXT("Bake 32x32 dirty rectangle"), NumCells, 32 * 32, [Grid, CellSize]()
+	{
+		Grid->MarkBakeDirty(FBox(FVector(10000.0f, 10000.0f, 0.0f), FVector(10000.0f + 31 * CellSize, 10000.0f + 31 * CellSize, 100.0f)));
+		Grid->FinishBake();
+		return (int64)Grid->BlockedTiles.Num();
+	});
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridChunkStoreBenchmark, "RTSGrid.Benchmarks.ChunkStore", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridChunkStoreBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("ChunkStore"));
+
+	// A 16K x 16K open world with bases scattered over it
+	const int32 Size = 16384;
+	const int32 NumCells = Size * Size;
+	const int32 NumBases = 2000;
+	const int32 BaseSize = 24;
+	const int32 NumQueries = 100000;
+
+	for (const int32 MaxResidentChunks : { 256, 4096 })
+	{
+		FGridChunkStore Store;
+		Store.Reset(FPaths::AutomationTransientDir() / TEXT("RTSGridChunkStoreBenchmark.page"), MaxResidentChunks);
+
+		FRandomStream Random(17);
+		TArray<FGridCoord> Bases;
+		for (int32 Index = 0; Index < NumBases; Index++)
+		{
+			const FGridCoord Base(Random.RandRange(0, Size - BaseSize), Random.RandRange(0, Size - BaseSize));
+			Bases.Add(Base);
+
+			for (int32 Tile = 0; Tile < BaseSize * BaseSize / 4; Tile++)
+			{
+				Store.SetBlocked(FGridCoord(Base.Column + Random.RandRange(0, BaseSize - 1), Base.Row + Random.RandRange(0, BaseSize - 1)), true);
+			}
+		}
+
+		const FString Budget = FString::Printf(TEXT("%d resident chunks"), MaxResidentChunks);
+
+		// Units mostly look around their own base, sometimes anywhere on the map
+		Report.Run(TEXT("IsBlocked local, ") + Budget, NumCells, NumQueries, [&Store, &Bases, &Random, NumQueries, BaseSize, Size]()
+		{
+			int64 NumBlocked = 0;
+			for (int32 Query = 0; Query < NumQueries; Query++)
+			{
+				const FGridCoord& Base = Bases[(Query / 1000) % Bases.Num()];
+				NumBlocked += Store.IsBlocked(FGridCoord(Base.Column + Random.RandRange(0, BaseSize - 1), Base.Row + Random.RandRange(0, BaseSize - 1))) ? 1 : 0;
+			}
+			return NumBlocked;
+		});
+
+		Report.Run(TEXT("IsBlocked anywhere, ") + Budget, NumCells, NumQueries, [&Store, &Random, NumQueries, Size]()
+		{
+			int64 NumBlocked = 0;
+			for (int32 Query = 0; Query < NumQueries; Query++)
+			{
+				NumBlocked += Store.IsBlocked(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1))) ? 1 : 0;
+			}
+			return NumBlocked;
+		});
+
+		Report.AddMetric(TEXT("Resident bytes, ") + Budget, (double)Store.GetAllocatedSize());
+		Report.AddMetric(TEXT("Page file bytes, ") + Budget, (double)Store.GetPageFileSize());
+		Report.AddMetric(TEXT("Chunks, ") + Budget, (double)Store.GetNumChunks());
+		Report.AddMetric(TEXT("Page ins, ") + Budget, (double)Store.GetNumPageIns());
+	}
+
+	// What a dense bit array of the same grid would take
+	Report.AddMetric(TEXT("Dense bits bytes"), (double)NumCells / 8);
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridReservationBenchmark, "RTSGrid.Benchmarks.Reservation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridReservationBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("Reservation"));
+
+	const int32 Horizon = 32;
+	const int32 NumUnits = 1000;
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		const FGridLayout Layout(FGridCoord(Size), EGridCellLayout::RowMajor);
+		const int32 NumCells = Size * Size;
+
+		FGridReservationTable Table;
+		Table.Reset(Horizon, NumUnits);
+
+		// Every unit walks a random straight line for the whole horizon, some of them cross
+		FRandomStream Random(11);
+		TArray<TArray<int32>> Paths;
+		for (int32 Unit = 0; Unit < NumUnits; Unit++)
+		{
+			const bool bAlongRow = Random.RandBool();
+			const int32 Line = Random.RandRange(0, Size - 1);
+			const int32 Start = Random.RandRange(0, Size - Horizon);
+
+			TArray<int32>& Path = Paths.AddDefaulted_GetRef();
+			for (int32 Step = 0; Step < Horizon - 1; Step++)
+			{
+				Path.Add(bAlongRow ? Layout.ToCellID(FGridCoord(Line, Start + Step)) : Layout.ToCellID(FGridCoord(Start + Step, Line)));
+			}
+		}
+
+		// One planning round, every unit reserves its path against the ones already reserved
+		Report.Run(TEXT("ReservePath"), NumCells, NumUnits, [&Table, &Paths, NumUnits]()
+		{
+			Table.Advance(1);
+
+			int64 NumReserved = 0;
+			for (int32 Unit = 0; Unit < NumUnits; Unit++)
+			{
+				NumReserved += Table.ReservePath(Paths[Unit], Table.GetCurrentTime(), Unit) ? 1 : 0;
+			}
+			return NumReserved;
+		});
+
+		Report.Run(TEXT("GetReservation"), NumCells, NumUnits * (Horizon - 1), [&Table, &Paths, NumUnits, Horizon]()
+		{
+			int64 NumReserved = 0;
+			for (int32 Unit = 0; Unit < NumUnits; Unit++)
+			{
+				for (int32 Step = 0; Step < Horizon - 1; Step++)
+				{
+					NumReserved += Table.GetReservation(Paths[Unit][Step], Table.GetCurrentTime() + Step) != INDEX_NONE ? 1 : 0;
+				}
+			}
+			return NumReserved;
+		});
+
+		Report.AddMetric(FString::Printf(TEXT("Table bytes, %dx%d"), Size, Size), (double)Table.GetAllocatedSize());
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridRegionsBenchmark, "RTSGrid.Benchmarks.Regions", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridRegionsBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("Regions"));
+
+	const int32 NumEdits = 1000;
+	const int32 NumQueries = 100000;
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		const FGridLayout Layout(FGridCoord(Size), EGridCellLayout::RowMajor);
+		const int32 NumCells = Size * Size;
+
+		// A fifth of the tiles blocked at random, like a level with scattered obstacles
+		FRandomStream Random(23);
+		FGridOccupancy Occupancy;
+		Occupancy.Reset(Layout);
+		for (int32 Index = 0; Index < NumCells / 5; Index++)
+		{
+			Occupancy.SetBlocked(Random.RandRange(0, NumCells - 1), true);
+		}
+
+		FGridRegions Regions;
+		Report.Run(TEXT("Reset"), NumCells, NumCells, [&Regions, &Occupancy]()
+		{
+			Regions.Reset(Occupancy);
+			return (int64)Regions.GetNumRegions();
+		}, 5);
+
+		TArray<int32> Edits;
+		for (int32 Index = 0; Index < NumEdits; Index++)
+		{
+			Edits.Add(Random.RandRange(0, NumCells - 1));
+		}
+
+		// Every edit is blocked then cleared again so each sample starts from the same grid
+		Report.Run(TEXT("SetBlocked"), NumCells, NumEdits * 2, [&Regions, &Occupancy, &Edits]()
+		{
+			int64 NumVisited = 0;
+			for (const int32 CellID : Edits)
+			{
+				const bool bWasBlocked = Occupancy.IsBlocked(CellID);
+				Regions.SetBlocked(CellID, !bWasBlocked);
+				NumVisited += Regions.GetNumCellsVisited();
+				Regions.SetBlocked(CellID, bWasBlocked);
+				NumVisited += Regions.GetNumCellsVisited();
+			}
+			return NumVisited;
+		});
+
+		Report.Run(TEXT("WouldSplit"), NumCells, NumEdits, [&Regions, &Edits]()
+		{
+			int64 NumSplits = 0;
+			for (const int32 CellID : Edits)
+			{
+				NumSplits += Regions.WouldSplit(TArrayView<const int32>(&CellID, 1)) ? 1 : 0;
+			}
+			return NumSplits;
+		});
+
+		Report.Run(TEXT("AreConnected"), NumCells, NumQueries, [&Regions, &Random, NumCells, NumQueries]()
+		{
+			int64 NumConnected = 0;
+			for (int32 Query = 0; Query < NumQueries; Query++)
+			{
+				NumConnected += Regions.AreConnected(Random.RandRange(0, NumCells - 1), Random.RandRange(0, NumCells - 1)) ? 1 : 0;
+			}
+			return NumConnected;
+		});
+
+		Report.AddMetric(FString::Printf(TEXT("Regions bytes, %dx%d"), Size, Size), (double)Regions.GetAllocatedSize());
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridClearanceBenchmark, "RTSGrid.Benchmarks.Clearance", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridClearanceBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("Clearance"));
+
+	const int32 NumEdits = 1000;
+	const int32 NumQueries = 100000;
+	const int32 FootprintSize = 3;
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		const FGridLayout Layout(FGridCoord(Size), EGridCellLayout::RowMajor);
+		const int32 NumCells = Size * Size;
+
+		FRandomStream Random(29);
+		FGridOccupancy Occupancy;
+		Occupancy.Reset(Layout);
+		for (int32 Index = 0; Index < NumCells / 20; Index++)
+		{
+			Occupancy.SetBlocked(Random.RandRange(0, NumCells - 1), true);
+		}
+
+		FGridClearance Clearance;
+		Report.Run(TEXT("Reset"), NumCells, NumCells, [&Clearance, &Occupancy]()
+		{
+			Clearance.Reset(Occupancy);
+			return (int64)Clearance.GetNumCellsUpdated();
+		}, 5);
+
+		TArray<FGridCoord> Edits;
+		for (int32 Index = 0; Index < NumEdits; Index++)
+		{
+			Edits.Add(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)));
+		}
+
+		// Every edit is undone right after so each sample starts from the same grid
+		Report.Run(TEXT("SetBlocked"), NumCells, NumEdits * 2, [&Clearance, &Occupancy, &Layout, &Edits]()
+		{
+			int64 NumUpdated = 0;
+			for (const FGridCoord& Coordinate : Edits)
+			{
+				const bool bWasBlocked = Occupancy.IsBlocked(Layout.ToCellID(Coordinate));
+				Clearance.SetBlocked(Coordinate, !bWasBlocked);
+				NumUpdated += Clearance.GetNumCellsUpdated();
+				Clearance.SetBlocked(Coordinate, bWasBlocked);
+				NumUpdated += Clearance.GetNumCellsUpdated();
+			}
+			return NumUpdated;
+		});
+
+		TArray<FGridCoord> Queries;
+		for (int32 Index = 0; Index < NumQueries; Index++)
+		{
+			Queries.Add(FGridCoord(Random.RandRange(0, Size - FootprintSize), Random.RandRange(0, Size - FootprintSize)));
+		}
+
+		// What a search expanding a 3x3 unit would pay at every node, with and without the clearance
+		Report.Run(TEXT("Fits 3x3"), NumCells, NumQueries, [&Clearance, &Layout, &Queries, FootprintSize]()
+		{
+			int64 NumFits = 0;
+			for (const FGridCoord& Coordinate : Queries)
+			{
+				NumFits += Clearance.Fits(Layout.ToCellID(Coordinate), FootprintSize) ? 1 : 0;
+			}
+			return NumFits;
+		});
+
+		Report.Run(TEXT("Footprint scan 3x3"), NumCells, NumQueries, [&Occupancy, &Layout, &Queries, FootprintSize]()
+		{
+			int64 NumFits = 0;
+			for (const FGridCoord& Coordinate : Queries)
+			{
+				bool bFits = true;
+				for (int32 Column = 0; Column < FootprintSize && bFits; Column++)
+				{
+					for (int32 Row = 0; Row < FootprintSize && bFits; Row++)
+					{
+						bFits = !Occupancy.IsBlocked(Layout.ToCellID(FGridCoord(Coordinate.Column + Column, Coordinate.Row + Row)));
+					}
+				}
+				NumFits += bFits ? 1 : 0;
+			}
+			return NumFits;
+		});
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridPlacementMaskBenchmark, "RTSGrid.Benchmarks.PlacementMask", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridPlacementMaskBenchmark::RunTest(const FString& Parameters)
+{
+	FGridBenchmarkReport Report(TEXT("PlacementMask"));
+
+	const int32 NumEdits = 200;
+	const int32 NumQueries = 100000;
+	const int32 FootprintSize = 3;
+	const FName Road(TEXT("Road"));
+	const FName Enemy(TEXT("Enemy"));
+
+	// A 3x3 building next to a road and 4 tiles away from enemy buildings
+	TArray<FGridPlacementRule> Rules;
+	Rules.AddDefaulted(2);
+	Rules[0].Type = EGridPlacementRule::NearLayer;
+	Rules[0].Layer = Road;
+	Rules[0].Distance = 1;
+	Rules[1].Type = EGridPlacementRule::AwayFromLayer;
+	Rules[1].Layer = Enemy;
+	Rules[1].Distance = 4;
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		const FGridLayout Layout(FGridCoord(Size), EGridCellLayout::RowMajor);
+		const int32 NumCells = Size * Size;
+
+		FRandomStream Random(31);
+		FGridOccupancy Occupancy;
+		Occupancy.Reset(Layout);
+		TMap<FName, FGridBitMask> Layers;
+		FGridBitMask& RoadLayer = Layers.Add(Road);
+		FGridBitMask& EnemyLayer = Layers.Add(Enemy);
+		RoadLayer.Init(Layout.Dimensions, false);
+		EnemyLayer.Init(Layout.Dimensions, false);
+
+		for (int32 Index = 0; Index < NumCells / 20; Index++)
+		{
+			Occupancy.SetBlocked(Random.RandRange(0, NumCells - 1), true);
+		}
+		for (int32 Index = 0; Index < NumCells / 100; Index++)
+		{
+			EnemyLayer.Set(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)), true);
+		}
+		for (int32 Column = 0; Column < Size; Column++)
+		{
+			for (int32 Row = 0; Row < Size; Row++)
+			{
+				RoadLayer.Set(FGridCoord(Column, Row), Column % 16 == 0 || Row % 16 == 0);
+			}
+		}
+
+		const TArray<float> CellSlopes;
+		const FGridPlacementMask::FInputs Inputs{ Occupancy, Layers, CellSlopes };
+		FGridPlacementMask Mask;
+		Mask.SetRules(Rules, FootprintSize);
+
+		Report.Run(TEXT("Evaluate"), NumCells, NumCells, [&Mask, &Inputs]()
+		{
+			Mask.MarkAllDirty();
+			return (int64)Mask.Refresh(Inputs).CountSetBits();
+		}, 5);
+
+		TArray<FGridCoord> Edits;
+		for (int32 Index = 0; Index < NumEdits; Index++)
+		{
+			Edits.Add(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)));
+		}
+
+		// What placing a building costs the next hover, every edit is undone right after
+		Report.Run(TEXT("Refresh after edit"), NumCells, NumEdits * 2, [&Mask, &Inputs, &Occupancy, &Layout, &Edits]()
+		{
+			int64 NumColumns = 0;
+			for (const FGridCoord& Coordinate : Edits)
+			{
+				const int32 CellID = Layout.ToCellID(Coordinate);
+				const bool bWasBlocked = Occupancy.IsBlocked(CellID);
+				for (const bool bBlocked : { !bWasBlocked, bWasBlocked })
+				{
+					Occupancy.SetBlocked(CellID, bBlocked);
+					Mask.MarkDirty(Coordinate.Column);
+					Mask.Refresh(Inputs);
+					NumColumns += Mask.GetNumColumnsEvaluated();
+				}
+			}
+			return NumColumns;
+		});
+
+		TArray<FGridCoord> Queries;
+		for (int32 Index = 0; Index < NumQueries; Index++)
+		{
+			Queries.Add(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)));
+		}
+
+		Report.Run(TEXT("Hover bit test"), NumCells, NumQueries, [&Mask, &Queries]()
+		{
+			int64 NumValid = 0;
+			for (const FGridCoord& Coordinate : Queries)
+			{
+				NumValid += Mask.GetMask().IsSet(Coordinate) ? 1 : 0;
+			}
+			return NumValid;
+		});
+
+		// The same rules checked tile by tile, what a hover paid without the mask
+		Report.Run(TEXT("Hover rule scan"), NumCells, NumQueries, [&Occupancy, &RoadLayer, &EnemyLayer, &Rules, &Queries, FootprintSize]()
+		{
+			int64 NumValid = 0;
+			for (const FGridCoord& Coordinate : Queries)
+			{
+				bool bClear = true;
+				bool bNearRoad = false;
+				bool bNearEnemy = false;
+				const int32 Reach = FootprintSize + Rules[1].Distance;
+				for (int32 Column = Coordinate.Column - Rules[1].Distance; Column < Coordinate.Column + Reach; Column++)
+				{
+					for (int32 Row = Coordinate.Row - Rules[1].Distance; Row < Coordinate.Row + Reach; Row++)
+					{
+						const FGridCoord Tile(Column, Row);
+						const bool bInFootprint = Column >= Coordinate.Column && Column < Coordinate.Column + FootprintSize && Row >= Coordinate.Row && Row < Coordinate.Row + FootprintSize;
+						const bool bNearFootprint = Column >= Coordinate.Column - 1 && Column <= Coordinate.Column + FootprintSize && Row >= Coordinate.Row - 1 && Row <= Coordinate.Row + FootprintSize;
+						bClear &= !bInFootprint || !Occupancy.IsBlocked(Tile);
+						bNearRoad |= bNearFootprint && RoadLayer.IsSet(Tile);
+						bNearEnemy |= EnemyLayer.IsSet(Tile);
+					}
+				}
+				NumValid += bClear && bNearRoad && !bNearEnemy ? 1 : 0;
+			}
+			return NumValid;
+		});
+
+		Report.AddMetric(FString::Printf(TEXT("Placement mask bytes %d"), Size), (double)Mask.GetAllocatedSize());
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridMemoryBenchmark, "RTSGrid.Benchmarks.Memory", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridMemoryBenchmark::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	FGridBenchmarkReport Report(TEXT("Memory"));
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(Size), 100.0f, true);
+		const int32 NumCells = Size * Size;
+
+		// Touch the lazily built parts so they are part of the figures
+		Grid->GetOccupancy();
+		Grid->GetRegions();
+		Grid->GetClearance();
+
+		TMap<FName, SIZE_T> Usage;
+		Grid->GetMemoryUsageBySubsystem(Usage);
+		for (const TPair<FName, SIZE_T>& Pair : Usage)
+		{
+			Report.AddMetric(FString::Printf(TEXT("%s bytes %d"), *Pair.Key.ToString(), Size), (double)Pair.Value);
+		}
+
+		// Lower bounds from what each subsystem has to store per cell
+		TestTrue(TEXT("GeneratedGrid covers every cell"), Usage.FindRef(TEXT("GeneratedGrid")) >= NumCells * sizeof(FGridCoord));
+		TestTrue(TEXT("Occupancy covers a bit per cell"), Usage.FindRef(TEXT("Occupancy")) >= NumCells / 8);
+		TestTrue(TEXT("Clearance covers a byte per cell"), Usage.FindRef(TEXT("Clearance")) >= (SIZE_T)NumCells);
+		TestTrue(TEXT("Preview covers an instance per cell"), Usage.FindRef(TEXT("PreviewGrid")) >= NumCells * sizeof(FMatrix));
+		// What a plain actor reports plus every subsystem once, double counted components would be far over the tolerance
+		const int64 BaseSize = (int64)GetMutableDefault<AActor>()->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		const int64 MemoryUsage = Grid->GetMemoryUsage();
+		const int64 ResourceSize = (int64)Grid->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		const int64 Tolerance = FMath::Max<int64>(MemoryUsage / 100, 4096);
+		TestTrue(FString::Printf(TEXT("memreport total of %lld bytes matches the %lld bytes of the subsystems"), ResourceSize, MemoryUsage), FMath::Abs(ResourceSize - (BaseSize + MemoryUsage)) <= Tolerance);
+
+		// Tick pays this every quarter second, EnforceMemoryBudget once per step it takes
+		Report.Run(TEXT("GetMemoryUsage"), NumCells, 1, [Grid]()
+		{
+			return Grid->GetMemoryUsage();
+		});
+
+		// Half the usage has to come from the preview and the caches
+		const float HalfBudgetMB = Grid->GetMemoryUsage() / 2 / (1024.0f * 1024.0f);
+		Report.Run(TEXT("Restore, then enforce half"), NumCells, 1, [Grid, HalfBudgetMB]()
+		{
+			Grid->MemoryBudgetMB = 0.0f;
+			Grid->EnforceMemoryBudget();
+			Grid->MemoryBudgetMB = HalfBudgetMB;
+			Grid->EnforceMemoryBudget();
+			return (int64)Grid->GetPreviewCoarseness();
+		}, 3);
+
+		const int64 BudgetUsage = Grid->GetMemoryUsage();
+		TestTrue(FString::Printf(TEXT("%d grid fits half its memory"), Size), BudgetUsage <= (int64)(Grid->MemoryBudgetMB * 1024.0f * 1024.0f));
+		Report.AddMetric(FString::Printf(TEXT("Budgeted bytes %d"), Size), (double)BudgetUsage);
+		Report.AddMetric(FString::Printf(TEXT("Budgeted preview coarseness %d"), Size), Grid->GetPreviewCoarseness());
+
+		Grid->Destroy();
+	}
+
+	return Report.Write(*this);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridValidLocationBenchmark, "RTSGrid.Benchmarks.IsValidLocation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGridValidLocationBenchmark::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	FGridBenchmarkReport Report(TEXT("IsValidLocation"));
+
+	for (const int32 Size : GridBenchmarks::GridSizes)
+	{
+		AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(Size));
+		const int32 NumCells = Size * Size;
+
+		// Block roughly one cell out of eight, spread over the grid
+		FRandomStream Random(1234);
+		for (int32 Index = 0; Index < NumCells / 8; Index++)
+		{
+			Grid->BlockedTiles.Add(FGridCoord(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)));
+		}
+
+		Report.Run(TEXT("IsValidLocation"), NumCells, NumCells, [Grid]()
+		{
+			int64 NumValid = 0;
+			for (const FGridCoord& Coord : Grid->GeneratedGrid)
+			{
+				NumValid += Grid->IsValidLocation(Coord) ? 1 : 0;
+			}
+			return NumValid;
+		});
+
+		Grid->Destroy();
+	}
+
+	return Report.Write(*this);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "GridChunkStore.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridChunkStorePagingTest, "RTSGrid.ChunkStore.Paging", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridChunkStorePagingTest::RunTest(const FString& Parameters)
+{
+	FGridChunkStore Store;
+	Store.Reset(FPaths::AutomationTransientDir() / TEXT("RTSGridChunkStoreTest.page"), 4);
+
+	TestFalse(TEXT("Empty store is clear"), Store.IsBlocked(FGridCoord(100, 100)));
+	TestFalse(TEXT("Clearing a clear cell changes nothing"), Store.SetBlocked(FGridCoord(100, 100), false));
+	TestEqual(TEXT("Reads and clears allocate nothing"), Store.GetNumChunks(), 0);
+
+	// Two cells in each of 20 chunks, some with negative coordinates
+	TArray<FGridCoord> Cells;
+	for (int32 Index = 0; Index < 20; Index++)
+	{
+		const FGridCoord Base((Index % 5 - 2) * FGridChunkStore::ChunkSize, (Index / 5) * 16 * FGridChunkStore::ChunkSize);
+		Cells.Add(Base + 3);
+		Cells.Add(Base + 40);
+	}
+
+	for (const FGridCoord& Cell : Cells)
+	{
+		TestTrue(TEXT("Blocking a cell changes it"), Store.SetBlocked(Cell, true));
+	}
+
+	TestEqual(TEXT("Blocked cells"), Store.GetNumBlocked(), 40);
+	TestEqual(TEXT("Chunks"), Store.GetNumChunks(), 20);
+	TestEqual(TEXT("Resident chunks stay in budget"), Store.GetNumResidentChunks(), 4);
+	TestTrue(TEXT("Cold chunks are paged out"), Store.GetPageFileSize() > 0);
+
+	for (const FGridCoord& Cell : Cells)
+	{
+		TestTrue(TEXT("Paged out cells are still blocked"), Store.IsBlocked(Cell));
+		TestFalse(TEXT("Their neighbours are still clear"), Store.IsBlocked(Cell + 1));
+	}
+	TestTrue(TEXT("Reading cold chunks pages them in"), Store.GetNumPageIns() >= 16);
+
+	// Rewriting chunks many times leaves dead pages, the file is compacted once they pass a megabyte
+	for (int32 Round = 0; Round < 6000; Round++)
+	{
+		for (const FGridCoord& Cell : Cells)
+		{
+			Store.SetBlocked(Cell + 1, Round % 2 == 0);
+		}
+	}
+	TestTrue(TEXT("Page file is compacted"), Store.GetPageFileSize() < 1536 * 1024);
+	TestEqual(TEXT("Blocked cells after rewrites"), Store.GetNumBlocked(), 40);
+
+	for (const FGridCoord& Cell : Cells)
+	{
+		Store.SetBlocked(Cell, false);
+	}
+	TestEqual(TEXT("Clearing every cell frees every chunk"), Store.GetNumChunks(), 0);
+	TestEqual(TEXT("No blocked cell left"), Store.GetNumBlocked(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridChunkStoreCompactionTest, "RTSGrid.ChunkStore.Compaction", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridChunkStoreCompactionTest::RunTest(const FString& Parameters)
+{
+	FGridChunkStore Store;
+	Store.Reset(FPaths::AutomationTransientDir() / TEXT("RTSGridChunkStoreCompactionTest.page"), 2);
+
+	// Half the cells blocked at random, so the pages do not compress and are read back as they are
+	const int32 NumChunks = 12;
+	const int32 CellsPerChunk = FGridChunkStore::ChunkSize * FGridChunkStore::ChunkSize;
+	auto GetCell = [](int32 Chunk, int32 Cell)
+	{
+		return FGridCoord(Chunk * FGridChunkStore::ChunkSize + Cell / FGridChunkStore::ChunkSize, Cell % FGridChunkStore::ChunkSize);
+	};
+
+	FRandomStream Random(53);
+	TArray<bool> Expected;
+	Expected.SetNumZeroed(NumChunks * CellsPerChunk);
+	int32 NumExpected = 0;
+	for (int32 Index = 0; Index < Expected.Num(); Index++)
+	{
+		Expected[Index] = Random.FRand() < 0.5f;
+		NumExpected += Expected[Index] ? 1 : 0;
+		Store.SetBlocked(GetCell(Index / CellsPerChunk, Index % CellsPerChunk), Expected[Index]);
+	}
+
+	// Every access evicts a changed chunk, the file passes a megabyte many times and is compacted while chunks are paged in
+	for (int32 Round = 0; Round < 400; Round++)
+	{
+		for (int32 Chunk = 0; Chunk < NumChunks; Chunk++)
+		{
+			const int32 Cell = Random.RandHelper(CellsPerChunk);
+			bool& bBlocked = Expected[Chunk * CellsPerChunk + Cell];
+			bBlocked = !bBlocked;
+			NumExpected += bBlocked ? 1 : -1;
+			Store.SetBlocked(GetCell(Chunk, Cell), bBlocked);
+		}
+	}
+	TestTrue(TEXT("Page file is compacted"), Store.GetPageFileSize() <= 1024 * 1024);
+	TestEqual(TEXT("Blocked cells"), Store.GetNumBlocked(), NumExpected);
+	TestEqual(TEXT("Chunks"), Store.GetNumChunks(), NumChunks);
+
+	for (int32 Index = 0; Index < Expected.Num(); Index++)
+	{
+		if (Store.IsBlocked(GetCell(Index / CellsPerChunk, Index % CellsPerChunk)) != Expected[Index])
+		{
+			AddError(FString::Printf(TEXT("Cell %d of chunk %d is wrong after compacting"), Index % CellsPerChunk, Index / CellsPerChunk));
+			break;
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSparseStorageTest, "RTSGrid.GridSystem.SparseStorage", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSparseStorageTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(4));
+
+	Grid->GridDimensions = FGridCoord(16384);
+	Grid->CellLayout = EGridCellLayout::Morton;
+	Grid->bSparseStorage = true;
+	Grid->SparseResidentChunks = 16;
+	Grid->BlockedTiles.Add(FGridCoord(1, 1));
+	Grid->GenerateGrid();
+
+	TestEqual(TEXT("No cell is generated"), Grid->GeneratedGrid.Num(), 0);
+	TestFalse(TEXT("BlockedTiles is read by GenerateGrid"), Grid->IsClearTile(FGridCoord(1, 1)));
+
+	const FGridCoord FarCorner(16383, 16000);
+	TestTrue(TEXT("Far cells are valid"), Grid->IsValidLocation(FarCorner));
+	TestTrue(TEXT("CellIDs of far cells round trip"), Grid->GetCoordinateFromCellID(Grid->GetCellIDFromCoordinate(FarCorner)) == FarCorner);
+
+	Grid->SetTileBlocked(FarCorner, true);
+	TestFalse(TEXT("Blocked far cell"), Grid->IsValidLocation(FarCorner));
+
+	// A wall across the map, through many more chunks than stay in memory
+	Grid->SetRectBlocked(FGridCoord(0, 8000), FGridCoord(16383, 8000), true);
+	TestEqual(TEXT("Wall tiles"), Grid->GetSparseTiles().GetNumBlocked(), 16384 + 2);
+	TestTrue(TEXT("Resident chunks stay in budget"), Grid->GetSparseTiles().GetNumResidentChunks() <= 16);
+	TestFalse(TEXT("Line of sight through the wall"), Grid->HasLineOfSight(FGridCoord(50, 7000), FGridCoord(60, 9000)));
+	TestTrue(TEXT("Line of sight beside the wall"), Grid->HasLineOfSight(FGridCoord(50, 7000), FGridCoord(60, 7900)));
+
+	Grid->UndoTileEdit();
+	TestEqual(TEXT("Undo clears the wall"), Grid->GetSparseTiles().GetNumBlocked(), 2);
+	TestEqual(TEXT("Cleared chunks are freed"), Grid->GetSparseTiles().GetNumChunks(), 2);
+
+	// Features that need every cell refuse instead of answering from dense data that never sees the tiles
+	TestFalse(TEXT("Regions are not labeled"), Grid->AreCellsConnected(FGridCoord(2, 2), FGridCoord(3, 3)));
+	TestEqual(TEXT("Dense occupancy is an empty grid"), Grid->GetOccupancy().GetLayout().GetNumCellIDs(), 0);
+	TestTrue(TEXT("Snapshots read every tile as blocked"), Grid->GetOccupancySnapshot()->IsBlocked(FGridCoord(2, 2)));
+	TestFalse(TEXT("Lockstep does not start"), Grid->StartLockstep(2, 0));
+
+	Grid->FogOfWarPlayers = 1;
+	Grid->AddFogOfWarUnit(0, FGridCoord(2, 2), 4);
+	Grid->UpdateFogOfWar();
+	TestEqual(TEXT("Fog of war is not allocated"), Grid->GetFogOfWar().GetNumPlayers(), 0);
+	TestFalse(TEXT("Nothing is visible"), Grid->IsVisibleToPlayer(0, FGridCoord(2, 2)));
+
+	// Nothing is allocated for every cell of the grid
+	Grid->AddInfluenceSource(TEXT("Threat"), FGridCoord(2, 2), 1.0f);
+	TestNull(TEXT("Influence maps are not created"), Grid->GetInfluenceMap(TEXT("Threat")));
+	Grid->SetTileLayer(TEXT("Road"), FGridCoord(2, 2), true);
+	TestFalse(TEXT("Tile layers are not created"), Grid->IsOnTileLayer(TEXT("Road"), FGridCoord(2, 2)));
+	Grid->BakeBlockedTiles();
+	TestFalse(TEXT("Baking more tiles than stay in memory is refused"), Grid->IsBaking());
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridClearance.h"
+#include "GridOccupancy.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridClearanceValuesTest, "RTSGrid.Clearance.Values", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridClearanceValuesTest::RunTest(const FString& Parameters)
+{
+	const FGridLayout Layout(FGridCoord(10, 8), EGridCellLayout::RowMajor);
+	FGridOccupancy Occupancy;
+	Occupancy.Reset(Layout);
+	Occupancy.SetBlocked(Layout.ToCellID(FGridCoord(5, 4)), true);
+
+	FGridClearance Clearance;
+	Clearance.Reset(Occupancy);
+
+	auto ClearanceAt = [&Clearance, &Layout](int32 Column, int32 Row)
+	{
+		return (int32)Clearance.GetClearance(Layout.ToCellID(FGridCoord(Column, Row)));
+	};
+
+	TestEqual(TEXT("Blocked cell has no clearance"), ClearanceAt(5, 4), 0);
+	TestEqual(TEXT("Last cell touches both edges"), ClearanceAt(9, 7), 1);
+	TestEqual(TEXT("Bounded by the nearest grid edge"), ClearanceAt(6, 5), 3);
+	TestEqual(TEXT("Next to the blocked cell"), ClearanceAt(4, 4), 1);
+	TestEqual(TEXT("Diagonal to the blocked cell"), ClearanceAt(4, 3), 1);
+	TestEqual(TEXT("Two cells before the blocked cell"), ClearanceAt(3, 3), 2);
+	TestEqual(TEXT("Beside the blocked cell"), ClearanceAt(0, 5), 3);
+	TestTrue(TEXT("4x4 fits away from the blocked cell"), Clearance.Fits(Layout.ToCellID(FGridCoord(0, 0)), 4));
+	TestFalse(TEXT("3x3 does not fit over the blocked cell"), Clearance.Fits(Layout.ToCellID(FGridCoord(3, 2)), 3));
+
+	Occupancy.SetBlocked(Layout.ToCellID(FGridCoord(5, 4)), false);
+	Clearance.SetBlocked(FGridCoord(5, 4), false);
+	TestEqual(TEXT("Cleared cell gets its clearance back"), ClearanceAt(3, 3), 5);
+	TestEqual(TEXT("Clearance is bounded by the smaller side"), ClearanceAt(0, 0), 8);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridClearanceRandomTest, "RTSGrid.Clearance.RandomEdits", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridClearanceRandomTest::RunTest(const FString& Parameters)
+{
+	for (const EGridCellLayout CellLayout : { EGridCellLayout::RowMajor, EGridCellLayout::Morton })
+	{
+		const FGridLayout Layout(FGridCoord(61, 47), CellLayout);
+		FGridOccupancy Occupancy;
+		Occupancy.Reset(Layout);
+
+		FGridClearance Clearance;
+		Clearance.Reset(Occupancy);
+
+		FRandomStream Random(9);
+		for (int32 Edit = 0; Edit < 3000; Edit++)
+		{
+			const FGridCoord Coordinate(Random.RandRange(0, 60), Random.RandRange(0, 46));
+			const bool bBlocked = Random.FRand() < 0.4f;
+
+			Occupancy.SetBlocked(Layout.ToCellID(Coordinate), bBlocked);
+			Clearance.SetBlocked(Coordinate, bBlocked);
+
+			if (Edit % 150 == 0)
+			{
+				FGridClearance Rebuilt;
+				Rebuilt.Reset(Occupancy);
+
+				for (int32 Column = 0; Column < 61; Column++)
+				{
+					for (int32 Row = 0; Row < 47; Row++)
+					{
+						const int32 CellID = Layout.ToCellID(FGridCoord(Column, Row));
+						if (Clearance.GetClearance(CellID) != Rebuilt.GetClearance(CellID))
+						{
+							AddError(FString::Printf(TEXT("Clearance of %d, %d is %d, expected %d"), Column, Row, Clearance.GetClearance(CellID), Rebuilt.GetClearance(CellID)));
+							return false;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemFootprintTest, "RTSGrid.GridSystem.Footprint", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemFootprintTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(32));
+
+	TestTrue(TEXT("3x3 fits on an open grid"), Grid->CanFitFootprint(FGridCoord(4, 4), 3));
+	TestFalse(TEXT("3x3 does not fit over the grid edge"), Grid->CanFitFootprint(FGridCoord(30, 4), 3));
+	TestFalse(TEXT("Corner outside the grid does not fit"), Grid->CanFitFootprint(FGridCoord(-1, 4), 1));
+
+	// Updated tile by tile once computed
+	Grid->SetTileBlocked(FGridCoord(6, 6), true);
+	TestFalse(TEXT("3x3 does not fit over a blocked tile"), Grid->CanFitFootprint(FGridCoord(4, 4), 3));
+	TestTrue(TEXT("2x2 fits beside it"), Grid->CanFitFootprint(FGridCoord(4, 4), 2));
+	TestEqual(TEXT("Clearance stops at the blocked tile"), Grid->GetCellClearance(FGridCoord(0, 0)), 6);
+
+	Grid->SetTilesBlocked({ FGridCoord(6, 6) }, false);
+	TestTrue(TEXT("Clearing the tile frees the footprint"), Grid->CanFitFootprint(FGridCoord(4, 4), 3));
+	TestEqual(TEXT("Clearance reaches the grid edge"), Grid->GetCellClearance(FGridCoord(0, 0)), 32);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridCoords.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridCoordConstructionTest, "RTSGrid.Coords.Construction", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridCoordConstructionTest::RunTest(const FString& Parameters)
+{
+	const FGridCoord Zero;
+	TestEqual(TEXT("Default Column"), Zero.Column, 0);
+	TestEqual(TEXT("Default Row"), Zero.Row, 0);
+
+	const FGridCoord Splat(7);
+	TestEqual(TEXT("Splat Column"), Splat.Column, 7);
+	TestEqual(TEXT("Splat Row"), Splat.Row, 7);
+
+	const FGridCoord ColumnRow(3, 5);
+	TestEqual(TEXT("Column"), ColumnRow.Column, 3);
+	TestEqual(TEXT("Row"), ColumnRow.Row, 5);
+
+	// Row is the X component and Column the Y component
+	const FGridCoord FromVector(FVector2D(2.0f, 9.0f));
+	TestEqual(TEXT("Column from Y"), FromVector.Column, 9);
+	TestEqual(TEXT("Row from X"), FromVector.Row, 2);
+
+	const FVector2D ToVector = ColumnRow.ToVector2D();
+	TestEqual(TEXT("ToVector2D X is Row"), ToVector.X, 5.0f);
+	TestEqual(TEXT("ToVector2D Y is Column"), ToVector.Y, 3.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridCoordComparisonTest, "RTSGrid.Coords.Comparison", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridCoordComparisonTest::RunTest(const FString& Parameters)
+{
+	const FGridCoord A(1, 2);
+	const FGridCoord B(3, 4);
+	const FGridCoord Mixed(0, 4);
+
+	TestTrue(TEXT("A == A"), A == FGridCoord(1, 2));
+	TestTrue(TEXT("A != B"), A != B);
+	TestFalse(TEXT("A != A"), A != FGridCoord(1, 2));
+
+	// Ordering operators compare both components, which is what bounds checks rely on
+	TestTrue(TEXT("A < B"), A < B);
+	TestTrue(TEXT("B > A"), B > A);
+	TestTrue(TEXT("A <= A"), A <= A);
+	TestTrue(TEXT("B >= A"), B >= A);
+	TestFalse(TEXT("Mixed < B"), Mixed < B);
+	TestFalse(TEXT("Mixed > A"), Mixed > A);
+	TestFalse(TEXT("Mixed >= A"), Mixed >= A);
+
+	TestTrue(TEXT("Equal coords hash equally"), GetTypeHash(A) == GetTypeHash(FGridCoord(1, 2)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridCoordArithmeticTest, "RTSGrid.Coords.Arithmetic", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridCoordArithmeticTest::RunTest(const FString& Parameters)
+{
+	FGridCoord A(6, 8);
+	FGridCoord B(2, 3);
+
+	TestTrue(TEXT("A + B"), A + B == FGridCoord(8, 11));
+	TestTrue(TEXT("A - B"), A - B == FGridCoord(4, 5));
+	TestTrue(TEXT("A + int"), A + 1 == FGridCoord(7, 9));
+	TestTrue(TEXT("A - int"), A - 1 == FGridCoord(5, 7));
+	TestTrue(TEXT("A * int"), A * 2 == FGridCoord(12, 16));
+	TestTrue(TEXT("A * float"), A * 0.5f == FGridCoord(3, 4));
+	TestTrue(TEXT("A * B"), A * B == FGridCoord(12, 24));
+	TestTrue(TEXT("A / int"), A / 2 == FGridCoord(3, 4));
+	TestTrue(TEXT("A / float"), A / 4.0f == FGridCoord(1, 2));
+
+	// FVector2D operands map X to Row and Y to Column
+	TestTrue(TEXT("A + FVector2D"), A + FVector2D(1.0f, 2.0f) == FGridCoord(8, 9));
+	TestTrue(TEXT("A - FVector2D"), A - FVector2D(1.0f, 2.0f) == FGridCoord(4, 7));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridFogOfWar.h"
+#include "GridOccupancy.h"
+#include "GridTestWorld.h"
+#include "GridSystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridFogOfWarSightTest, "RTSGrid.FogOfWar.Sight", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridFogOfWarSightTest::RunTest(const FString& Parameters)
+{
+	const FGridLayout Layout(FGridCoord(20, 30), EGridCellLayout::RowMajor);
+	FGridFogOfWar FogOfWar;
+	FogOfWar.Reset(Layout, 2);
+
+	const int32 Unit = FogOfWar.AddUnit(0, FGridCoord(10, 10), 3);
+	FogOfWar.Update(nullptr);
+
+	TestTrue(TEXT("Unit cell is visible"), FogOfWar.IsVisible(0, FGridCoord(10, 10)));
+	TestTrue(TEXT("Cell at the sight radius is visible"), FogOfWar.IsVisible(0, FGridCoord(13, 10)));
+	TestFalse(TEXT("Cell past the sight radius is hidden"), FogOfWar.IsVisible(0, FGridCoord(14, 10)));
+	TestFalse(TEXT("Corner outside the sight circle is hidden"), FogOfWar.IsVisible(0, FGridCoord(13, 13)));
+	TestFalse(TEXT("Other players do not see it"), FogOfWar.IsVisible(1, FGridCoord(10, 10)));
+
+	// Overlapping sight is reference counted
+	const int32 Still = FogOfWar.AddUnit(1, FGridCoord(2, 25), 3);
+	FogOfWar.Update(nullptr);
+
+	const int32 Other = FogOfWar.AddUnit(0, FGridCoord(12, 10), 3);
+	FogOfWar.MoveUnit(Unit, FGridCoord(5, 10));
+	FogOfWar.MoveUnit(Still, FGridCoord(2, 25));
+
+	TestEqual(TEXT("Only the moved and added units are updated"), FogOfWar.GetNumDirtyUnits(), 2);
+	FogOfWar.Update(nullptr);
+	TestEqual(TEXT("Update applies every dirty unit"), FogOfWar.GetNumDirtyUnits(), 0);
+	TestTrue(TEXT("Cell seen by the other unit stays visible"), FogOfWar.IsVisible(0, FGridCoord(10, 10)));
+	TestFalse(TEXT("Cell only seen from the old cell is hidden"), FogOfWar.IsVisible(0, FGridCoord(8, 12)));
+	TestTrue(TEXT("Moved unit sees its new cell"), FogOfWar.IsVisible(0, FGridCoord(5, 10)));
+
+	// Only units in sight of a changed cell are invalidated
+	FogOfWar.InvalidateRect(FGridCoord(0, 28), FGridCoord(4, 29));
+	TestEqual(TEXT("Changed cells only seen by one unit invalidate it"), FogOfWar.GetNumDirtyUnits(), 1);
+	FogOfWar.InvalidateRect(FGridCoord(18, 0), FGridCoord(19, 2));
+	TestEqual(TEXT("Changed cells out of sight invalidate nothing"), FogOfWar.GetNumDirtyUnits(), 1);
+	FogOfWar.Update(nullptr);
+
+	FogOfWar.RemoveUnit(Other);
+	FogOfWar.Update(nullptr);
+	TestFalse(TEXT("Removed unit sight is gone"), FogOfWar.IsVisible(0, FGridCoord(12, 10)));
+	TestFalse(TEXT("Removed unit handle is invalid"), FogOfWar.IsValidUnit(Other));
+
+	// Units near the edge only see inside the grid
+	FogOfWar.MoveUnit(Unit, FGridCoord(0, 0));
+	FogOfWar.Update(nullptr);
+	TestTrue(TEXT("Edge unit sees its cell"), FogOfWar.IsVisible(0, FGridCoord(0, 0)));
+	TestFalse(TEXT("Outside of the grid is never visible"), FogOfWar.IsVisible(0, FGridCoord(-1, 0)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridFogOfWarLineOfSightTest, "RTSGrid.FogOfWar.LineOfSight", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridFogOfWarLineOfSightTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(20, 20));
+	Grid->FogOfWarPlayers = 1;
+	Grid->bFogOfWarLineOfSight = true;
+
+	// Wall on Column 12 from Row 5 to Row 15
+	for (int32 Row = 5; Row <= 15; Row++)
+	{
+		Grid->SetTileBlocked(FGridCoord(12, Row), true);
+	}
+
+	Grid->AddFogOfWarUnit(0, FGridCoord(10, 10), 5);
+	Grid->UpdateFogOfWar();
+
+	TestTrue(TEXT("Wall is visible"), Grid->IsVisibleToPlayer(0, FGridCoord(12, 10)));
+	TestFalse(TEXT("Cell behind the wall is hidden"), Grid->IsVisibleToPlayer(0, FGridCoord(14, 10)));
+	TestTrue(TEXT("Cell on the unit side is visible"), Grid->IsVisibleToPlayer(0, FGridCoord(11, 10)));
+
+	// Opening the wall updates the units that can see it
+	Grid->SetTileBlocked(FGridCoord(12, 10), false);
+	Grid->UpdateFogOfWar();
+	TestTrue(TEXT("Cell behind the opening is visible"), Grid->IsVisibleToPlayer(0, FGridCoord(14, 10)));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridInfluenceMap.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridInfluenceMapSpreadTest, "RTSGrid.InfluenceMap.Spread", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridInfluenceMapSpreadTest::RunTest(const FString& Parameters)
+{
+	FGridInfluenceMap InfluenceMap;
+	InfluenceMap.Reset(FGridCoord(20, 13));
+	InfluenceMap.SetKernel(3, 0.5f);
+
+	InfluenceMap.AddSource(FGridCoord(10, 6), 8.0f);
+	InfluenceMap.AddSource(FGridCoord(50, 50), 100.0f);
+	TestTrue(TEXT("Update is scheduled"), InfluenceMap.ScheduleUpdate());
+	TestFalse(TEXT("Only one update runs at a time"), InfluenceMap.ScheduleUpdate());
+	InfluenceMap.Flush();
+
+	TestEqual(TEXT("Source cell"), InfluenceMap.GetInfluence(FGridCoord(10, 6)), 8.0f);
+	TestEqual(TEXT("One Row away"), InfluenceMap.GetInfluence(FGridCoord(10, 7)), 4.0f);
+	TestEqual(TEXT("One Column away"), InfluenceMap.GetInfluence(FGridCoord(9, 6)), 4.0f);
+	TestEqual(TEXT("Diagonal"), InfluenceMap.GetInfluence(FGridCoord(11, 5)), 2.0f);
+	TestEqual(TEXT("At the radius"), InfluenceMap.GetInfluence(FGridCoord(10, 9)), 1.0f);
+	TestEqual(TEXT("Past the radius"), InfluenceMap.GetInfluence(FGridCoord(10, 10)), 0.0f);
+	TestEqual(TEXT("Outside the grid"), InfluenceMap.GetInfluence(FGridCoord(-1, 6)), 0.0f);
+
+	// Sources of a grid edge are not reflected back
+	InfluenceMap.AddSource(FGridCoord(0, 0), 1.0f);
+	InfluenceMap.ScheduleUpdate();
+	InfluenceMap.Flush();
+	TestEqual(TEXT("Edge source"), InfluenceMap.GetInfluence(FGridCoord(0, 0)), 1.0f);
+	TestEqual(TEXT("Previous sources are gone"), InfluenceMap.GetInfluence(FGridCoord(10, 6)), 0.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridInfluenceMapDoubleBufferTest, "RTSGrid.InfluenceMap.DoubleBuffer", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridInfluenceMapDoubleBufferTest::RunTest(const FString& Parameters)
+{
+	FGridInfluenceMap InfluenceMap;
+	InfluenceMap.Reset(FGridCoord(8, 8));
+	InfluenceMap.SetKernel(1, 0.5f);
+
+	InfluenceMap.AddSource(FGridCoord(4, 4), 1.0f);
+	InfluenceMap.Tick(0.1f, 0.5f);
+	TestFalse(TEXT("Nothing scheduled before the interval"), InfluenceMap.IsUpdating());
+	TestEqual(TEXT("Readers see the previous result"), InfluenceMap.GetInfluence(FGridCoord(4, 4)), 0.0f);
+
+	InfluenceMap.Tick(0.5f, 0.5f);
+	TestEqual(TEXT("Readers see the previous result while updating"), InfluenceMap.GetInfluence(FGridCoord(4, 4)), 0.0f);
+
+	InfluenceMap.Flush();
+	TestEqual(TEXT("Readers see the new result once flipped"), InfluenceMap.GetInfluence(FGridCoord(4, 4)), 1.0f);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
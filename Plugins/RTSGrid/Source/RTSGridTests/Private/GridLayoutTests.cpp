@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridLayout.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridLayoutRoundTripTest, "RTSGrid.Layout.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridLayoutRoundTripTest::RunTest(const FString& Parameters)
+{
+	const FGridCoord Dimensions[] = { FGridCoord(4), FGridCoord(3, 5), FGridCoord(7, 2), FGridCoord(5, 16), FGridCoord(1, 9), FGridCoord(37, 21) };
+	const EGridCellLayout Layouts[] = { EGridCellLayout::RowMajor, EGridCellLayout::PowerOfTwo, EGridCellLayout::Morton };
+
+	for (const EGridCellLayout CellLayout : Layouts)
+	{
+		for (const FGridCoord& Dimension : Dimensions)
+		{
+			const FGridLayout Layout(Dimension, CellLayout);
+			const FString Context = FString::Printf(TEXT("[Layout %d, %d x %d]"), (int32)CellLayout, Dimension.Column, Dimension.Row);
+
+			TestEqual(Context + TEXT(" NumCells"), Layout.GetNumCells(), Dimension.Column * Dimension.Row);
+			TestTrue(Context + TEXT(" NumCellIDs covers every cell"), Layout.GetNumCellIDs() >= Layout.GetNumCells());
+
+			TSet<int32> SeenIDs;
+			for (int32 Column = 0; Column < Dimension.Column; Column++)
+			{
+				for (int32 Row = 0; Row < Dimension.Row; Row++)
+				{
+					const FGridCoord Coord(Column, Row);
+					const int32 ID = Layout.ToCellID(Coord);
+
+					TestTrue(Context + TEXT(" CellID in range"), ID >= 0 && ID < Layout.GetNumCellIDs());
+					TestTrue(Context + TEXT(" CellID round trip"), Layout.ToCoordinate(ID) == Coord);
+					TestFalse(Context + TEXT(" CellID is unique"), SeenIDs.Contains(ID));
+					SeenIDs.Add(ID);
+
+					if (Column + 1 < Dimension.Column && Row + 1 < Dimension.Row)
+					{
+						TestEqual(Context + TEXT(" Diagonal neighbour"), Layout.GetNeighborCellID(ID, 1, 1), Layout.ToCellID(FGridCoord(Column + 1, Row + 1)));
+						TestTrue(Context + TEXT(" FGridCoord dispatches on the layout"), Coord.ToCellID(Layout) == ID && FGridCoord::FromCellID(ID, Layout) == Coord);
+					}
+				}
+			}
+		}
+	}
+
+	// The padded layout only uses shifts and masks
+	const FGridLayout Padded(FGridCoord(3, 5), EGridCellLayout::PowerOfTwo);
+	TestEqual(TEXT("Padded stride"), Padded.ColumnStride, 8);
+	TestEqual(TEXT("Padded NumCellIDs"), Padded.GetNumCellIDs(), 24);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridMortonLayoutTest, "RTSGrid.Layout.Morton", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridMortonLayoutTest::RunTest(const FString& Parameters)
+{
+	const FGridLayout Layout(FGridCoord(40, 20), EGridCellLayout::Morton);
+	const int32 TileSize = FGridLayout::MortonTileSize;
+	const int32 CellsPerTile = TileSize * TileSize;
+
+	// 3 Columns of tiles, 2 tiles per Column of tiles
+	TestEqual(TEXT("NumCellIDs"), Layout.GetNumCellIDs(), 3 * 2 * CellsPerTile);
+
+	// Z-order inside a tile
+	TestEqual(TEXT("(0, 1) follows (0, 0)"), Layout.ToCellID(FGridCoord(0, 1)), 1);
+	TestEqual(TEXT("(1, 0) is next in Z-order"), Layout.ToCellID(FGridCoord(1, 0)), 2);
+	TestEqual(TEXT("(1, 1) closes the first Z"), Layout.ToCellID(FGridCoord(1, 1)), 3);
+
+	// Every cell of a tile is in one contiguous block of IDs
+	for (int32 TileColumn = 0; TileColumn < 2; TileColumn++)
+	{
+		for (int32 TileRow = 0; TileRow < 2; TileRow++)
+		{
+			const int32 FirstID = Layout.ToCellID(FGridCoord(TileColumn * TileSize, TileRow * TileSize));
+			TestEqual(TEXT("Tile starts on a tile boundary"), FirstID % CellsPerTile, 0);
+
+			for (int32 Local = 0; Local < CellsPerTile; Local++)
+			{
+				const FGridCoord LocalCoord = FGridLayout::MortonDecode(Local);
+				const int32 ID = Layout.ToCellID(FGridCoord(TileColumn * TileSize + LocalCoord.Column, TileRow * TileSize + LocalCoord.Row));
+				if (!TestEqual(TEXT("Tile is contiguous"), ID, FirstID + Local))
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridStaticLayoutTest, "RTSGrid.Layout.Static", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridStaticLayoutTest::RunTest(const FString& Parameters)
+{
+	using FLayout = TStaticGridLayout<3, 2>;
+	const FGridLayout Dynamic(FGridCoord(FLayout::NumColumns, FLayout::NumRows), EGridCellLayout::PowerOfTwo);
+
+	TestEqual(TEXT("NumCells"), FLayout::NumCells, 32);
+
+	for (int32 ID = 0; ID < FLayout::NumCells; ID++)
+	{
+		const FGridCoord Coord = FLayout::ToCoordinate(ID);
+		TestTrue(TEXT("Static layout matches the dynamic one"), Coord == Dynamic.ToCoordinate(ID));
+		TestEqual(TEXT("Static round trip"), FLayout::ToCellID(Coord), ID);
+		TestTrue(TEXT("Static bounds"), FLayout::IsInBounds(Coord));
+	}
+
+	TestFalse(TEXT("Negative Row is out of bounds"), FLayout::IsInBounds(FGridCoord(0, -1)));
+	TestFalse(TEXT("Row past the end is out of bounds"), FLayout::IsInBounds(FGridCoord(0, FLayout::NumRows)));
+	TestEqual(TEXT("Neighbor offset"), FLayout::GetNeighborOffset(-1, 1), -FLayout::NumRows + 1);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridLineOfSight.h"
+#include "GridOccupancy.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridLineWalkTest, "RTSGrid.LineOfSight.LineWalk", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridLineWalkTest::RunTest(const FString& Parameters)
+{
+	TArray<FGridCoord> Cells;
+	auto Collect = [&Cells](const FGridCoord& Cell)
+	{
+		Cells.Add(Cell);
+		return true;
+	};
+
+	FGridLineOfSight::ForEachCellOnLine(FGridCoord(2, 3), FGridCoord(2, 3), Collect);
+	TestEqual(TEXT("Single cell line"), Cells.Num(), 1);
+
+	Cells.Reset();
+	FGridLineOfSight::ForEachCellOnLine(FGridCoord(0, 0), FGridCoord(4, 2), Collect);
+	TestEqual(TEXT("Line length is the longest axis plus one"), Cells.Num(), 5);
+	TestTrue(TEXT("Line starts at From"), Cells[0] == FGridCoord(0, 0));
+	TestTrue(TEXT("Line ends at To"), Cells.Last() == FGridCoord(4, 2));
+
+	for (int32 Index = 1; Index < Cells.Num(); Index++)
+	{
+		const FGridCoord& A = Cells[Index - 1];
+		const FGridCoord& B = Cells[Index];
+		TestTrue(TEXT("Consecutive cells touch"), FMath::Abs(A.Column - B.Column) <= 1 && FMath::Abs(A.Row - B.Row) <= 1);
+	}
+
+	Cells.Reset();
+	const bool bReachedEnd = FGridLineOfSight::ForEachCellOnLine(FGridCoord(0, 0), FGridCoord(0, 9), [&Cells](const FGridCoord& Cell)
+	{
+		Cells.Add(Cell);
+		return Cell.Row < 3;
+	});
+	TestFalse(TEXT("Stopped walk does not reach To"), bReachedEnd);
+	TestEqual(TEXT("Walk stops at the visitor"), Cells.Num(), 4);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridLineOfSightQueryTest, "RTSGrid.LineOfSight.Queries", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridLineOfSightQueryTest::RunTest(const FString& Parameters)
+{
+	const FGridLayout Layout(FGridCoord(32, 32), EGridCellLayout::Morton);
+	FGridOccupancy Occupancy;
+	Occupancy.Reset(Layout);
+
+	// Wall on Row 10 from Column 5 to Column 15
+	for (int32 Column = 5; Column <= 15; Column++)
+	{
+		Occupancy.SetBlocked(Layout.ToCellID(FGridCoord(Column, 10)), true);
+	}
+
+	TestTrue(TEXT("Clear line"), FGridLineOfSight::HasLineOfSight(Occupancy, FGridCoord(10, 2), FGridCoord(10, 8)));
+	TestFalse(TEXT("Line through the wall"), FGridLineOfSight::HasLineOfSight(Occupancy, FGridCoord(10, 2), FGridCoord(10, 20)));
+	TestTrue(TEXT("Line around the wall"), FGridLineOfSight::HasLineOfSight(Occupancy, FGridCoord(20, 2), FGridCoord(20, 20)));
+	TestTrue(TEXT("End cells are not checked"), FGridLineOfSight::HasLineOfSight(Occupancy, FGridCoord(10, 10), FGridCoord(10, 2)));
+	TestFalse(TEXT("Lines leaving the grid are blocked"), FGridLineOfSight::HasLineOfSight(Occupancy, FGridCoord(0, 0), FGridCoord(-5, 3)));
+
+	// The batch gives the same answers as single queries
+	TArray<FGridLineQuery> Queries;
+	FRandomStream Random(5);
+	for (int32 Index = 0; Index < 1000; Index++)
+	{
+		Queries.Add(FGridLineQuery(FGridCoord(Random.RandRange(0, 31), Random.RandRange(0, 31)), FGridCoord(Random.RandRange(0, 31), Random.RandRange(0, 31))));
+	}
+
+	TArray<bool> Results;
+	Results.SetNumUninitialized(Queries.Num());
+	FGridLineOfSight::HasLineOfSightBatch(Occupancy, Queries, Results);
+
+	for (int32 Index = 0; Index < Queries.Num(); Index++)
+	{
+		if (!TestTrue(TEXT("Batch matches single query"), Results[Index] == FGridLineOfSight::HasLineOfSight(Occupancy, Queries[Index].From, Queries[Index].To)))
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BuildingBase.h"
+#include "GridLockstep.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridLockstepPacketsTest, "RTSGrid.Lockstep.Packets", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridLockstepPacketsTest::RunTest(const FString& Parameters)
+{
+	FGridLockstep Peers[2];
+	Peers[0].Reset(2, 0, 2);
+	Peers[1].Reset(2, 1, 2);
+
+	TestTrue(TEXT("Ticks before the input delay need no commands"), Peers[0].IsTickReady());
+	TArray<FGridLockstepCommand> Commands;
+	TestTrue(TEXT("Tick 0 is applied empty"), Peers[0].PopTick(Commands) && Commands.Num() == 0);
+	TestTrue(TEXT("Tick 1 is applied empty"), Peers[0].PopTick(Commands) && Commands.Num() == 0);
+	TestFalse(TEXT("Tick 2 waits for the other peer"), Peers[0].IsTickReady());
+
+	// Both peers place on the same tick, peer 1 issues first but peer 0 is applied first everywhere
+	TArray<uint8> Packets[2];
+	Peers[1].QueueLocal(0, 300000);
+	TestTrue(TEXT("Peer 1 sends tick 2"), Peers[1].WriteLocalPacket(Packets[1]));
+	TArray<uint8> Ahead;
+	TestFalse(TEXT("Peer 1 does not run further ahead of tick 0 than the input delay"), Peers[1].WriteLocalPacket(Ahead));
+	TestEqual(TEXT("Nothing is written then"), Ahead.Num(), 0);
+	Peers[0].QueueLocal(1, 5);
+	Peers[0].QueueLocal(0, 6);
+	Peers[0].WriteLocalPacket(Packets[0]);
+
+	TestTrue(TEXT("A tick with one placement takes a few bytes"), Packets[1].Num() <= 8);
+	TestTrue(TEXT("Peer 0 packet is accepted"), Peers[1].ReceivePacket(Packets[0]));
+	TestFalse(TEXT("Duplicate packet is refused"), Peers[1].ReceivePacket(Packets[0]));
+	TestFalse(TEXT("Truncated packet is refused"), Peers[0].ReceivePacket(TArrayView<const uint8>(Packets[1].GetData(), Packets[1].Num() - 1)));
+	TestTrue(TEXT("Peer 1 packet is accepted"), Peers[0].ReceivePacket(Packets[1]));
+
+	Peers[1].PopTick(Commands);
+	Peers[1].PopTick(Commands);
+	for (FGridLockstep& Peer : Peers)
+	{
+		TestTrue(TEXT("Tick 2 is ready on both peers"), Peer.PopTick(Commands));
+		TestEqual(TEXT("Every command of the tick"), Commands.Num(), 3);
+		if (Commands.Num() == 3)
+		{
+			TestTrue(TEXT("Peer 0 first, in issue order"), Commands[0].Peer == 0 && Commands[0].CellID == 5 && Commands[1].CellID == 6);
+			TestTrue(TEXT("Peer 1 last"), Commands[2].Peer == 1 && Commands[2].BuildingType == 0 && Commands[2].CellID == 300000);
+		}
+	}
+
+	TestFalse(TEXT("Packet of an applied tick is refused"), Peers[0].ReceivePacket(Packets[1]));
+
+	// The next packets carry the checksum of tick 2
+	Peers[0].RecordChecksum(2, 1234);
+	Peers[1].RecordChecksum(2, 4321);
+	Peers[0].WriteLocalPacket(Packets[0]);
+	TestTrue(TEXT("Packet with a checksum is accepted"), Peers[1].ReceivePacket(Packets[0]));
+	TestEqual(TEXT("Different checksums are a desync"), Peers[1].GetDesyncTick(), 2);
+	TestFalse(TEXT("The sender does not know yet"), Peers[0].HasDesynced());
+
+	// Peer, tick, no checksum, no command. Peer 1 is at tick 3, peer 0 cannot send past 3 + 2 * 2 + 1
+	const uint8 FurthestPacket[] = { 0, 8, 0, 0 };
+	const uint8 TooFarPacket[] = { 0, 9, 0, 0 };
+	TestTrue(TEXT("Packet as far ahead as a peer can be is accepted"), Peers[1].ReceivePacket(MakeArrayView(FurthestPacket)));
+	TestFalse(TEXT("Packet further ahead is refused"), Peers[1].ReceivePacket(MakeArrayView(TooFarPacket)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridLockstepTwoPeersTest, "RTSGrid.Lockstep.TwoPeers", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridLockstepTwoPeersTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+
+	// Footprints of 2x2 so placements of both peers overlap, put back at the end
+	ABuildingBase* Defaults = GetMutableDefault<ABuildingBase>();
+	const int32 SavedFootprintSize = Defaults->FootprintSize;
+	Defaults->FootprintSize = 2;
+
+	const TSubclassOf<ABuildingBase> BuildingType = ABuildingBase::StaticClass();
+	AGridSystem* Grids[2];
+	for (int32 Peer = 0; Peer < 2; Peer++)
+	{
+		Grids[Peer] = TestWorld.SpawnGrid(FGridCoord(24, 20));
+		Grids[Peer]->LockstepBuildingTypes.Add(BuildingType);
+		Grids[Peer]->bLockstepSpawnBuildings = false;
+		TestTrue(TEXT("Lockstep starts"), Grids[Peer]->StartLockstep(2, Peer));
+	}
+
+	struct FInFlightPacket
+	{
+		int32 DeliveryFrame;
+		int32 To;
+		TArray<uint8> Packet;
+	};
+	TArray<FInFlightPacket> InFlight;
+
+	FRandomStream Random(47);
+	const int32 NumFrames = 300;
+	int32 NumQueued = 0;
+	int32 NumPackets[2] = { 0, 0 };
+	int32 NumPlacementPackets = 0;
+	bool bPlacementQueued[2] = { false, false };
+	int64 NumBytes = 0;
+	int64 PlacementPacketBytes = 0;
+	int64 EmptyPacketBytes = 0;
+
+	// Packets take 0 to 3 frames, past the input delay a peer waits for them and sends nothing
+	for (int32 Frame = 0; InFlight.Num() > 0 || Frame < NumFrames; Frame++)
+	{
+		for (int32 Peer = 0; Peer < 2 && Frame < NumFrames; Peer++)
+		{
+			if (Random.FRand() < 0.4f)
+			{
+				const FGridCoord Coordinate(Random.RandRange(0, 22), Random.RandRange(0, 18));
+				const bool bQueued = Grids[Peer]->QueueLockstepPlacement(BuildingType, Coordinate);
+				bPlacementQueued[Peer] |= bQueued;
+				NumQueued += bQueued ? 1 : 0;
+			}
+
+			TArray<uint8> Packet = Grids[Peer]->WriteLockstepPacket();
+			if (Packet.Num() == 0)
+			{
+				continue;
+			}
+
+			NumPackets[Peer]++;
+			NumBytes += Packet.Num();
+			NumPlacementPackets += bPlacementQueued[Peer] ? 1 : 0;
+			(bPlacementQueued[Peer] ? PlacementPacketBytes : EmptyPacketBytes) += Packet.Num();
+			bPlacementQueued[Peer] = false;
+
+			FInFlightPacket& Sent = InFlight.AddDefaulted_GetRef();
+			Sent.DeliveryFrame = Frame + Random.RandRange(0, 3);
+			Sent.To = 1 - Peer;
+			Sent.Packet = MoveTemp(Packet);
+		}
+
+		for (int32 Index = InFlight.Num() - 1; Index >= 0; Index--)
+		{
+			if (InFlight[Index].DeliveryFrame <= Frame)
+			{
+				TestTrue(TEXT("Packet is accepted"), Grids[InFlight[Index].To]->ReceiveLockstepPacket(InFlight[Index].Packet));
+				InFlight.RemoveAt(Index);
+			}
+		}
+
+		for (AGridSystem* Grid : Grids)
+		{
+			Grid->AdvanceLockstep();
+		}
+	}
+
+	TestTrue(TEXT("Late packets hold a peer back"), NumPackets[0] < NumFrames || NumPackets[1] < NumFrames);
+	TestEqual(TEXT("Both peers applied every tick both sent"), Grids[0]->GetLockstepTick(), FMath::Min(NumPackets[0], NumPackets[1]) + Grids[0]->LockstepInputDelay);
+	TestEqual(TEXT("Same tick on both peers"), Grids[1]->GetLockstepTick(), Grids[0]->GetLockstepTick());
+	TestFalse(TEXT("Peer 0 stayed in sync"), Grids[0]->HasLockstepDesynced());
+	TestFalse(TEXT("Peer 1 stayed in sync"), Grids[1]->HasLockstepDesynced());
+
+	// Undoing would only change one peer, lockstep placements are not journaled and undo does nothing while lockstep runs
+	const int32 NumBlockedTiles = Grids[0]->BlockedTiles.Num();
+	TestFalse(TEXT("Nothing to undo while lockstep runs"), Grids[0]->CanUndoTileEdit());
+	Grids[0]->UndoTileEdit();
+	TestEqual(TEXT("Undo keeps the synchronized placements"), Grids[0]->BlockedTiles.Num(), NumBlockedTiles);
+	Grids[0]->StopLockstep();
+	TestFalse(TEXT("Lockstep placements cannot be undone afterwards"), Grids[0]->CanUndoTileEdit());
+	Grids[0]->StartLockstep(2, 0);
+
+	TestEqual(TEXT("Same checksum"), Grids[0]->GetOccupancyChecksum(), Grids[1]->GetOccupancyChecksum());
+	TestEqual(TEXT("Same blocked tiles"), Grids[0]->BlockedTiles.Num(), Grids[1]->BlockedTiles.Num());
+	TestTrue(TEXT("Placements were made"), Grids[0]->BlockedTiles.Num() > 0 && Grids[0]->BlockedTiles.Num() <= NumQueued * 4);
+	for (const FGridCoord& Tile : Grids[0]->BlockedTiles)
+	{
+		if (!Grids[1]->BlockedTiles.Contains(Tile))
+		{
+			AddError(FString::Printf(TEXT("Tile %d, %d is only blocked on peer 0"), Tile.Column, Tile.Row));
+			break;
+		}
+	}
+
+	// An empty tick costs a few bytes, every placement only a few more
+	const double EmptyPacketSize = (double)EmptyPacketBytes / FMath::Max(NumPackets[0] + NumPackets[1] - NumPlacementPackets, 1);
+	const double BytesPerPlacement = (PlacementPacketBytes - NumPlacementPackets * EmptyPacketSize) / FMath::Max(NumQueued, 1);
+	AddInfo(FString::Printf(TEXT("%lld bytes for %d placements over %d ticks"), NumBytes, NumQueued, NumFrames));
+	TestTrue(TEXT("A placement costs a few bytes"), BytesPerPlacement <= 4.0);
+
+	// A tile changed outside the stream shows up in the checksums
+	for (int32 Peer = 0; Peer < 2; Peer++)
+	{
+		Grids[Peer]->StartLockstep(2, Peer);
+	}
+	Grids[1]->SetTileBlocked(FGridCoord(23, 19), !Grids[1]->BlockedTiles.Contains(FGridCoord(23, 19)));
+
+	AddExpectedError(TEXT("desynced from the other lockstep peers"), EAutomationExpectedErrorFlags::Contains, 2);
+	for (int32 Frame = 0; Frame < 4; Frame++)
+	{
+		const TArray<uint8> Packet0 = Grids[0]->WriteLockstepPacket();
+		const TArray<uint8> Packet1 = Grids[1]->WriteLockstepPacket();
+		Grids[1]->ReceiveLockstepPacket(Packet0);
+		Grids[0]->ReceiveLockstepPacket(Packet1);
+		Grids[0]->AdvanceLockstep();
+		Grids[1]->AdvanceLockstep();
+	}
+	TestTrue(TEXT("Peer 0 sees the desync"), Grids[0]->HasLockstepDesynced());
+	TestTrue(TEXT("Peer 1 sees the desync"), Grids[1]->HasLockstepDesynced());
+
+	// Tile layers are not synchronized, only the peer that queues a placement checks the rules reading them
+	const TArray<FGridPlacementRule> SavedRules = Defaults->PlacementRules;
+	FGridPlacementRule NearRoad;
+	NearRoad.Type = EGridPlacementRule::NearLayer;
+	NearRoad.Layer = TEXT("Road");
+	NearRoad.Distance = 1;
+	Defaults->PlacementRules = { NearRoad };
+
+	AGridSystem* RoadGrids[2];
+	for (int32 Peer = 0; Peer < 2; Peer++)
+	{
+		RoadGrids[Peer] = TestWorld.SpawnGrid(FGridCoord(8));
+		RoadGrids[Peer]->LockstepBuildingTypes.Add(BuildingType);
+		RoadGrids[Peer]->bLockstepSpawnBuildings = false;
+		RoadGrids[Peer]->StartLockstep(2, Peer);
+	}
+
+	RoadGrids[0]->SetTileLayer(TEXT("Road"), FGridCoord(2, 4), true);
+	TestTrue(TEXT("Peer 0 has a road next to the footprint"), RoadGrids[0]->QueueLockstepPlacement(BuildingType, FGridCoord(2, 2)));
+	TestFalse(TEXT("Peer 1 has no road"), RoadGrids[1]->IsValidPlacement(BuildingType, FGridCoord(2, 2)));
+	for (int32 Frame = 0; Frame < 4; Frame++)
+	{
+		const TArray<uint8> Packet0 = RoadGrids[0]->WriteLockstepPacket();
+		const TArray<uint8> Packet1 = RoadGrids[1]->WriteLockstepPacket();
+		RoadGrids[1]->ReceiveLockstepPacket(Packet0);
+		RoadGrids[0]->ReceiveLockstepPacket(Packet1);
+		RoadGrids[0]->AdvanceLockstep();
+		RoadGrids[1]->AdvanceLockstep();
+	}
+	TestFalse(TEXT("Placed on peer 0"), RoadGrids[0]->IsClearTile(FGridCoord(3, 3)));
+	TestFalse(TEXT("Placed on peer 1 all the same"), RoadGrids[1]->IsClearTile(FGridCoord(3, 3)));
+	TestFalse(TEXT("Peers stay in sync"), RoadGrids[0]->HasLockstepDesynced() || RoadGrids[1]->HasLockstepDesynced());
+
+	Defaults->PlacementRules = SavedRules;
+	Defaults->FootprintSize = SavedFootprintSize;
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
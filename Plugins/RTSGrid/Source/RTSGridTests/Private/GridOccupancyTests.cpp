@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Async/ParallelFor.h"
+#include "GridOccupancy.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridOccupancyCopyOnWriteTest, "RTSGrid.Occupancy.CopyOnWrite", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridOccupancyCopyOnWriteTest::RunTest(const FString& Parameters)
+{
+	const FGridLayout Layout(FGridCoord(256, 256), EGridCellLayout::Morton);
+	FGridOccupancy Occupancy;
+	Occupancy.Reset(Layout);
+
+	TestEqual(TEXT("Chunks cover the grid"), Occupancy.GetNumChunks(), 256 * 256 / FGridOccupancy::CellsPerChunk);
+	TestTrue(TEXT("A cleared occupancy only allocates its chunk table"), Occupancy.GetAllocatedSize() < sizeof(FGridOccupancy::FChunk));
+
+	const int32 CellID = Layout.ToCellID(FGridCoord(3, 4));
+	TestTrue(TEXT("Blocking a cell changes it"), Occupancy.SetBlocked(CellID, true));
+	TestFalse(TEXT("Blocking it again does not"), Occupancy.SetBlocked(CellID, true));
+
+	const FGridOccupancy Snapshot = Occupancy;
+	for (int32 ChunkIndex = 0; ChunkIndex < Occupancy.GetNumChunks(); ChunkIndex++)
+	{
+		TestTrue(TEXT("Copies share every chunk"), Occupancy.SharesChunk(Snapshot, ChunkIndex));
+	}
+
+	Occupancy.SetBlocked(CellID, false);
+	Occupancy.SetBlocked(Layout.ToCellID(FGridCoord(3, 5)), true);
+
+	TestTrue(TEXT("Snapshot keeps the old value"), Snapshot.IsBlocked(CellID));
+	TestFalse(TEXT("Snapshot does not see new writes"), Snapshot.IsBlocked(FGridCoord(3, 5)));
+	TestEqual(TEXT("Snapshot keeps its count"), Snapshot.GetNumBlocked(), 1);
+	TestFalse(TEXT("Occupancy sees its writes"), Occupancy.IsBlocked(CellID));
+	TestTrue(TEXT("Occupancy sees its writes"), Occupancy.IsBlocked(FGridCoord(3, 5)));
+
+	int32 NumCopied = 0;
+	for (int32 ChunkIndex = 0; ChunkIndex < Occupancy.GetNumChunks(); ChunkIndex++)
+	{
+		NumCopied += Occupancy.SharesChunk(Snapshot, ChunkIndex) ? 0 : 1;
+	}
+	TestEqual(TEXT("Only the written chunk is copied"), NumCopied, 1);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridOccupancySnapshotTest, "RTSGrid.Occupancy.Snapshot", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridOccupancySnapshotTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(128));
+
+	Grid->SetTileBlocked(FGridCoord(10, 10), true);
+	FGridOccupancySnapshotRef Snapshot = Grid->GetOccupancySnapshot();
+	TestTrue(TEXT("First snapshot is published on demand"), Snapshot->IsBlocked(FGridCoord(10, 10)));
+
+	Grid->SetTileBlocked(FGridCoord(20, 20), true);
+	TestTrue(TEXT("Snapshot is kept until the next publish"), Grid->GetOccupancySnapshot() == Snapshot);
+	TestFalse(TEXT("Published snapshot does not change"), Snapshot->IsBlocked(FGridCoord(20, 20)));
+
+	// A worker keeps reading the old snapshot while the game thread publishes new ones
+	TArray<int32> NumBlockedSeen;
+	NumBlockedSeen.SetNumZeroed(64);
+	ParallelFor(NumBlockedSeen.Num(), [&Snapshot, &NumBlockedSeen](int32 Index)
+	{
+		for (int32 CellID = 0; CellID < Snapshot->GetLayout().GetNumCellIDs(); CellID++)
+		{
+			NumBlockedSeen[Index] += Snapshot->IsBlocked(CellID) ? 1 : 0;
+		}
+	});
+	for (int32 NumBlocked : NumBlockedSeen)
+	{
+		TestEqual(TEXT("Readers see a consistent snapshot"), NumBlocked, 1);
+	}
+
+	Grid->PublishOccupancySnapshot();
+	FGridOccupancySnapshotRef Published = Grid->GetOccupancySnapshot();
+	TestTrue(TEXT("Publishing after a change makes a new snapshot"), Published != Snapshot);
+	TestTrue(TEXT("New snapshot sees the change"), Published->IsBlocked(FGridCoord(20, 20)));
+	TestEqual(TEXT("New snapshot has both cells"), Published->GetNumBlocked(), 2);
+
+	Grid->PublishOccupancySnapshot();
+	TestTrue(TEXT("Publishing without changes keeps the snapshot"), Grid->GetOccupancySnapshot() == Published);
+
+	// Once no reader holds the older snapshot, it is brought up to date rather than copied
+	const FGridOccupancy* Older = &Snapshot.Get();
+	Snapshot = Published;
+
+	Grid->SetTileBlocked(FGridCoord(100, 100), true);
+	Grid->PublishOccupancySnapshot();
+	FGridOccupancySnapshotRef Reused = Grid->GetOccupancySnapshot();
+	TestTrue(TEXT("Snapshot no reader holds is published again"), &Reused.Get() == Older);
+	TestTrue(TEXT("Reused snapshot sees the changes before the last publish"), Reused->IsBlocked(FGridCoord(20, 20)));
+	TestTrue(TEXT("Reused snapshot sees the changes since"), Reused->IsBlocked(FGridCoord(100, 100)));
+	TestEqual(TEXT("Reused snapshot has every cell"), Reused->GetNumBlocked(), 3);
+	TestEqual(TEXT("Reused snapshot has the checksum of the occupancy"), Reused->GetChecksum(), Grid->GetOccupancy().GetChecksum());
+	TestFalse(TEXT("Snapshot a reader holds does not change"), Published->IsBlocked(FGridCoord(100, 100)));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GridPlacementJournal.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridJournalRunsTest, "RTSGrid.Journal.Runs", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridJournalRunsTest::RunTest(const FString& Parameters)
+{
+	FGridPlacementJournal Journal;
+	TArray<TWeakObjectPtr<AActor>> DiscardedActors;
+
+	Journal.BeginOp();
+	for (int32 CellID = 100; CellID < 1100; CellID++)
+	{
+		Journal.Record(CellID, false);
+	}
+	Journal.Record(5000, false);
+	Journal.Record(5001, true);
+	Journal.EndOp(DiscardedActors);
+
+	TestEqual(TEXT("One edit"), Journal.GetNumOps(), 1);
+	TestTrue(TEXT("Edit can be undone"), Journal.CanUndo());
+	TestFalse(TEXT("Nothing to redo"), Journal.CanRedo());
+
+	const FGridJournalOp* Op = Journal.Undo();
+	if (!TestNotNull(TEXT("Undo returns the edit"), Op))
+	{
+		return false;
+	}
+
+	TArrayView<const FGridJournalRun> Runs = Journal.GetRuns(*Op);
+	TestEqual(TEXT("Consecutive cells with the same flag merge"), Runs.Num(), 3);
+	TestEqual(TEXT("First run covers the wall"), Runs[0].NumCells, 1000);
+	TestTrue(TEXT("Runs keep the previous flag"), Runs[2].bWasBlocked);
+	TestTrue(TEXT("Undone edit can be redone"), Journal.CanRedo());
+	TestTrue(TEXT("Redo returns the same edit"), Journal.Redo() == Op);
+
+	Journal.BeginOp();
+	Journal.EndOp(DiscardedActors);
+	TestEqual(TEXT("Empty edits are dropped"), Journal.GetNumOps(), 1);
+
+	Journal.SetMaxOps(2);
+	for (int32 Index = 0; Index < 4; Index++)
+	{
+		Journal.BeginOp();
+		Journal.Record(Index, false);
+		Journal.EndOp(DiscardedActors);
+	}
+	TestEqual(TEXT("Oldest edits are dropped"), Journal.GetNumOps(), 2);
+	TestEqual(TEXT("Newest edit is kept"), Journal.GetRuns(*Journal.Undo())[0].FirstCellID, 3);
+	TestEqual(TEXT("Runs follow the dropped edits"), Journal.GetRuns(*Journal.Undo())[0].FirstCellID, 2);
+	TestFalse(TEXT("Nothing older to undo"), Journal.CanUndo());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridJournalUndoRedoTest, "RTSGrid.Journal.UndoRedo", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridJournalUndoRedoTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(64));
+
+	Grid->SetTileBlocked(FGridCoord(10, 5), true);
+
+	// A wall over an already blocked tile, only the changed tiles are undone
+	Grid->SetRectBlocked(FGridCoord(10, 0), FGridCoord(10, 63), true);
+	TestEqual(TEXT("Wall is blocked"), Grid->BlockedTiles.Num(), 64);
+
+	Grid->UndoTileEdit();
+	TestEqual(TEXT("Undo clears the wall"), Grid->BlockedTiles.Num(), 1);
+	TestFalse(TEXT("Undo clears the wall"), Grid->IsClearTile(FGridCoord(10, 5)));
+	TestFalse(TEXT("Occupancy follows the undo"), Grid->GetOccupancy().IsBlocked(FGridCoord(10, 6)));
+
+	Grid->RedoTileEdit();
+	TestEqual(TEXT("Redo blocks the wall again"), Grid->BlockedTiles.Num(), 64);
+	TestTrue(TEXT("Occupancy follows the redo"), Grid->GetOccupancy().IsBlocked(FGridCoord(10, 6)));
+
+	AActor* Building = TestWorld.GetWorld()->SpawnActor<AActor>();
+	Grid->SetTilesBlocked({ FGridCoord(20, 20), FGridCoord(20, 21), FGridCoord(-1, 0) }, true, Building);
+	TestEqual(TEXT("Tiles outside the grid are ignored"), Grid->BlockedTiles.Num(), 66);
+
+	Grid->UndoTileEdit();
+	TestTrue(TEXT("Undo clears the placement"), Grid->IsClearTile(FGridCoord(20, 20)));
+	TestTrue(TEXT("Undo hides the placed actor"), Building->IsHidden());
+
+	Grid->RedoTileEdit();
+	TestFalse(TEXT("Redo blocks the placement"), Grid->IsClearTile(FGridCoord(20, 21)));
+	TestFalse(TEXT("Redo shows the placed actor"), Building->IsHidden());
+
+	Grid->UndoTileEdit();
+	Grid->SetRectBlocked(FGridCoord(0, 0), FGridCoord(1, 1), false);
+	TestTrue(TEXT("Edits that change nothing keep the redo history"), Grid->CanRedoTileEdit());
+	Grid->SetRectBlocked(FGridCoord(0, 0), FGridCoord(1, 1), true);
+	TestFalse(TEXT("A new edit discards the undone ones"), Grid->CanRedoTileEdit());
+	TestFalse(TEXT("The actor of the discarded placement is destroyed"), IsValid(Building));
+
+	Grid->UndoTileEdit();
+	Grid->UndoTileEdit();
+	Grid->UndoTileEdit();
+	TestEqual(TEXT("Undo goes back to the first edit"), Grid->BlockedTiles.Num(), 1);
+	TestFalse(TEXT("Nothing left to undo"), Grid->CanUndoTileEdit());
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,258 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BuildingBase.h"
+#include "GridBitMask.h"
+#include "GridOccupancy.h"
+#include "GridPlacementRules.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GridPlacementRulesTests
+{
+	static bool AnySetWithin(const FGridBitMask& Mask, int32 Column, int32 Row, int32 Width, int32 Radius)
+	{
+		for (int32 C = Column - Radius; C < Column + Width + Radius; C++)
+		{
+			for (int32 R = Row - Radius; R < Row + Width + Radius; R++)
+			{
+				if (Mask.IsSet(FGridCoord(C, R)))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	static bool AllSet(const FGridBitMask& Mask, int32 Column, int32 Row, int32 Width)
+	{
+		for (int32 C = Column; C < Column + Width; C++)
+		{
+			for (int32 R = Row; R < Row + Width; R++)
+			{
+				if (!Mask.IsSet(FGridCoord(C, R)))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridBitMaskOperationsTest, "RTSGrid.PlacementMask.BitMask", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridBitMaskOperationsTest::RunTest(const FString& Parameters)
+{
+	// Rows span two words and a half so shifts carry across words and padding
+	const FGridCoord Dimensions(37, 150);
+
+	FRandomStream Random(41);
+	FGridBitMask Source;
+	Source.Init(Dimensions, false);
+	for (int32 Column = 0; Column < Dimensions.Column; Column++)
+	{
+		for (int32 Row = 0; Row < Dimensions.Row; Row++)
+		{
+			Source.Set(FGridCoord(Column, Row), Random.FRand() < 0.08f);
+		}
+	}
+
+	for (const int32 Size : { 1, 2, 3, 5, 70 })
+	{
+		FGridBitMask Dilated = Source;
+		Dilated.Dilate(Size - 1);
+		FGridBitMask Any = Source;
+		Any.AnyInFootprint(Size);
+		FGridBitMask Inverse = Source;
+		Inverse.Not();
+		FGridBitMask All = Inverse;
+		All.AllInFootprint(Size);
+
+		for (int32 Column = 0; Column < Dimensions.Column; Column++)
+		{
+			for (int32 Row = 0; Row < Dimensions.Row; Row++)
+			{
+				const FGridCoord Coordinate(Column, Row);
+				if (Dilated.Get(Coordinate) != GridPlacementRulesTests::AnySetWithin(Source, Column, Row, 1, Size - 1)
+					|| Any.Get(Coordinate) != GridPlacementRulesTests::AnySetWithin(Source, Column, Row, Size, 0)
+					|| All.Get(Coordinate) != GridPlacementRulesTests::AllSet(Inverse, Column, Row, Size))
+				{
+					AddError(FString::Printf(TEXT("Size %d differs at %d, %d"), Size, Column, Row));
+					return false;
+				}
+			}
+		}
+
+		bool bInside = true;
+		Dilated.ForEachSetBit([&bInside, &Dimensions](const FGridCoord& Coordinate)
+		{
+			bInside &= Coordinate.Row < Dimensions.Row;
+		});
+		TestTrue(TEXT("No bit is set past the last Row"), bInside);
+	}
+
+	FGridBitMask Inverse = Source;
+	Inverse.Not();
+	TestEqual(TEXT("Not keeps the padding clear"), Source.CountSetBits() + Inverse.CountSetBits(), Dimensions.Column * Dimensions.Row);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridPlacementMaskIncrementalTest, "RTSGrid.PlacementMask.Incremental", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridPlacementMaskIncrementalTest::RunTest(const FString& Parameters)
+{
+	const FName Road(TEXT("Road"));
+	const FName Enemy(TEXT("Enemy"));
+	const int32 FootprintSize = 2;
+
+	TArray<FGridPlacementRule> Rules;
+	Rules.AddDefaulted(2);
+	Rules[0].Type = EGridPlacementRule::NearLayer;
+	Rules[0].Layer = Road;
+	Rules[0].Distance = 1;
+	Rules[1].Type = EGridPlacementRule::AwayFromLayer;
+	Rules[1].Layer = Enemy;
+	Rules[1].Distance = 3;
+
+	for (const EGridCellLayout CellLayout : { EGridCellLayout::RowMajor, EGridCellLayout::Morton })
+	{
+		const FGridLayout Layout(FGridCoord(53, 70), CellLayout);
+		FGridOccupancy Occupancy;
+		Occupancy.Reset(Layout);
+
+		TMap<FName, FGridBitMask> Layers;
+		Layers.Add(Road).Init(Layout.Dimensions, false);
+		Layers.Add(Enemy).Init(Layout.Dimensions, false);
+		const TArray<float> CellSlopes;
+		const FGridPlacementMask::FInputs Inputs{ Occupancy, Layers, CellSlopes };
+
+		FGridPlacementMask Mask;
+		Mask.SetRules(Rules, FootprintSize);
+		Mask.Refresh(Inputs);
+
+		FRandomStream Random(43);
+		for (int32 Edit = 0; Edit < 600; Edit++)
+		{
+			const FGridCoord Coordinate(Random.RandRange(0, 52), Random.RandRange(0, 69));
+			const float Kind = Random.FRand();
+			if (Kind < 0.6f)
+			{
+				Occupancy.SetBlocked(Layout.ToCellID(Coordinate), Random.FRand() < 0.5f);
+			}
+			else
+			{
+				Layers[Kind < 0.9f ? Road : Enemy].Set(Coordinate, Random.FRand() < 0.6f);
+			}
+			Mask.MarkDirty(Coordinate.Column);
+
+			if (Edit % 20 != 0)
+			{
+				continue;
+			}
+
+			Mask.Refresh(Inputs);
+
+			for (int32 Column = 0; Column < Layout.Dimensions.Column; Column++)
+			{
+				for (int32 Row = 0; Row < Layout.Dimensions.Row; Row++)
+				{
+					bool bClear = true;
+					for (int32 C = Column; C < Column + FootprintSize; C++)
+					{
+						for (int32 R = Row; R < Row + FootprintSize; R++)
+						{
+							bClear &= !Occupancy.IsBlocked(FGridCoord(C, R));
+						}
+					}
+
+					const bool bExpected = bClear
+						&& GridPlacementRulesTests::AnySetWithin(Layers[Road], Column, Row, FootprintSize, 1)
+						&& !GridPlacementRulesTests::AnySetWithin(Layers[Enemy], Column, Row, FootprintSize, 3);
+
+					if (Mask.GetMask().Get(FGridCoord(Column, Row)) != bExpected)
+					{
+						AddError(FString::Printf(TEXT("Placement at %d, %d is %d after %d edits"), Column, Row, !bExpected, Edit + 1));
+						return false;
+					}
+				}
+			}
+		}
+
+		Occupancy.SetBlocked(Layout.ToCellID(FGridCoord(26, 30)), true);
+		Mask.MarkDirty(26);
+		Mask.Refresh(Inputs);
+		TestEqual(TEXT("Only the Columns within reach of a change are evaluated"), Mask.GetNumColumnsEvaluated(), 2 * Mask.GetReach() + 1);
+
+		// Rules are compared one by one, any edit evaluates the whole mask again
+		Mask.SetRules(Rules, FootprintSize);
+		TestFalse(TEXT("Setting the same rules keeps the mask"), Mask.IsDirty());
+
+		TArray<FGridPlacementRule> SwappedRules = { Rules[1], Rules[0] };
+		Mask.SetRules(SwappedRules, FootprintSize);
+		TestTrue(TEXT("Reordered rules evaluate the mask again"), Mask.IsDirty());
+		Mask.Refresh(Inputs);
+
+		SwappedRules[0].Distance = 4;
+		Mask.SetRules(SwappedRules, FootprintSize);
+		TestTrue(TEXT("A changed rule of the same count evaluates the mask again"), Mask.IsDirty());
+		Mask.Refresh(Inputs);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemPlacementRulesTest, "RTSGrid.GridSystem.PlacementRules", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemPlacementRulesTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(32));
+
+	// Rules are read from the class defaults, put back at the end
+	ABuildingBase* Defaults = GetMutableDefault<ABuildingBase>();
+	const TArray<FGridPlacementRule> SavedRules = Defaults->PlacementRules;
+	const int32 SavedFootprintSize = Defaults->FootprintSize;
+
+	const TSubclassOf<ABuildingBase> BuildingType = ABuildingBase::StaticClass();
+	Defaults->FootprintSize = 2;
+	Defaults->PlacementRules.Reset();
+	TestTrue(TEXT("Without rules only the footprint counts"), Grid->IsValidPlacement(BuildingType, FGridCoord(10, 10)));
+	TestFalse(TEXT("Footprint over the grid edge"), Grid->IsValidPlacement(BuildingType, FGridCoord(31, 10)));
+	TestEqual(TEXT("Every corner with room for 2x2"), Grid->GetValidPlacements(BuildingType).Num(), 31 * 31);
+
+	FGridPlacementRule NearRoad;
+	NearRoad.Type = EGridPlacementRule::NearLayer;
+	NearRoad.Layer = TEXT("Road");
+	NearRoad.Distance = 1;
+	Defaults->PlacementRules.Add(NearRoad);
+
+	TestFalse(TEXT("Changed rules are picked up, no road yet"), Grid->IsValidPlacement(BuildingType, FGridCoord(10, 10)));
+
+	Grid->SetTileLayer(TEXT("Road"), FGridCoord(13, 10), true);
+	TestTrue(TEXT("Road on the tile"), Grid->IsOnTileLayer(TEXT("Road"), FGridCoord(13, 10)));
+	TestFalse(TEXT("Road two tiles away"), Grid->IsValidPlacement(BuildingType, FGridCoord(10, 10)));
+	TestTrue(TEXT("Road next to the footprint"), Grid->IsValidPlacement(BuildingType, FGridCoord(11, 10)));
+	TestTrue(TEXT("Road diagonal to the footprint"), Grid->IsValidPlacement(BuildingType, FGridCoord(14, 11)));
+
+	// Updated from the tile change, a building cannot overlap another one
+	Grid->SetTileBlocked(FGridCoord(12, 11), true);
+	TestFalse(TEXT("Blocked tile in the footprint"), Grid->IsValidPlacement(BuildingType, FGridCoord(11, 10)));
+	Grid->SetTileBlocked(FGridCoord(12, 11), false);
+	TestTrue(TEXT("Cleared again"), Grid->IsValidPlacement(BuildingType, FGridCoord(11, 10)));
+
+	Grid->ClearTileLayer(TEXT("Road"));
+	TestEqual(TEXT("No road, no placement"), Grid->GetValidPlacements(BuildingType).Num(), 0);
+
+	Defaults->PlacementRules = SavedRules;
+	Defaults->FootprintSize = SavedFootprintSize;
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridOccupancy.h"
+#include "GridRegions.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GridRegionsTests
+{
+	// True if both labelings split the free cells the same way, whatever the label values
+	static bool SameRegions(const FGridRegions& A, const FGridRegions& B)
+	{
+		if (A.GetNumRegions() != B.GetNumRegions())
+		{
+			return false;
+		}
+
+		TMap<int32, int32> AToB;
+		TMap<int32, int32> BToA;
+		const FGridLayout& Layout = A.GetLayout();
+
+		for (int32 Column = 0; Column < Layout.Dimensions.Column; Column++)
+		{
+			for (int32 Row = 0; Row < Layout.Dimensions.Row; Row++)
+			{
+				const int32 CellID = Layout.ToCellID(FGridCoord(Column, Row));
+				const int32 RegionA = A.GetRegion(CellID);
+				const int32 RegionB = B.GetRegion(CellID);
+
+				if ((RegionA == INDEX_NONE) != (RegionB == INDEX_NONE))
+				{
+					return false;
+				}
+
+				if (RegionA != INDEX_NONE && (AToB.FindOrAdd(RegionA, RegionB) != RegionB || BToA.FindOrAdd(RegionB, RegionA) != RegionA))
+				{
+					return false;
+				}
+			}
+		}
+
+		for (const TPair<int32, int32>& Pair : AToB)
+		{
+			if (A.GetRegionSize(Pair.Key) != B.GetRegionSize(Pair.Value))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridRegionsSplitMergeTest, "RTSGrid.Regions.SplitMerge", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridRegionsSplitMergeTest::RunTest(const FString& Parameters)
+{
+	const FGridLayout Layout(FGridCoord(32, 32), EGridCellLayout::RowMajor);
+	FGridOccupancy Occupancy;
+	Occupancy.Reset(Layout);
+
+	FGridRegions Regions;
+	Regions.Reset(Occupancy);
+
+	const int32 Left = Layout.ToCellID(FGridCoord(2, 5));
+	const int32 Right = Layout.ToCellID(FGridCoord(30, 5));
+
+	TestEqual(TEXT("Open grid is one region"), Regions.GetNumRegions(), 1);
+	TestEqual(TEXT("Region holds every cell"), Regions.GetRegionSize(Regions.GetRegion(Left)), 32 * 32);
+
+	// A wall across the grid, the last tile closes it
+	for (int32 Row = 0; Row < 32; Row++)
+	{
+		const int32 CellID = Layout.ToCellID(FGridCoord(16, Row));
+		Occupancy.SetBlocked(CellID, true);
+		Regions.SetBlocked(CellID, true);
+
+		if (Row < 31)
+		{
+			TestEqual(TEXT("Open wall does not split"), Regions.GetNumRegions(), 1);
+			TestTrue(TEXT("Extending a wall does not search"), Regions.GetNumCellsVisited() == 0);
+		}
+	}
+
+	TestEqual(TEXT("Closed wall splits the grid"), Regions.GetNumRegions(), 2);
+	TestFalse(TEXT("Sides are not connected"), Regions.AreConnected(Left, Right));
+	TestEqual(TEXT("Left side size"), Regions.GetRegionSize(Regions.GetRegion(Left)), 16 * 32);
+	TestEqual(TEXT("Right side size"), Regions.GetRegionSize(Regions.GetRegion(Right)), 15 * 32);
+	TestEqual(TEXT("Wall tiles have no region"), Regions.GetRegion(Layout.ToCellID(FGridCoord(16, 3))), (int32)INDEX_NONE);
+
+	const int32 Gate = Layout.ToCellID(FGridCoord(16, 20));
+	TArray<int32> GateCells = { Gate };
+	Occupancy.SetBlocked(Gate, false);
+	TestFalse(TEXT("Blocked cells seal nothing more"), Regions.WouldSplit(TArrayView<const int32>(GateCells)));
+	Regions.SetBlocked(Gate, false);
+	TestEqual(TEXT("Gate merges the sides"), Regions.GetNumRegions(), 1);
+	TestTrue(TEXT("Sides are connected"), Regions.AreConnected(Left, Right));
+
+	TestTrue(TEXT("Closing the gate would split"), Regions.WouldSplit(TArrayView<const int32>(GateCells)));
+	TestTrue(TEXT("WouldSplit leaves the labels"), Regions.AreConnected(Left, Right) && Regions.GetRegion(Gate) != INDEX_NONE);
+
+	// A box around one corner, seen as a whole placement
+	TArray<int32> Box = { Layout.ToCellID(FGridCoord(0, 2)), Layout.ToCellID(FGridCoord(1, 2)), Layout.ToCellID(FGridCoord(2, 1)), Layout.ToCellID(FGridCoord(2, 0)) };
+	TestFalse(TEXT("Three sides do not seal the corner"), Regions.WouldSplit(TArrayView<const int32>(Box).Slice(0, 3)));
+	TestTrue(TEXT("The fourth side seals it"), Regions.WouldSplit(Box));
+
+	// A single isolated cell
+	const int32 Island = Layout.ToCellID(FGridCoord(31, 31));
+	Occupancy.SetBlocked(Island, true);
+	Regions.SetBlocked(Island, true);
+	Occupancy.SetBlocked(Layout.ToCellID(FGridCoord(31, 30)), true);
+	Regions.SetBlocked(Layout.ToCellID(FGridCoord(31, 30)), true);
+	Occupancy.SetBlocked(Layout.ToCellID(FGridCoord(30, 31)), true);
+	Regions.SetBlocked(Layout.ToCellID(FGridCoord(30, 31)), true);
+	Occupancy.SetBlocked(Island, false);
+	Regions.SetBlocked(Island, false);
+	TestEqual(TEXT("Walled cell is a region of its own"), Regions.GetRegionSize(Regions.GetRegion(Island)), 1);
+	TestEqual(TEXT("Walled cell adds a region"), Regions.GetNumRegions(), 2);
+
+	FGridRegions Rebuilt;
+	Rebuilt.Reset(Occupancy);
+	TestTrue(TEXT("Updates match a full labeling"), GridRegionsTests::SameRegions(Regions, Rebuilt));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridRegionsRandomTest, "RTSGrid.Regions.RandomEdits", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridRegionsRandomTest::RunTest(const FString& Parameters)
+{
+	for (const EGridCellLayout CellLayout : { EGridCellLayout::RowMajor, EGridCellLayout::Morton })
+	{
+		const FGridLayout Layout(FGridCoord(40, 27), CellLayout);
+		FGridOccupancy Occupancy;
+		Occupancy.Reset(Layout);
+
+		FGridRegions Regions;
+		Regions.Reset(Occupancy);
+
+		// Dense enough that blocking cells keeps cutting regions apart and clearing them merges them
+		FRandomStream Random(5);
+		for (int32 Edit = 0; Edit < 4000; Edit++)
+		{
+			const int32 CellID = Layout.ToCellID(FGridCoord(Random.RandRange(0, 39), Random.RandRange(0, 26)));
+			const bool bBlocked = Random.FRand() < 0.55f;
+
+			Occupancy.SetBlocked(CellID, bBlocked);
+			Regions.SetBlocked(CellID, bBlocked);
+
+			if (Edit % 200 == 0)
+			{
+				FGridRegions Rebuilt;
+				Rebuilt.Reset(Occupancy);
+				if (!TestTrue(TEXT("Updates match a full labeling"), GridRegionsTests::SameRegions(Regions, Rebuilt)))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemRegionsTest, "RTSGrid.GridSystem.Regions", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemRegionsTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(16));
+
+	const FGridCoord Left(2, 2);
+	const FGridCoord Right(13, 2);
+
+	Grid->SetRectBlocked(FGridCoord(8, 0), FGridCoord(8, 14), true);
+	TestTrue(TEXT("Open wall keeps the sides connected"), Grid->AreCellsConnected(Left, Right));
+	TestTrue(TEXT("Closing the wall would seal a region"), Grid->WouldSealRegion({ FGridCoord(8, 15) }));
+	TestTrue(TEXT("Closing the way out of the gap would seal a region"), Grid->WouldSealRegion({ FGridCoord(9, 15) }));
+	TestFalse(TEXT("Away from the gap seals nothing"), Grid->WouldSealRegion({ FGridCoord(10, 15) }));
+
+	Grid->SetTilesBlocked({ FGridCoord(8, 15) }, true);
+	TestFalse(TEXT("Closed wall splits the sides"), Grid->AreCellsConnected(Left, Right));
+	TestFalse(TEXT("Blocked tiles are not connected"), Grid->AreCellsConnected(FGridCoord(8, 3), FGridCoord(8, 3)));
+
+	Grid->UndoTileEdit();
+	TestTrue(TEXT("Undo reopens the wall"), Grid->AreCellsConnected(Left, Right));
+	TestEqual(TEXT("Undo only reopens the gap"), Grid->BlockedTiles.Num(), 15);
+
+	// Editing BlockedTiles directly rebuilds the occupancy and the regions with it
+	Grid->BlockedTiles.Add(FGridCoord(8, 15));
+	Grid->MarkOccupancyDirty();
+	TestFalse(TEXT("Rebuilt regions see the wall"), Grid->AreCellsConnected(Left, Right));
+	TestEqual(TEXT("Two regions"), Grid->GetRegions().GetNumRegions(), 2);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
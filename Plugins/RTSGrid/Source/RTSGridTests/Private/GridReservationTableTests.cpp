@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridReservationTable.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridReservationTableTest, "RTSGrid.Reservation.Table", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridReservationTableTest::RunTest(const FString& Parameters)
+{
+	FGridReservationTable Table;
+	Table.Reset(6, 4);
+
+	TestEqual(TEXT("Horizon rounds up to a power of two"), Table.GetHorizon(), 8);
+	TestTrue(TEXT("Free cell can be reserved"), Table.Reserve(10, 2, 1));
+	TestTrue(TEXT("Same unit can reserve again"), Table.Reserve(10, 2, 1));
+	TestFalse(TEXT("Other unit can not take the cell"), Table.Reserve(10, 2, 2));
+	TestTrue(TEXT("Same cell at another time is free"), Table.Reserve(10, 3, 2));
+	TestEqual(TEXT("Reservation is found"), Table.GetReservation(10, 2), 1);
+	TestEqual(TEXT("Unreserved cell has no unit"), Table.GetReservation(11, 2), (int32)INDEX_NONE);
+	TestFalse(TEXT("Time beyond the horizon is rejected"), Table.Reserve(20, 8, 1));
+
+	Table.Release(10, 2, 2);
+	TestEqual(TEXT("Only the holder releases"), Table.GetReservation(10, 2), 1);
+	Table.Release(10, 2, 1);
+	TestTrue(TEXT("Released cell is free"), Table.Reserve(10, 2, 2));
+
+	for (int32 CellID = 100; CellID < 103; CellID++)
+	{
+		Table.Reserve(CellID, 4, 3);
+	}
+	TestTrue(TEXT("Step holds MaxReservationsPerStep"), Table.Reserve(103, 4, 3));
+	TestFalse(TEXT("Full step is rejected"), Table.Reserve(104, 4, 3));
+	TestEqual(TEXT("Reservations are counted"), Table.GetNumReservations(4), 4);
+
+	// Moving past a step frees it for the time step that wraps onto it
+	Table.Advance(5);
+	TestEqual(TEXT("Past reservations are dropped"), Table.GetReservation(10, 3), (int32)INDEX_NONE);
+	TestFalse(TEXT("Past time steps can not be reserved"), Table.Reserve(10, 4, 1));
+	TestEqual(TEXT("Wrapped step starts empty"), Table.GetReservation(100, 12), (int32)INDEX_NONE);
+	TestEqual(TEXT("Wrapped step starts empty"), Table.GetNumReservations(12), 0);
+	TestTrue(TEXT("Wrapped step is not full"), Table.Reserve(104, 12, 3));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridReservationPathTest, "RTSGrid.Reservation.Path", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridReservationPathTest::RunTest(const FString& Parameters)
+{
+	FGridReservationTable Table;
+	Table.Reset(16, 64);
+
+	const int32 Corridor[] = { 0, 1, 2, 3, 4 };
+	const int32 Opposite[] = { 4, 3, 2, 1, 0 };
+	const int32 Follower[] = { 0, 0, 1, 2, 3 };
+
+	TestTrue(TEXT("First path is reserved"), Table.ReservePath(Corridor, 0, 1));
+	TestFalse(TEXT("Head on path conflicts"), Table.ReservePath(Opposite, 0, 2));
+	TestEqual(TEXT("Failed path reserves nothing"), Table.GetReservation(4, 0), (int32)INDEX_NONE);
+	TestFalse(TEXT("Path starting on a reserved cell conflicts"), Table.ReservePath(Follower, 0, 2));
+	TestTrue(TEXT("Path one step behind is free"), Table.ReservePath(Follower, 1, 2));
+
+	// Swapping two cells between two steps is a conflict even though no cell is shared at a step
+	const int32 Left[] = { 20, 21 };
+	const int32 Right[] = { 21, 20 };
+	TestTrue(TEXT("Swap first half is reserved"), Table.ReservePath(Left, 0, 3));
+	TestFalse(TEXT("Units can not swap cells"), Table.IsMoveFree(21, 20, 0, 4));
+	TestFalse(TEXT("Swapping path conflicts"), Table.ReservePath(Right, 0, 4));
+	TestTrue(TEXT("Waiting in place is free"), Table.IsMoveFree(30, 30, 0, 4));
+
+	Table.ReleasePath(Corridor, 0, 1);
+	TestTrue(TEXT("Released path frees the corridor"), Table.ReservePath(Opposite, 0, 2));
+
+	TestFalse(TEXT("Path beyond the horizon is rejected"), Table.ReservePath(Corridor, 14, 5));
+
+	// A path failing on a full step keeps what the unit held before
+	FGridReservationTable SmallTable;
+	SmallTable.Reset(8, 2);
+	SmallTable.Reserve(50, 0, 1);
+	SmallTable.Reserve(60, 1, 2);
+	SmallTable.Reserve(61, 1, 3);
+	const int32 Onward[] = { 50, 51 };
+	TestFalse(TEXT("Path through a full step fails"), SmallTable.ReservePath(Onward, 0, 1));
+	TestEqual(TEXT("Cell held before the path is still held"), SmallTable.GetReservation(50, 0), 1);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemReservationTest, "RTSGrid.GridSystem.Reservations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemReservationTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(16));
+
+	Grid->SetTileBlocked(FGridCoord(3, 3), true);
+
+	TestTrue(TEXT("Clear tile can be reserved"), Grid->ReserveCell(FGridCoord(1, 1), 0, 7));
+	TestFalse(TEXT("Blocked tile can not be reserved"), Grid->ReserveCell(FGridCoord(3, 3), 0, 7));
+	TestFalse(TEXT("Tile outside the grid can not be reserved"), Grid->ReserveCell(FGridCoord(16, 0), 0, 7));
+	TestEqual(TEXT("Reservation is found"), Grid->GetCellReservation(FGridCoord(1, 1), 0), 7);
+
+	const TArray<FGridCoord> Blocked = { FGridCoord(3, 1), FGridCoord(3, 2), FGridCoord(3, 3) };
+	TestFalse(TEXT("Path through a blocked tile is rejected"), Grid->ReservePath(Blocked, 0, 8));
+
+	const TArray<FGridCoord> Path = { FGridCoord(5, 1), FGridCoord(5, 2), FGridCoord(5, 3) };
+	TestTrue(TEXT("Clear path is reserved"), Grid->ReservePath(Path, 0, 8));
+
+	Grid->AdvanceReservations();
+	TestEqual(TEXT("Time moves forward"), Grid->GetReservationTime(), 1);
+	TestEqual(TEXT("Past reservations are dropped"), Grid->GetCellReservation(FGridCoord(5, 1), 0), (int32)INDEX_NONE);
+	TestEqual(TEXT("Future reservations are kept"), Grid->GetCellReservation(FGridCoord(5, 3), 2), 8);
+
+	Grid->GridDimensions = FGridCoord(32);
+	Grid->GenerateGrid();
+	TestEqual(TEXT("New layout clears the reservations"), Grid->GetCellReservation(FGridCoord(5, 3), 2), (int32)INDEX_NONE);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
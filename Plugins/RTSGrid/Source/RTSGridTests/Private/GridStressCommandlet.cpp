@@ -0,0 +1,473 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridStressCommandlet.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "GridSystem.h"
+#include "GridTestWorld.h"
+#include "RTSGrid.h"
+
+namespace GridStress
+{
+	static const TCHAR* GetOpName(EGridStressOp Op)
+	{
+		static const TCHAR* Names[] = { TEXT("Place"), TEXT("Remove"), TEXT("IsValidLocation"), TEXT("LineOfSight"), TEXT("Connected"), TEXT("Fits") };
+		static_assert(UE_ARRAY_COUNT(Names) == (int32)EGridStressOp::Count, "Every operation needs a name");
+		return Names[(int32)Op];
+	}
+
+	static bool FindOp(const FString& Name, EGridStressOp& OutOp)
+	{
+		for (int32 Op = 0; Op < (int32)EGridStressOp::Count; Op++)
+		{
+			if (Name.Equals(GetOpName((EGridStressOp)Op), ESearchCase::IgnoreCase))
+			{
+				OutOp = (EGridStressOp)Op;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Latency of the sorted samples at a fraction of them, in nanoseconds
+	static double GetPercentile(const TArray<uint64>& SortedCycles, double Fraction)
+	{
+		if (SortedCycles.Num() == 0)
+		{
+			return 0.0;
+		}
+
+		const int32 Index = FMath::Min(FMath::FloorToInt(Fraction * SortedCycles.Num()), SortedCycles.Num() - 1);
+		return SortedCycles[Index] * FPlatformTime::GetSecondsPerCycle64() * 1.0e9;
+	}
+
+	// Percentiles every report holds, with their JSON field names
+	static const TPair<const TCHAR*, double> Percentiles[] =
+	{
+		{ TEXT("p50_ns"), 0.5 },
+		{ TEXT("p90_ns"), 0.9 },
+		{ TEXT("p99_ns"), 0.99 },
+		{ TEXT("p999_ns"), 0.999 },
+		{ TEXT("max_ns"), 1.0 },
+	};
+}
+
+UGridStressCommandlet::UGridStressCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UGridStressCommandlet::Main(const FString& Params)
+{
+	FGridCoord Dimensions(1024);
+	FParse::Value(*Params, TEXT("Columns="), Dimensions.Column);
+	FParse::Value(*Params, TEXT("Rows="), Dimensions.Row);
+
+	int32 FootprintSize = 2;
+	FParse::Value(*Params, TEXT("Footprint="), FootprintSize);
+	FootprintSize = FMath::Clamp(FootprintSize, 1, FMath::Min(Dimensions.Column, Dimensions.Row));
+
+	int32 OpsPerFrame = 2000;
+	FParse::Value(*Params, TEXT("OpsPerFrame="), OpsPerFrame);
+	OpsPerFrame = FMath::Max(OpsPerFrame, 1);
+
+	FString LayoutName = TEXT("RowMajor");
+	FParse::Value(*Params, TEXT("Layout="), LayoutName);
+	const int64 LayoutValue = StaticEnum<EGridCellLayout>()->GetValueByNameString(LayoutName);
+	if (LayoutValue == INDEX_NONE)
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("Unknown cell layout %s"), *LayoutName);
+		return 1;
+	}
+
+	TArray<FGridStressCommand> Commands;
+	FString ReplayPath;
+	if (FParse::Value(*Params, TEXT("Replay="), ReplayPath))
+	{
+		if (!LoadCommands(ReplayPath, Commands))
+		{
+			return 1;
+		}
+	}
+	else
+	{
+		GenerateCommands(Params, Dimensions, FootprintSize, Commands);
+	}
+
+	FString RecordPath;
+	if (FParse::Value(*Params, TEXT("Record="), RecordPath) && !SaveCommands(RecordPath, Commands))
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("Could not write the stream to %s"), *RecordPath);
+		return 1;
+	}
+
+	const uint64 UsedPhysicalBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(Dimensions);
+	Grid->CellLayout = (EGridCellLayout)LayoutValue;
+	Grid->bSparseStorage = FParse::Param(*Params, TEXT("Sparse"));
+	Grid->GenerateGrid();
+
+	UE_LOG(LogRTSGrid, Display, TEXT("Running %d commands on a %d x %d %s grid%s"),
+		Commands.Num(), Dimensions.Column, Dimensions.Row, *LayoutName, Grid->bSparseStorage ? TEXT(" with sparse storage") : TEXT(""));
+
+	TArray<uint64> Cycles[(int32)EGridStressOp::Count];
+	TArray<uint64> FrameCycles;
+	int64 Sink = 0;
+
+	FGridStressPlacements Placements;
+
+	const uint64 RunStart = FPlatformTime::Cycles64();
+	for (int32 FrameStart = 0; FrameStart < Commands.Num(); FrameStart += OpsPerFrame)
+	{
+		const int32 FrameEnd = FMath::Min(FrameStart + OpsPerFrame, Commands.Num());
+		const uint64 FrameStartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Index = FrameStart; Index < FrameEnd; Index++)
+		{
+			const FGridStressCommand& Command = Commands[Index];
+			const uint64 Start = FPlatformTime::Cycles64();
+			Sink += RunCommand(Grid, Command, FootprintSize, Placements);
+			Cycles[(int32)Command.Op].Add(FPlatformTime::Cycles64() - Start);
+		}
+
+		// What the world does with the grid once per frame
+		Grid->Tick(1.0f / 30.0f);
+		Grid->PublishOccupancySnapshot();
+		FrameCycles.Add(FPlatformTime::Cycles64() - FrameStartCycles);
+	}
+	const double RunSeconds = (FPlatformTime::Cycles64() - RunStart) * FPlatformTime::GetSecondsPerCycle64();
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	// Report
+	TArray<TSharedPtr<FJsonValue>> JsonResults;
+	auto AddResult = [&JsonResults](const FString& Name, TArray<uint64>& Samples)
+	{
+		if (Samples.Num() == 0)
+		{
+			return;
+		}
+
+		Samples.Sort();
+
+		TSharedRef<FJsonObject> JsonResult = MakeShared<FJsonObject>();
+		JsonResult->SetStringField(TEXT("name"), Name);
+		JsonResult->SetNumberField(TEXT("count"), Samples.Num());
+
+		uint64 TotalCycles = 0;
+		for (const uint64 Sample : Samples)
+		{
+			TotalCycles += Sample;
+		}
+		const double OpsPerSecond = Samples.Num() / FMath::Max(TotalCycles * FPlatformTime::GetSecondsPerCycle64(), SMALL_NUMBER);
+		JsonResult->SetNumberField(TEXT("ops_per_second"), OpsPerSecond);
+
+		FString Line = FString::Printf(TEXT("%-16s %9d ops %12.0f ops/s"), *Name, Samples.Num(), OpsPerSecond);
+		for (const TPair<const TCHAR*, double>& Percentile : GridStress::Percentiles)
+		{
+			const double Nanoseconds = GridStress::GetPercentile(Samples, Percentile.Value);
+			JsonResult->SetNumberField(Percentile.Key, Nanoseconds);
+			Line += FString::Printf(TEXT(" %s %.0f"), Percentile.Key, Nanoseconds);
+		}
+
+		UE_LOG(LogRTSGrid, Display, TEXT("%s"), *Line);
+		JsonResults.Add(MakeShared<FJsonValueObject>(JsonResult));
+	};
+
+	for (int32 Op = 0; Op < (int32)EGridStressOp::Count; Op++)
+	{
+		AddResult(GridStress::GetOpName((EGridStressOp)Op), Cycles[Op]);
+	}
+	AddResult(TEXT("Frame"), FrameCycles);
+
+	TSharedRef<FJsonObject> JsonMetrics = MakeShared<FJsonObject>();
+	JsonMetrics->SetNumberField(TEXT("commands"), Commands.Num());
+	JsonMetrics->SetNumberField(TEXT("commands_per_second"), Commands.Num() / FMath::Max(RunSeconds, SMALL_NUMBER));
+	JsonMetrics->SetNumberField(TEXT("peak_used_physical_bytes"), (double)MemoryStats.PeakUsedPhysical);
+	JsonMetrics->SetNumberField(TEXT("used_physical_growth_bytes"), (double)MemoryStats.UsedPhysical - (double)UsedPhysicalBefore);
+	JsonMetrics->SetNumberField(TEXT("blocked_tiles"), Grid->bSparseStorage ? Grid->GetSparseTiles().GetNumBlocked() : Grid->BlockedTiles.Num());
+	JsonMetrics->SetNumberField(TEXT("sink"), (double)Sink);
+
+	UE_LOG(LogRTSGrid, Display, TEXT("%.0f commands/s, peak used physical memory %.1f MB"),
+		Commands.Num() / FMath::Max(RunSeconds, SMALL_NUMBER), MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("suite"), TEXT("Stress"));
+	Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+	Root->SetStringField(TEXT("params"), Params);
+	Root->SetArrayField(TEXT("results"), JsonResults);
+	Root->SetObjectField(TEXT("metrics"), JsonMetrics);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	FJsonSerializer::Serialize(Root, Writer);
+
+	FString ReportPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RTSGrid"), TEXT("Stress.json"));
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+	if (!FFileHelper::SaveStringToFile(Output, *ReportPath))
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("Could not write the report to %s"), *ReportPath);
+		return 1;
+	}
+
+	// Regressions against an earlier report, by median latency of each operation
+	FString BaselinePath;
+	if (!FParse::Value(*Params, TEXT("Baseline="), BaselinePath))
+	{
+		return 0;
+	}
+
+	FString BaselineText;
+	TSharedPtr<FJsonObject> Baseline;
+	if (!FFileHelper::LoadFileToString(BaselineText, *BaselinePath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineText), Baseline) || !Baseline.IsValid())
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("Could not read the baseline %s"), *BaselinePath);
+		return 1;
+	}
+
+	float Tolerance = 0.2f;
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+	int32 NumRegressions = 0;
+	const TArray<TSharedPtr<FJsonValue>>* BaselineResults = nullptr;
+	if (Baseline->TryGetArrayField(TEXT("results"), BaselineResults))
+	{
+		for (const TSharedPtr<FJsonValue>& BaselineValue : *BaselineResults)
+		{
+			const TSharedPtr<FJsonObject>& BaselineResult = BaselineValue->AsObject();
+			for (const TSharedPtr<FJsonValue>& ResultValue : JsonResults)
+			{
+				const TSharedPtr<FJsonObject>& Result = ResultValue->AsObject();
+				if (Result->GetStringField(TEXT("name")) != BaselineResult->GetStringField(TEXT("name")))
+				{
+					continue;
+				}
+
+				const double Before = BaselineResult->GetNumberField(TEXT("p50_ns"));
+				const double After = Result->GetNumberField(TEXT("p50_ns"));
+				if (After > Before * (1.0 + Tolerance))
+				{
+					UE_LOG(LogRTSGrid, Error, TEXT("%s regressed, median %.0f ns against %.0f ns"), *Result->GetStringField(TEXT("name")), After, Before);
+					NumRegressions++;
+				}
+			}
+		}
+	}
+
+	return NumRegressions > 0 ? 1 : 0;
+}
+
+void UGridStressCommandlet::GenerateCommands(const FString& Params, FGridCoord Dimensions, int32 FootprintSize, TArray<FGridStressCommand>& OutCommands) const
+{
+	int32 NumOps = 1000000;
+	FParse::Value(*Params, TEXT("Ops="), NumOps);
+
+	int32 Seed = 1;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+
+	// A building phase mix, placements and the queries that come with them dominate
+	float Weights[(int32)EGridStressOp::Count] = { 30.0f, 10.0f, 30.0f, 10.0f, 10.0f, 10.0f };
+
+	FString Mix;
+	if (FParse::Value(*Params, TEXT("Mix="), Mix, false))
+	{
+		FMemory::Memzero(Weights, sizeof(Weights));
+
+		TArray<FString> Entries;
+		Mix.ParseIntoArray(Entries, TEXT(","));
+		for (const FString& Entry : Entries)
+		{
+			FString Name;
+			FString Weight;
+			EGridStressOp Op;
+			if (Entry.Split(TEXT(":"), &Name, &Weight) && GridStress::FindOp(Name, Op))
+			{
+				Weights[(int32)Op] = FMath::Max(FCString::Atof(*Weight), 0.0f);
+			}
+			else
+			{
+				UE_LOG(LogRTSGrid, Warning, TEXT("Ignoring mix entry %s"), *Entry);
+			}
+		}
+	}
+
+	float TotalWeight = 0.0f;
+	for (const float Weight : Weights)
+	{
+		TotalWeight += Weight;
+	}
+
+	FRandomStream Random(Seed);
+	auto RandomCoord = [&Random, Dimensions, FootprintSize]()
+	{
+		return FGridCoord(Random.RandRange(0, Dimensions.Column - FootprintSize), Random.RandRange(0, Dimensions.Row - FootprintSize));
+	};
+
+	// Removals name earlier placements, the way players demolish, RunCommand picks another one if that placement did not fit
+	TArray<FGridCoord> Placed;
+
+	OutCommands.Reset(NumOps);
+	for (int32 Index = 0; Index < NumOps && TotalWeight > 0.0f; Index++)
+	{
+		float Pick = Random.FRand() * TotalWeight;
+		int32 Op = 0;
+		while (Op < (int32)EGridStressOp::Count - 1 && Pick >= Weights[Op])
+		{
+			Pick -= Weights[Op];
+			Op++;
+		}
+
+		FGridStressCommand& Command = OutCommands.AddDefaulted_GetRef();
+		Command.Op = (EGridStressOp)Op;
+		Command.A = RandomCoord();
+		Command.B = RandomCoord();
+
+		if (Command.Op == EGridStressOp::Place)
+		{
+			Placed.Add(Command.A);
+		}
+		else if (Command.Op == EGridStressOp::Remove && Placed.Num() > 0)
+		{
+			const int32 PlacedIndex = Random.RandRange(0, Placed.Num() - 1);
+			Command.A = Placed[PlacedIndex];
+			Placed.RemoveAtSwap(PlacedIndex, 1, false);
+		}
+		else if (Command.Op == EGridStressOp::LineOfSight)
+		{
+			// Units look a few dozen tiles away, not across the whole map
+			Command.B = FGridCoord(
+				FMath::Clamp(Command.A.Column + Random.RandRange(-32, 32), 0, Dimensions.Column - 1),
+				FMath::Clamp(Command.A.Row + Random.RandRange(-32, 32), 0, Dimensions.Row - 1));
+		}
+	}
+}
+
+bool UGridStressCommandlet::LoadCommands(const FString& Path, TArray<FGridStressCommand>& OutCommands) const
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+	{
+		UE_LOG(LogRTSGrid, Error, TEXT("Could not read the stream %s"), *Path);
+		return false;
+	}
+
+	OutCommands.Reset(Lines.Num());
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); LineIndex++)
+	{
+		TArray<FString> Tokens;
+		Lines[LineIndex].ParseIntoArrayWS(Tokens);
+		if (Tokens.Num() == 0 || Tokens[0].StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		FGridStressCommand Command;
+		if (!GridStress::FindOp(Tokens[0], Command.Op) || Tokens.Num() < 3)
+		{
+			UE_LOG(LogRTSGrid, Error, TEXT("%s(%d): expected \"<Op> <Column> <Row> [<Column> <Row>]\""), *Path, LineIndex + 1);
+			return false;
+		}
+
+		Command.A = FGridCoord(FCString::Atoi(*Tokens[1]), FCString::Atoi(*Tokens[2]));
+		Command.B = Tokens.Num() >= 5 ? FGridCoord(FCString::Atoi(*Tokens[3]), FCString::Atoi(*Tokens[4])) : Command.A;
+		OutCommands.Add(Command);
+	}
+
+	return true;
+}
+
+bool UGridStressCommandlet::SaveCommands(const FString& Path, const TArray<FGridStressCommand>& Commands) const
+{
+	TArray<FString> Lines;
+	Lines.Reserve(Commands.Num());
+
+	for (const FGridStressCommand& Command : Commands)
+	{
+		Lines.Add(FString::Printf(TEXT("%s %d %d %d %d"), GridStress::GetOpName(Command.Op), Command.A.Column, Command.A.Row, Command.B.Column, Command.B.Row));
+	}
+
+	return FFileHelper::SaveStringArrayToFile(Lines, *Path);
+}
+
+void FGridStressPlacements::Add(const FGridCoord& Corner)
+{
+	Indices.Add(Corner, Corners.Add(Corner));
+}
+
+bool FGridStressPlacements::Take(const FGridCoord& Corner, FGridCoord& OutCorner)
+{
+	if (Corners.Num() == 0)
+	{
+		return false;
+	}
+
+	const int32* Found = Indices.Find(Corner);
+	const int32 Index = Found ? *Found : (int32)(GetTypeHash(Corner) % (uint32)Corners.Num());
+
+	OutCorner = Corners[Index];
+	Indices.Remove(OutCorner);
+	Corners.RemoveAtSwap(Index, 1, false);
+	if (Index < Corners.Num())
+	{
+		Indices[Corners[Index]] = Index;
+	}
+	return true;
+}
+
+int32 UGridStressCommandlet::RunCommand(AGridSystem* Grid, const FGridStressCommand& Command, int32 FootprintSize, FGridStressPlacements& Placements) const
+{
+	const FGridCoord Last(Command.A.Column + FootprintSize - 1, Command.A.Row + FootprintSize - 1);
+
+	switch (Command.Op)
+	{
+	case EGridStressOp::Place:
+		if (Grid->CanFitFootprint(Command.A, FootprintSize))
+		{
+			Grid->SetRectBlocked(Command.A, Last, true);
+			Placements.Add(Command.A);
+			return 1;
+		}
+		return 0;
+
+	case EGridStressOp::Remove:
+	{
+		// Only whole buildings are cleared, never parts of the ones around a placement that did not fit
+		FGridCoord Corner;
+		if (!Placements.Take(Command.A, Corner))
+		{
+			return 0;
+		}
+
+		Grid->SetRectBlocked(Corner, FGridCoord(Corner.Column + FootprintSize - 1, Corner.Row + FootprintSize - 1), false);
+		return 1;
+	}
+
+	case EGridStressOp::IsValidLocation:
+		return Grid->IsValidLocation(Command.A) ? 1 : 0;
+
+	case EGridStressOp::LineOfSight:
+		return Grid->HasLineOfSight(Command.A, Command.B) ? 1 : 0;
+
+	case EGridStressOp::Connected:
+		return Grid->AreCellsConnected(Command.A, Command.B) ? 1 : 0;
+
+	case EGridStressOp::Fits:
+		return Grid->CanFitFootprint(Command.A, FootprintSize) ? 1 : 0;
+
+	default:
+		return 0;
+	}
+}
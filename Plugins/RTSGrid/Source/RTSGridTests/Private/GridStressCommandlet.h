@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GridCoords.h"
+#include "GridStressCommandlet.generated.h"
+
+class AGridSystem;
+
+enum class EGridStressOp : uint8
+{
+	// Blocks a footprint if it fits, as a placement does
+	Place,
+	// Clears the footprint of a building the run placed, the one at A if that placement went through, as a demolition does
+	Remove,
+	IsValidLocation,
+	LineOfSight,
+	Connected,
+	Fits,
+	Count
+};
+
+struct FGridStressCommand
+{
+	EGridStressOp Op;
+	FGridCoord A;
+	FGridCoord B;
+};
+
+// Corners of the footprints a run placed, which never overlap
+struct FGridStressPlacements
+{
+	TArray<FGridCoord> Corners;
+	TMap<FGridCoord, int32> Indices;
+
+	void Add(const FGridCoord& Corner);
+
+	/**
+	 * Forgets a placement, the one at Corner if there is one, otherwise one picked from Corner so replays pick the same.
+	 *
+	 * @return false if nothing is placed
+	 */
+	bool Take(const FGridCoord& Corner, FGridCoord& OutCorner);
+};
+
+/**
+ * Replays a stream of placements, removals and queries on a grid without a renderer, and reports
+ * the throughput, latency percentiles and memory of each operation. The stream is either generated
+ * from a seed or replayed from a file, so runs can be compared across grid settings and builds.
+ *
+ * UE4Editor-Cmd RTSPlugin.uproject -run=GridStress -nullrhi -unattended [options]
+ *
+ * -Columns=N -Rows=N      grid dimensions, 1024 x 1024 by default
+ * -Layout=Name            RowMajor, PowerOfTwo or Morton
+ * -Sparse                 stores the tiles with bSparseStorage
+ * -Footprint=N            width of placed and tested footprints, 2 by default
+ * -Ops=N                  commands generated, 1000000 by default
+ * -Mix=Place:30,...       weight of each operation in the generated stream
+ * -Seed=N                 seed of the generated stream
+ * -OpsPerFrame=N          commands between two grid ticks, 2000 by default
+ * -Replay=Path            replays a recorded stream instead of generating one
+ * -Record=Path            writes the stream that is run, to replay it later
+ * -Report=Path            JSON report, Saved/RTSGrid/Stress.json by default
+ * -Baseline=Path          report of an earlier run, fails if a median latency grew by more than -Tolerance
+ * -Tolerance=F            allowed relative slow down against the baseline, 0.2 by default
+ */
+UCLASS()
+class UGridStressCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UGridStressCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	// Builds the command stream from the -Mix weights
+	void GenerateCommands(const FString& Params, FGridCoord Dimensions, int32 FootprintSize, TArray<FGridStressCommand>& OutCommands) const;
+
+	// Reads and writes streams as one command per line, "<Op> <Column> <Row> [<Column> <Row>]"
+	bool LoadCommands(const FString& Path, TArray<FGridStressCommand>& OutCommands) const;
+	bool SaveCommands(const FString& Path, const TArray<FGridStressCommand>& Commands) const;
+
+	// Runs one command on the grid, returns a value kept alive so queries are not optimized away
+	int32 RunCommand(AGridSystem* Grid, const FGridStressCommand& Command, int32 FootprintSize, FGridStressPlacements& Placements) const;
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "GridStressCommandlet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridStressCommandletTest, "RTSGrid.Stress.RecordReplay", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridStressCommandletTest::RunTest(const FString& Parameters)
+{
+	const FString Directory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("RTSGridStress"));
+	const FString StreamPath = Directory / TEXT("Stream.txt");
+	const FString ReportPath = Directory / TEXT("Report.json");
+	const FString ReplayReportPath = Directory / TEXT("Replay.json");
+
+	UGridStressCommandlet* Commandlet = NewObject<UGridStressCommandlet>();
+
+	const FString Record = FString::Printf(TEXT("-Columns=96 -Rows=64 -Layout=Morton -Ops=4000 -OpsPerFrame=500 -Seed=3 -Record=\"%s\" -Report=\"%s\""), *StreamPath, *ReportPath);
+	TestEqual(TEXT("Generated run succeeds"), Commandlet->Main(Record), 0);
+
+	TArray<FString> Lines;
+	TestTrue(TEXT("Stream is recorded"), FFileHelper::LoadFileToStringArray(Lines, *StreamPath));
+	TestEqual(TEXT("One line per command"), Lines.Num(), 4000);
+
+	FString Report;
+	TestTrue(TEXT("Report is written"), FFileHelper::LoadFileToString(Report, *ReportPath));
+	TestTrue(TEXT("Report holds percentiles"), Report.Contains(TEXT("p99_ns")));
+
+	// A baseline this generous can not fail, it only checks the comparison runs
+	const FString Replay = FString::Printf(TEXT("-Columns=96 -Rows=64 -Sparse -Replay=\"%s\" -Report=\"%s\" -Baseline=\"%s\" -Tolerance=1000000"), *StreamPath, *ReplayReportPath, *ReportPath);
+	TestEqual(TEXT("Replayed run succeeds"), Commandlet->Main(Replay), 0);
+
+	AddExpectedError(TEXT("Could not read the stream"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestEqual(TEXT("Missing stream fails"), Commandlet->Main(TEXT("-Replay=\"DoesNotExist.txt\"")), 1);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
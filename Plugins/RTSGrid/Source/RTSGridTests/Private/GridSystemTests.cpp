@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GridTestWorld.h"
+#include "GridSystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemCellIDRoundTripTest, "RTSGrid.GridSystem.CellIDRoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemCellIDRoundTripTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+
+	// Non square grids catch Column and Row being swapped anywhere
+	const FGridCoord Dimensions[] = { FGridCoord(4), FGridCoord(3, 5), FGridCoord(7, 2), FGridCoord(1, 9) };
+
+	for (const FGridCoord& Dimension : Dimensions)
+	{
+		AGridSystem* Grid = TestWorld.SpawnGrid(Dimension);
+		const FString Context = FString::Printf(TEXT("[%d x %d]"), Dimension.Column, Dimension.Row);
+
+		TestEqual(Context + TEXT(" GeneratedGrid size"), Grid->GeneratedGrid.Num(), Dimension.Column * Dimension.Row);
+
+		for (int32 ID = 0; ID < Grid->GeneratedGrid.Num(); ID++)
+		{
+			const FGridCoord& Generated = Grid->GeneratedGrid[ID];
+			const FGridCoord FromID = Grid->GetCoordinateFromCellID(ID);
+
+			if (!TestTrue(FString::Printf(TEXT("%s GeneratedGrid[%d] is in bounds"), *Context, ID), Grid->IsInGridBounds(Generated))
+				|| !TestTrue(FString::Printf(TEXT("%s GeneratedGrid[%d] matches GetCoordinateFromCellID"), *Context, ID), Generated == FromID)
+				|| !TestEqual(FString::Printf(TEXT("%s ID %d round trip"), *Context, ID), Grid->GetCellIDFromCoordinate(FromID), ID))
+			{
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemPowerOfTwoLayoutTest, "RTSGrid.GridSystem.PowerOfTwoLayout", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemPowerOfTwoLayoutTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(3, 5));
+	Grid->CellLayout = EGridCellLayout::PowerOfTwo;
+
+	for (const FGridCoord& Coord : Grid->GeneratedGrid)
+	{
+		const int32 ID = Grid->GetCellIDFromCoordinate(Coord);
+		TestEqual(TEXT("CellID is Column << 3 | Row"), ID, (Coord.Column << 3) | Coord.Row);
+		TestTrue(TEXT("CellID round trip"), Grid->GetCoordinateFromCellID(ID) == Coord);
+	}
+
+	// Changing the layout back is picked up without regenerating the grid
+	Grid->CellLayout = EGridCellLayout::RowMajor;
+	TestEqual(TEXT("RowMajor CellID"), Grid->GetCellIDFromCoordinate(FGridCoord(2, 4)), 14);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemValidLocationTest, "RTSGrid.GridSystem.ValidLocation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemValidLocationTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(3, 5));
+
+	TestTrue(TEXT("Origin is valid"), Grid->IsValidLocation(FGridCoord(0, 0)));
+	TestTrue(TEXT("Last cell is valid"), Grid->IsValidLocation(FGridCoord(2, 4)));
+	TestFalse(TEXT("Column past the end"), Grid->IsValidLocation(FGridCoord(3, 0)));
+	TestFalse(TEXT("Row past the end"), Grid->IsValidLocation(FGridCoord(0, 5)));
+	TestFalse(TEXT("Negative Column"), Grid->IsValidLocation(FGridCoord(-1, 0)));
+	TestFalse(TEXT("Negative Row"), Grid->IsValidLocation(FGridCoord(0, -1)));
+
+	Grid->BlockedTiles.Add(FGridCoord(1, 1));
+	TestFalse(TEXT("Blocked tile is not clear"), Grid->IsClearTile(FGridCoord(1, 1)));
+	TestFalse(TEXT("Blocked tile is not valid"), Grid->IsValidLocation(FGridCoord(1, 1)));
+	TestTrue(TEXT("Neighbour of a blocked tile is valid"), Grid->IsValidLocation(FGridCoord(1, 2)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemRelativeLocationTest, "RTSGrid.GridSystem.RelativeLocation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemRelativeLocationTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(3, 5), 100.0f);
+
+	// Cells are centered on multiples of CellSize, X maps to Row and Y to Column
+	int32 CellID = INDEX_NONE;
+	const FGridCoord Coord = Grid->GetCoordinateFromRelative(FVector(240.0f, 160.0f, 0.0f), CellID);
+	TestEqual(TEXT("Row from X"), Coord.Row, 2);
+	TestEqual(TEXT("Column from Y"), Coord.Column, 2);
+	TestEqual(TEXT("CellID"), CellID, Grid->GetCellIDFromCoordinate(FGridCoord(2, 2)));
+
+	const FVector Center = Grid->GetCellCenterFromRelative(FVector(240.0f, 160.0f, 0.0f), false);
+	TestEqual(TEXT("Cell center"), Center, FVector(200.0f, 200.0f, 0.0f));
+
+	const FVector2D Size = Grid->GetGridSize();
+	TestEqual(TEXT("Grid size X"), Size.X, 500.0f);
+	TestEqual(TEXT("Grid size Y"), Size.Y, 300.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridSystemMemoryBudgetTest, "RTSGrid.GridSystem.MemoryBudget", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGridSystemMemoryBudgetTest::RunTest(const FString& Parameters)
+{
+	FGridTestWorld TestWorld;
+	AGridSystem* Grid = TestWorld.SpawnGrid(FGridCoord(32), 100.0f, true);
+	Grid->bShowTileTextInfo = true;
+	Grid->GenerateGrid();
+
+	const FName Labels(TEXT("TextComponents"));
+	const FName Preview(TEXT("PreviewGrid"));
+	const float BytesPerMB = 1024.0f * 1024.0f;
+
+	TMap<FName, SIZE_T> Usage;
+	Grid->GetMemoryUsageBySubsystem(Usage);
+	TestTrue(TEXT("Generated grid holds every coordinate"), Usage.FindRef(TEXT("GeneratedGrid")) >= 32 * 32 * sizeof(FGridCoord));
+	TestTrue(TEXT("Labels are counted"), Usage.FindRef(Labels) > 0);
+	TestTrue(TEXT("Preview instances are counted"), Usage.FindRef(Preview) > 0);
+
+	const SIZE_T TotalSize = Grid->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+	TestTrue(TEXT("memreport total covers every subsystem"), TotalSize >= (SIZE_T)Grid->GetMemoryUsage());
+	TestTrue(TEXT("Exclusive size leaves the components out"), Grid->GetResourceSizeBytes(EResourceSizeMode::Exclusive) < TotalSize);
+
+	// Dropping the labels is enough for a budget just under the usage
+	Grid->MemoryBudgetMB = (Grid->GetMemoryUsage() - Usage[Labels] / 2) / BytesPerMB;
+	Grid->EnforceMemoryBudget();
+	Grid->GetMemoryUsageBySubsystem(Usage);
+	TestTrue(TEXT("Labels are dropped first"), Usage.FindRef(Labels) == 0);
+	TestEqual(TEXT("Preview keeps every tile"), Grid->GetPreviewCoarseness(), 1);
+	TestTrue(TEXT("Within the budget"), Grid->GetMemoryUsage() <= (int64)(Grid->MemoryBudgetMB * BytesPerMB));
+
+	Grid->MemoryBudgetMB = (Grid->GetMemoryUsage() - Usage[Preview] / 2) / BytesPerMB;
+	Grid->EnforceMemoryBudget();
+	TestTrue(TEXT("Preview gets coarser"), Grid->GetPreviewCoarseness() > 1);
+	TestTrue(TEXT("Within the smaller budget"), Grid->GetMemoryUsage() <= (int64)(Grid->MemoryBudgetMB * BytesPerMB));
+
+	Grid->GenerateGrid();
+	Grid->GetMemoryUsageBySubsystem(Usage);
+	TestTrue(TEXT("Regenerating keeps the labels dropped"), Usage.FindRef(Labels) == 0);
+	TestTrue(TEXT("Regenerating stays within the budget"), Grid->GetMemoryUsage() <= (int64)(Grid->MemoryBudgetMB * BytesPerMB));
+
+	// Far over the budget with nothing left to drop, caches rebuilt afterwards are not released again every frame
+	Grid->MemoryBudgetMB = 1.0f / BytesPerMB;
+	Grid->EnforceMemoryBudget();
+	Grid->AreCellsConnected(FGridCoord(0, 0), FGridCoord(5, 5));
+	for (int32 Frame = 0; Frame < 8; Frame++)
+	{
+		Grid->Tick(0.1f);
+	}
+	Grid->GetMemoryUsageBySubsystem(Usage);
+	TestTrue(TEXT("Rebuilt regions are kept over the budget"), Usage.FindRef(TEXT("Regions")) > 0);
+
+	Grid->MemoryBudgetMB = 0.0f;
+	Grid->EnforceMemoryBudget();
+	Grid->GetMemoryUsageBySubsystem(Usage);
+	TestEqual(TEXT("No budget brings the preview back"), Grid->GetPreviewCoarseness(), 1);
+	TestTrue(TEXT("No budget brings the labels back"), Usage.FindRef(Labels) > 0);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GridSystem.h"
+
+/**
+ * Transient game world used by the grid tests to spawn AGridSystem actors
+ * without a map or a renderer, the world is destroyed with the object.
+ */
+class FGridTestWorld
+{
+public:
+	FGridTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+	}
+
+	~FGridTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	/**
+	 * Spawns a grid and runs its construction script, which generates the grid.
+	 *
+	 * @param Dimensions number of Columns and Rows of the grid
+	 * @param CellSize size of each cell in unreal units
+	 * @param bShowPreviewGrid whether the preview HISM instances are generated
+	 * @return the spawned grid
+	 */
+	AGridSystem* SpawnGrid(FGridCoord Dimensions, float CellSize = 100.0f, bool bShowPreviewGrid = false)
+	{
+		AGridSystem* Grid = World->SpawnActorDeferred<AGridSystem>(AGridSystem::StaticClass(), FTransform::Identity);
+		Grid->GridDimensions = Dimensions;
+		Grid->CellSize = CellSize;
+		Grid->bShowPreviewGrid = bShowPreviewGrid;
+		Grid->bShowTileTextInfo = false;
+		Grid->bDrawBoundingBox = false;
+		Grid->FinishSpawning(FTransform::Identity);
+		return Grid;
+	}
+
+	/**
+	 * Spawns a 100 units engine cube with collision, to bake or trace against.
+	 *
+	 * @param Location world location of the center of the cube
+	 * @param Scale scale of the cube
+	 * @param Rotation rotation of the cube
+	 * @return the spawned cube
+	 */
+	AStaticMeshActor* SpawnCube(FVector Location, FVector Scale, FRotator Rotation = FRotator::ZeroRotator)
+	{
+		AStaticMeshActor* Cube = World->SpawnActor<AStaticMeshActor>(Location, Rotation);
+		Cube->SetActorScale3D(Scale);
+
+		UStaticMeshComponent* Mesh = Cube->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+		Mesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		return Cube;
+	}
+
+	UWorld* GetWorld() const
+	{
+		return World;
+	}
+
+private:
+
+	UWorld* World;
+};
@@ -0,0 +1,9 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+// Automation tests and benchmarks for the RTSGrid module, run them with
+// UE4Editor-Cmd RTSPlugin.uproject -ExecCmds="Automation RunTests RTSGrid; Quit" -nullrhi -unattended
+// Load tests at production scale run with the GridStress commandlet, see GridStressCommandlet.h
+IMPLEMENT_MODULE(FDefaultModuleImpl, RTSGridTests)